@@ -0,0 +1,23 @@
+#!/bin/sh
+# imports a module through its interface file and checks that the result
+# matches importing it from source. usage: Run.sh lithic cc
+
+set -e
+Lithic=$1
+Cc=${2:-cc}
+Dir=$(dirname "$0")
+Tmp=$(mktemp -d)
+trap 'rm -rf "$Tmp"' EXIT
+
+mkdir -p "$Tmp/iface/Lib" "$Tmp/src" "$Tmp/out"
+"$Lithic" --emit-interface -o "$Tmp/iface/Lib/Shapes.lci" "$Dir/Lib/Shapes.lc"
+"$Lithic" -m "$Dir" -o "$Tmp/src/Main.c" "$Dir/Main.lc"
+"$Lithic" -m "$Tmp/iface" -o "$Tmp/iface/Main.c" "$Dir/Main.lc"
+diff "$Tmp/src/Main.c" "$Tmp/iface/Main.c"
+
+# the interface importer links against the module compiled from source,
+# whose output is overwritten but for the module itself.
+"$Lithic" --out-dir "$Tmp/out" -m "$Dir" "$Dir/Main.lc"
+"$Lithic" --out-dir "$Tmp/out" -m "$Tmp/iface" "$Dir/Main.lc"
+"$Cc" -std=c99 -I"$Tmp/out" -o "$Tmp/Main" "$Tmp/out/Main.c" "$Tmp/out/Lib.Shapes.c"
+"$Tmp/Main"
@@ -1,4 +1,8 @@
  #include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -6,14 +10,42 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
-#include <sys/time.h>
+#include <sys/un.h>
 #include <unistd.h>
 
+#include "lithic.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
 #define MAX_MODULE_PATHS 32
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGN 16
+#define LEX_CHUNK_MIN (1024 * 1024)
+#define PARSE_CHUNK_MIN (64 * 1024)
+#define IMAGE_VERSION 3
+#define EMIT_BLOCK_SIZE (256 * 1024)
+
+// identifies the compiler build in cached images, stamped in by the makefile
+// with a hash of the compiler source.
+#ifndef LITHIC_BUILD_ID
+#define LITHIC_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+// perfect hash over all entries of `Keywords`, see `KeywordTable`.
+#define KEYWORD_HASH(First, Second, Last, Len) \
+	(((First) * 9 + (Second) * 12 + (Last) * 2 + (Len)) & 127)
 
 enum SizeMod
 {
@@ -238,7 +270,8 @@ enum AstNodeFlag
 	ANF_MUT = 0x4,
 	ANF_BASE = 0x8,
 	ANF_VARIADIC = 0x10,
-	ANF_NULLABLE = 0x20
+	ANF_NULLABLE = 0x20,
+	ANF_LAZY = 0x40 // statement list whose tokens are yet to be parsed.
 };
 
 enum ConfFlag
@@ -246,7 +279,25 @@ enum ConfFlag
 	CF_DUMP_TOKS = 0x1,
 	CF_DUMP_AST = 0x2,
 	CF_TIME = 0x4,
-	CF_NO_FLOAT = 0x8
+	CF_NO_FLOAT = 0x8,
+	CF_EMIT_INTERFACE = 0x10,
+	CF_UNITY = 0x20
+};
+
+enum TimeFormat
+{
+	TF_TEXT = 0,
+	TF_JSON,
+	TF_TRACE
+};
+
+// byte classes that `Scan` can search for.
+enum ScanClass
+{
+	SC_NEWLINE = 0, // stop at a newline.
+	SC_STR_SPECIAL, // stop at a quote or backslash.
+	SC_NON_IDENT, // stop at anything not valid in an identifier.
+	SC_NON_BLANK // stop at anything but non-newline whitespace.
 };
 
 enum SymtabEntryType
@@ -258,6 +309,21 @@ enum SymtabEntryType
 	SET_PROC
 };
 
+enum EmitVisibility
+{
+	EV_PUBLIC = 0x1,
+	EV_PRIVATE = 0x2, // lambdas count as private.
+	EV_ALL = 0x3
+};
+
+enum ConstValType
+{
+	CVT_NONE = 0, // not known at compile time.
+	CVT_INT,
+	CVT_FLOAT,
+	CVT_BOOL
+};
+
 struct Conf
 {
 	char const *InFile;
@@ -269,6 +335,10 @@ struct Conf
 	char const *ModulePaths[MAX_MODULE_PATHS];
 	size_t ModulePathCnt;
 	
+	char const *CacheDir;
+	char const *OutDir; // set for separate output files per module.
+	unsigned JobCnt;
+	unsigned char TimeFormat;
 	unsigned long Flags;
 };
 
@@ -277,31 +347,47 @@ struct FileData
 	char *Name;
 	char *Data;
 	size_t Len;
+	size_t MapLen; // nonzero if `Data` is a read-only file mapping.
+	
+	// byte offsets at which each line begins, for diagnostics.
+	size_t *Lines;
+	size_t LineCnt;
 };
 
 struct Token
 {
-	union
-	{
-		struct
-		{
-			char *Text;
-			size_t Len;
-		} Str;
-		uint64_t Int;
-		double Float;
-		bool Bool;
-	} Data;
+	uint32_t Pos, Len;
+	
+	// index into `LexData.Strs` for identifiers and string literals, into
+	// `LexData.Nums` for number literals, or the value of boolean literals.
+	uint32_t Payload;
 	
-	size_t Pos, Len;
 	unsigned char SizeMod;
 	unsigned char Type;
 };
 
+struct TokenStr
+{
+	char const *Text; // interned, compare by address.
+	size_t Len;
+};
+
+union TokenNum
+{
+	uint64_t Int;
+	double Float;
+};
+
 struct LexData
 {
 	struct Token *Toks;
-	size_t TokCnt;
+	size_t TokCnt, TokCap;
+	
+	// side tables for token payloads.
+	struct TokenStr *Strs;
+	size_t StrCnt, StrCap;
+	union TokenNum *Nums;
+	size_t NumCnt, NumCap;
 };
 
 struct StrNumLimit
@@ -324,11 +410,83 @@ struct AstNode
 	unsigned char Type;
 };
 
+struct FlatAstNode
+{
+	uint32_t FirstChild, NextSibling; // zero if none, the root is never a child.
+	uint32_t FirstTok, ChildCnt;
+	uint16_t TokCnt;
+	unsigned char Flags;
+	unsigned char Type;
+};
+
+struct FlatAst
+{
+	// nodes are laid out in pre-order with the root at index zero, except for
+	// lazily parsed procedure bodies, which are appended once needed.
+	struct FlatAstNode *Nodes;
+	uint32_t NodeCnt, NodeCap;
+	
+	// node tokens are stored as indices into `Lex.Toks`.
+	uint32_t *Toks;
+	uint32_t TokCnt, TokCap;
+	struct LexData Lex; // non-owning copy, the module's lex data outlives the AST.
+};
+
+struct ArenaChunk
+{
+	struct ArenaChunk *Next;
+	size_t Cap, Used;
+	unsigned char Data[];
+};
+
+struct Arena
+{
+	// allocations are only ever released all at once.
+	struct ArenaChunk *Head;
+};
+
 struct ParseState
 {
 	struct FileData const *File;
 	struct LexData const *Lex;
+	struct Arena *Arena;
 	size_t i;
+	size_t End; // tokens from `End` onwards are treated as absent.
+	bool Lazy; // only find the bounds of procedure bodies.
+};
+
+// module images, which are cache entries and interface files, hold this header
+// followed by the arrays it counts, in order: numbers, strings, tokens, AST
+// nodes, AST tokens, string text and source text. interface files hold the
+// source of their declarations, and cache entries that of the whole module,
+// which is compared on lookup so that hash collisions are never mistaken for
+// hits.
+struct ImageHeader
+{
+	char Magic[4]; // "LCCH" for cache entries, "LCIF" for interface files.
+	uint32_t Version;
+	uint64_t Fingerprint; // see `Image_Fingerprint`.
+	uint64_t SrcHash, SrcLen;
+	uint64_t TokCnt, StrCnt, NumCnt;
+	uint64_t NodeCnt, AstTokCnt;
+	uint64_t TextLen;
+};
+
+struct ImageStr
+{
+	uint64_t Off, Len;
+};
+
+struct ParseChunk
+{
+	struct Lithic *Ctx;
+	struct FileData const *File;
+	struct LexData const *Lex;
+	size_t Begin, End; // token range holding whole top-level declarations.
+	bool Lazy;
+	struct Arena Arena;
+	struct FlatAst Ast;
+	bool Failed;
 };
 
 struct BindPower
@@ -340,14 +498,62 @@ struct ModuleData
 {
 	struct FileData File;
 	struct LexData Lex;
-	struct AstNode Ast;
+	struct FlatAst Ast;
 	char *FullPath;
+	char *ImportName; // import path joined by slashes, unset for the main module.
+	bool Resident; // data is owned by the server, see `Server_Keep`.
+	bool Interface; // loaded from an interface, without procedure bodies.
+	
+	// by node index, set for declarations reachable from the main module and
+	// the lambdas within them. unset when everything is kept.
+	unsigned char *Live;
+	size_t LiveCnt;
+	
+	struct Symtab const *Symtab; // globals visible to the module, once built.
 };
 
 struct ModuleDataGroup
 {
 	struct ModuleData *Modules;
-	size_t ModuleCnt;
+	size_t ModuleCnt, ModuleCap;
+};
+
+struct ModuleLoad
+{
+	// `Path` and either `Fp` or, for modules supplied by a resolver, `Src`
+	// are only set until the module has been read.
+	FILE *Fp;
+	char *Src;
+	size_t SrcLen;
+	char *Path;
+	struct ModuleData Data;
+	
+	size_t *Imports; // indices into `ModuleLoader.Loads`, in import order.
+	size_t ImportCnt;
+};
+
+struct ModuleLoader
+{
+	struct Lithic *Ctx;
+	pthread_mutex_t Lock;
+	pthread_cond_t Cond;
+	
+	// every module discovered so far, in order of discovery.
+	struct ModuleLoad *Loads;
+	size_t LoadCnt, LoadCap;
+	
+	size_t NextLoad, BusyCnt;
+	pthread_t Owner;
+	unsigned ThreadCnt;
+	bool Failed;
+};
+
+struct TimeEvent
+{
+	char const *Phase;
+	char const *Module; // interned file name.
+	uint64_t Begin, End;
+	unsigned Thread;
 };
 
 struct TimeData
@@ -359,100 +565,422 @@ struct TimeData
 	uint64_t ParseBegin, ParseEnd;
 	uint64_t ExtractImportsBegin, ExtractImportsEnd;
 	uint64_t BuildSymtabGlobalsBegin, BuildSymtabGlobalsEnd;
+	uint64_t FindReachableBegin, FindReachableEnd;
 	uint64_t CheckAcyclicityBegin, CheckAcyclicityEnd;
 	uint64_t AnalyzeBegin, AnalyzeEnd;
+	uint64_t EmitBegin, EmitEnd;
+	
+	// per-module phase timings, which may be recorded by worker threads.
+	struct TimeEvent *Events;
+	size_t EventCnt, EventCap;
+	pthread_mutex_t Lock;
+};
+
+struct InternEntry
+{
+	char const *Str;
+	size_t Len;
+	uint64_t Hash;
+};
+
+struct Interner
+{
+	// open addressing table, `EntryCap` is always zero or a power of two.
+	struct InternEntry *Entries;
+	size_t EntryCnt, EntryCap;
+	struct Arena Strs;
+	pthread_mutex_t Lock; // modules may be lexed concurrently.
+};
+
+struct LexChunk
+{
+	struct Lithic *Ctx;
+	struct FileData const *File;
+	size_t Begin, End; // [`Begin`, `End`) bounded by line breaks.
+	size_t Stop; // end of the last token, which may exceed `End`.
+	struct LexData Lex;
+	struct Interner Interner; // strings of `Lex` until the chunk is stitched.
+	bool Failed;
+};
+
+struct Lithic
+{
+	struct Conf Conf;
+	struct TimeData TimeData;
+	
+	// interned strings are only ever compared within one context.
+	struct Interner Interner;
+	
+	// library hooks, which are unset for the command line.
+	LithicResolver Resolver;
+	void *ResolverUser;
+	LithicDiagSink Sink;
+	void *SinkUser;
+	pthread_mutex_t HookLock; // hooks are never called concurrently.
 };
 
 struct DepNode
 {
-	char *Name;
-	struct AstNode const *DeclNode;
-	struct FileData const *DeclFile;
-	bool Visited; // read / written for easy cycle detection.
+	char const *Name;
+	struct ModuleData const *DeclMod;
+	uint32_t DeclNode;
+};
+
+struct DepEdge
+{
+	uint32_t From, To;
 };
 
 struct DepGraph
 {
 	struct DepNode *Nodes;
-	size_t NodeCnt;
-	bool *Adjacency;
+	size_t NodeCnt, NodeCap;
+	
+	struct DepEdge *Edges;
+	size_t EdgeCnt, EdgeCap;
+	
+	// compressed sparse rows built from `Edges` by `DepGraph_Build`, the
+	// successors of node `i` are `Succs[SuccBegins[i]]` up to but excluding
+	// `Succs[SuccBegins[i + 1]]`.
+	uint32_t *SuccBegins, *Succs;
 };
 
 struct SymtabEntry
 {
-	char *Name, *SuperName; // `SuperName` only relevant for methods.
-	struct AstNode const *DeclNode;
-	struct FileData const *DeclFile;
+	char const *Name, *SuperName; // `SuperName` only relevant for methods.
+	struct ModuleData const *DeclMod;
+	uint32_t DeclNode;
 	unsigned char Type;
 };
 
 struct Symtab
 {
 	struct SymtabEntry *Types;
-	size_t TypeCnt;
+	size_t TypeCnt, TypeCap;
 	
 	struct SymtabEntry *Values;
-	size_t ValueCnt;
+	size_t ValueCnt, ValueCap;
+	
+	// open addressing tables of entry indices plus one, zero marking empty
+	// slots. each has twice as many slots as its entry array has capacity.
+	uint32_t *TypeSlots, *ValueSlots;
+	
+	// searched after this symtab's own entries, shared between modules.
+	struct Symtab const *Base;
+};
+
+struct ConstVal
+{
+	// integers hold their bits sign or zero extended from their width, and
+	// 32 bit floats are kept rounded to single precision.
+	unsigned char Type;
+	unsigned char SizeMod;
+	bool Signed;
+	uint64_t Int;
+	double Float;
+};
+
+struct ConstEval
+{
+	struct ModuleData const *Mod;
+	
+	// set when folding within emitted procedures, whose locals shadow global
+	// constants.
+	struct EmitState const *Es;
+	
+	// evaluation this one is nested in and the declaration it moved on to,
+	// to catch values depending on themselves.
+	struct ConstEval const *Outer;
+	uint32_t Decl;
+};
+
+struct Emitter
+{
+	FILE *Fp;
+	char const *File;
+	
+	// pending output, written out in blocks of at least `EMIT_BLOCK_SIZE`.
+	char *Buf;
+	size_t Len, Cap;
+};
+
+struct EmitType
+{
+	struct ModuleData const *Mod;
+	uint32_t Node; // zero if unknown.
+	unsigned Ref; // levels of address taken on top of `Node`.
+};
+
+struct EmitLocal
+{
+	char const *Name; // null for `Self`.
+	struct ModuleData const *Mod;
+	uint32_t Type;
+};
+
+struct EmitJump
+{
+	// a loop or block which `Break` and `Continue` may target.
+	uint32_t Node;
+	char const *Label;
+	size_t DeferCnt;
+	unsigned SwitchDepth;
+	bool Loop;
+	bool BreakUsed, ContinueUsed;
+};
+
+struct EmitState
+{
+	struct Emitter Out;
+	struct Symtab const *Symtabs; // by module index.
+	struct ModuleDataGroup const *Modules;
+	
+	// module being emitted, changed only through `EmitSetModule`.
+	struct Symtab const *Symtab;
+	struct ModuleData *Mod;
+	
+	// procedure or lambda being emitted, with the type named by `Self`.
+	uint32_t Proc;
+	char const *SelfName;
+	unsigned Indent;
+	
+	// scopes of the current procedure.
+	struct EmitLocal *Locals;
+	size_t LocalCnt, LocalCap;
+	uint32_t *Defers;
+	size_t DeferCnt, DeferCap;
+	struct EmitJump *Jumps;
+	size_t JumpCnt, JumpCap;
+	unsigned SwitchDepth;
+};
+
+struct ReachMethod
+{
+	struct SymtabEntry const *Ent;
+	uint32_t Next; // index plus one of the next method of the same type.
+};
+
+struct Reach
+{
+	struct Symtab const *Symtabs; // by module index.
+	struct ModuleDataGroup *Modules;
+	
+	// declarations found reachable but not yet walked.
+	struct SymtabEntry const **Work;
+	size_t WorkCnt, WorkCap;
+	
+	// methods chained per type, with heads by module index then type node.
+	struct ReachMethod *Methods;
+	size_t MethodCnt, MethodCap;
+	uint32_t **MethodHeads;
+};
+
+struct ResidentModule
+{
+	struct ModuleData Data;
+	struct timespec Mtime;
+	uint64_t Size, Hash;
 };
 
-static int Analyze(struct Symtab *Symtab, struct ModuleDataGroup const *Modules);
-static int AnalyzeCommonType(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
-static int AnalyzeConstExpr(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
-static int AnalyzeDataStructure(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
-static int AnalyzeEnum(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
-static int AnalyzeGlobalVar(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
-static int AnalyzeProc(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
-static void AstNode_AddChild(struct AstNode *Node, struct AstNode const *Child);
-static void AstNode_AddToken(struct AstNode *Node, struct Token const *Tok);
-static void AstNode_Destroy(struct AstNode *Node);
-static void AstNode_Print(FILE *Fp, struct AstNode const *Node, unsigned Depth);
-static int BuildSymtabGlobals(struct Symtab *Out, struct ModuleDataGroup const *Modules);
-static int CheckAcyclicity(struct Symtab const *Symtab);
+struct Server
+{
+	bool Active;
+	
+	// imported modules kept across requests, by full path.
+	struct ResidentModule *Modules;
+	size_t ModuleCnt, ModuleCap;
+	pthread_mutex_t Lock; // modules may be loaded concurrently.
+	
+	size_t InternCnt; // interned strings after the last compaction.
+};
+
+static int Analyze(struct Symtab *Symtabs, struct ModuleDataGroup *Modules);
+static int AnalyzeCommonType(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node);
+static int AnalyzeConstExpr(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node, struct ConstVal *Out);
+static int AnalyzeDataStructure(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node);
+static int AnalyzeEnum(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node);
+static int AnalyzeGlobalInit(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node);
+static int AnalyzeGlobalVar(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node);
+static int AnalyzeProc(struct Symtab *Symtab, struct ModuleData *Mod, uint32_t Node);
+static void *Arena_Alloc(struct Arena *Arena, size_t Size);
+static void Arena_Destroy(struct Arena *Arena);
+static void *Arena_Realloc(struct Arena *Arena, void *Ptr, size_t OldSize, size_t NewSize);
+static void Arena_Reset(struct Arena *Arena);
+static void AstNode_AddChild(struct AstNode *Node, struct AstNode const *Child, struct Arena *Arena);
+static void AstNode_AddToken(struct AstNode *Node, struct Token const *Tok, struct Arena *Arena);
+static void AstNode_Print(FILE *Fp, struct FlatAst const *Ast, uint32_t Node, unsigned Depth);
+static int BuildSymtabGlobals(struct Symtab *Out, struct ModuleDataGroup const *Modules, size_t Home, struct Symtab const *Public);
+static int BuildSymtabPublic(struct Symtab *Out, struct ModuleDataGroup const *Modules);
+static int Cache_Load(struct LexData *OutLex, struct FlatAst *OutAst, struct FileData const *File, uint64_t SrcHash);
+static char *Cache_Path(uint64_t SrcHash);
+static void Cache_Store(struct LexData const *Lex, struct FlatAst const *Ast, struct FileData const *File, uint64_t SrcHash);
+static int CheckAcyclicity(struct Symtab const *Symtabs, struct ModuleDataGroup const *Modules);
+#ifndef LITHIC_LIB
+static int Client_Run(char const *Path, int Argc, char const *Argv[]);
+static int Compile(int Argc, char const *Argv[]);
+#endif
+static int CompileModule(struct FileData *FileData);
+#ifndef LITHIC_LIB
 static int Conf_Read(int Argc, char const *Argv[]);
 static void Conf_Quit(void);
+#endif
+static int ConstEval_Assign(struct ConstEval const *Ce, uint32_t Node, struct ConstVal const *Val, struct ConstVal const *To, struct ConstVal *Out);
+static int ConstEval_Atom(struct ConstEval const *Ce, uint32_t Node, struct ConstVal *Out);
+static int ConstEval_Binary(struct ConstEval const *Ce, uint32_t Node, unsigned char Op, struct ConstVal const *Lhs, struct ConstVal const *Rhs, struct ConstVal *Out);
+static void ConstEval_Common(struct ConstVal const *Lhs, struct ConstVal const *Rhs, struct ConstVal *Out);
+static int ConstEval_Convert(struct ConstEval const *Ce, uint32_t Node, struct ConstVal const *Val, struct ConstVal const *To, struct ConstVal *Out);
+static int ConstEval_Expr(struct ConstEval const *Ce, uint32_t Node, struct ConstVal *Out);
+static int ConstEval_Len(struct ConstEval const *Ce, struct ModuleData const *Mod, uint32_t Buf, struct ConstVal *Out);
+static int ConstEval_Member(struct ConstEval const *Ce, struct ModuleData const *Mod, uint32_t Enum, uint32_t Memb, struct ConstVal *Out);
+static int ConstEval_Nest(struct ConstEval const *Ce, struct ModuleData const *Mod, uint32_t Decl, struct ConstEval *Out);
+static int ConstEval_SizeOf(struct ConstEval const *Ce, struct ModuleData const *Mod, uint32_t Type, struct ConstVal *Out);
+static bool ConstEval_Type(struct ModuleData const *Mod, uint32_t Type, struct ConstVal *Out);
+static bool ConstEval_TypeOf(struct ConstEval const *Ce, uint32_t Node, struct ModuleData const **OutMod, uint32_t *OutType);
+static int ConstEval_Unary(struct ConstEval const *Ce, uint32_t Node, unsigned char Op, struct ConstVal const *Val, struct ConstVal *Out);
+static int ConstEval_Var(struct ConstEval const *Ce, struct SymtabEntry const *Ent, struct ConstVal *Out);
+static void ConstVal_Promote(struct ConstVal *Val);
+static bool ConstVal_SignedArith(unsigned char Op, int64_t Lhs, int64_t Rhs, unsigned Bits, int64_t *Out);
+static bool ConstVal_Truth(struct ConstVal const *Val);
+static void ConstVal_Wrap(struct ConstVal *Val);
 static int ConvEscSequence(char const *Src, size_t SrcLen, size_t *i, char **Str, size_t *Len);
-static struct DepNode const *DepGraph_AddNode(struct DepGraph *Graph, struct DepNode const *Node);
-static void DepGraph_Connect(struct DepGraph *Graph, struct DepNode const *From, struct DepNode const *To);
+static uint32_t DepGraph_AddNode(struct DepGraph *Graph, struct DepNode const *Node);
+static void DepGraph_Build(struct DepGraph *Graph);
+static void DepGraph_Connect(struct DepGraph *Graph, uint32_t From, uint32_t To);
 static void DepGraph_Destroy(struct DepGraph *Graph);
-static struct DepNode const *DepGraph_FindCycle(struct DepGraph *Graph, struct DepNode const *Src, struct DepNode *Cur);
-static void DepGraph_ResetVisited(struct DepGraph *Graph);
-static bool DepGraph_SearchEdge(struct DepGraph const *Graph, struct DepNode const *From, struct DepNode const *To);
-static struct DepNode const *DepGraph_SearchNode(struct DepGraph const *Graph, char const *Name);
+static size_t DepGraph_FindComponents(struct DepGraph const *Graph, uint32_t *OutComps);
+static bool DepGraph_SearchEdge(struct DepGraph const *Graph, uint32_t From, uint32_t To);
+static void DynStr_AppendBuf(char **Str, size_t *Len, char const *Buf, size_t BufLen);
 static void DynStr_AppendChar(char **Str, size_t *Len, char Ch);
 static void DynStr_AppendStr(char **Str, size_t *Len, char const *Append);
 static void DynStr_Init(char **Str, size_t *Len);
+static int Emit(struct Symtab const *Symtabs, struct ModuleDataGroup *Modules);
+static int EmitArgs(struct EmitState *Es, uint32_t Call, uint32_t FirstArg, struct ModuleData const *ParamMod, uint32_t FirstParam, unsigned char Flags, bool Separate);
+static int EmitCall(struct EmitState *Es, uint32_t Node);
+static int EmitCaseCheck(struct EmitState *Es, uint32_t Node);
+static int EmitConstExpr(struct EmitState *Es, uint32_t Node, bool *OutDone);
+static void EmitConstVal(struct EmitState *Es, struct ConstVal const *Val, bool Bare);
+static int EmitDecl(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Type, char const *Name);
+static void EmitDeclName(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Node);
+static int EmitDeclPrefix(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Type);
+static int EmitDeclSuffix(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Type);
+static void EmitDefer_Add(struct EmitState *Es, uint32_t Stmt);
+static int EmitDefers(struct EmitState *Es, size_t Until);
+static int EmitExpr(struct EmitState *Es, uint32_t Node, struct EmitType const *Expect, bool Paren);
+static int EmitExprAtom(struct EmitState *Es, uint32_t Node);
+static int EmitExprList(struct EmitState *Es, uint32_t List, struct EmitType const *Elem);
+static struct EmitLocal const *EmitFindLocal(struct EmitState const *Es, char const *Name);
+static uint32_t EmitFindMember(struct SymtabEntry const *Ent, char const *Name);
+static int EmitGlobalVar(struct EmitState *Es, uint32_t Node, bool Define);
+static int EmitGlobalVars(struct EmitState *Es, struct ModuleData const *Mod, unsigned char Vis, bool Define, bool *Any);
+static void EmitIdent(struct EmitState *Es, char const *Name);
+static int EmitJump(struct EmitState *Es, uint32_t Node);
+static void EmitJump_Pop(struct EmitState *Es);
+static void EmitJump_Push(struct EmitState *Es, uint32_t Node, char const *Label, bool Loop);
+static void EmitLocal_Add(struct EmitState *Es, char const *Name, struct ModuleData const *Mod, uint32_t Type);
+static int EmitMain(struct EmitState *Es);
+static void EmitModulePrefix(struct EmitState *Es, struct ModuleData const *Mod);
+static void EmitPrelude(struct EmitState *Es);
+static int EmitProc(struct EmitState *Es, uint32_t Node);
+static void EmitProcDeps(struct EmitState *Es, struct DepGraph *Graph, uint32_t *const *Ids, uint32_t From, uint32_t Node);
+static int EmitProcHead(struct EmitState *Es, uint32_t Node, bool Define);
+static int EmitProcHeads(struct EmitState *Es, struct ModuleData const *Mod, unsigned char Vis);
+static void EmitProcName(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Node);
+static uint32_t *EmitProcOrder(struct EmitState *Es, size_t First, size_t Cnt, struct DepGraph *Out);
+static int EmitSeparate(struct Symtab const *Symtabs, struct ModuleDataGroup *Modules);
+static struct ModuleData *EmitSetModule(struct EmitState *Es, struct ModuleData const *Mod);
+static int EmitStatement(struct EmitState *Es, uint32_t Node);
+static int EmitStatementList(struct EmitState *Es, uint32_t Node, uint32_t Loop);
+static char *EmitStem(struct ModuleData const *Mod);
+static void EmitStrLit(struct EmitState *Es, char const *Str, size_t Len);
+static struct Symtab const *EmitSymtab(struct EmitState const *Es, struct ModuleData const *Mod);
+static int EmitTypeDecl(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Node, unsigned char **Marks);
+static int EmitTypeDecls(struct EmitState *Es, struct ModuleData const *Mod, unsigned char Vis, unsigned char **Marks);
+static struct EmitType EmitTypeDeref(struct EmitType const *Type);
+static void EmitTypeNames(struct EmitState *Es, struct ModuleData const *Mod, bool *Any);
+static struct SymtabEntry const *EmitTypeEntry(struct EmitState const *Es, struct EmitType const *Type);
+static int EmitTypeLiteral(struct EmitState *Es, uint32_t Node);
+static struct EmitType EmitTypeOf(struct EmitState const *Es, uint32_t Node);
+static void EmitTypeStrip(struct EmitType *Type);
+static int EmitVar(struct EmitState *Es, uint32_t Node, bool DeclOnly);
+static int EmitVariadicCheck(struct EmitState *Es, uint32_t Node);
+static void EmitVariadicLast(struct EmitState *Es);
+static void Emitter_Buf(struct Emitter *Out, char const *Buf, size_t Len);
+static void Emitter_Char(struct Emitter *Out, char Ch);
+static int Emitter_Flush(struct Emitter *Out, bool Force);
+static void Emitter_Indent(struct Emitter *Out, unsigned Depth);
+static void Emitter_MakePath(struct Emitter *Out, char const *Path);
+static void Emitter_Reserve(struct Emitter *Out, size_t Len);
+static int Emitter_Save(struct Emitter *Out, char const *Path);
+static void Emitter_Str(struct Emitter *Out, char const *Str);
+static void Emitter_Uint(struct Emitter *Out, uint64_t Val);
 static struct Token const *ExpectToken(struct ParseState *Ps, enum TokenType Type);
-static int ExtractImports(struct FileData const *File, struct ModuleDataGroup *Append, struct AstNode const *Ast, unsigned Depth);
+static int ExtractImports(struct ModuleDataGroup *Group);
 static void FileData_Destroy(struct FileData *Data);
+static size_t FileData_FindLine(struct FileData const *Data, size_t Pos);
+static void FileData_FromBuf(struct FileData *Out, char const *Name, char *Data, size_t Len);
+static void FileData_IndexLines(struct FileData *Data);
 static int FileData_Read(struct FileData *Out, FILE *Fp, char const *File);
+static int FindReachable(struct Symtab const *Symtabs, struct ModuleDataGroup *Modules);
+static uint32_t FlatAst_AddNode(struct FlatAst *Ast, struct AstNode const *Node);
+static void FlatAst_Destroy(struct FlatAst *Ast);
+static struct Token const *FlatAst_Token(struct FlatAst const *Ast, uint32_t Node, size_t Ind);
+static char const *FlatAst_TokenText(struct FlatAst const *Ast, uint32_t Node, size_t Ind);
 static char *FullPathname(char const *Path);
-static struct AstNode const *GetSizeBaseType(struct AstNode const *Type);
-static uint64_t GetUnixTimeMs(void);
+static uint32_t GetSizeBaseType(struct FlatAst const *Ast, uint32_t Type);
+static uint64_t GetTimeNs(void);
+static uint64_t HashStr(char const *Str, size_t Len);
+static uint64_t Image_Fingerprint(void);
+static int Image_Read(struct LexData *OutLex, struct FlatAst *OutAst, struct FileData *OutFile, int Fd, struct FileData const *CacheFile, uint64_t SrcHash);
+static int Image_Write(FILE *Fp, struct LexData const *Lex, struct FlatAst const *Ast, bool Interface, char const *Src, uint64_t SrcHash, size_t SrcLen);
+static char *ImportPath(struct FlatAst const *Ast, uint32_t Import);
+static uint32_t Interface_CopyNode(struct FlatAst *Out, struct LexData *OutLex, struct FlatAst const *Ast, uint32_t Node);
+static int Interface_Load(struct ModuleData *Out, FILE *Fp, char const *Path);
+static void Interface_MarkRefs(struct FlatAst const *Ast, uint32_t Node, uint32_t const *Slots, size_t SlotCnt, unsigned char *Keep);
+static int Interface_Write(FILE *Fp, struct FileData const *File, struct FlatAst const *Ast);
+static char const *Interner_Add(char const *Str, size_t Len);
+static void Interner_Destroy(struct Interner *Interner);
+static char const *Interner_Insert(struct Interner *Interner, char const *Str, size_t Len);
+#ifndef LITHIC_LIB
+static void Interner_Quit(void);
+#endif
 static bool IsIdentInit(char ch);
 static int Lex(struct LexData *Out, struct FileData const *Data);
-static int LexChar(struct FileData const *Data, struct Token *Out, size_t *i);
+static int LexChar(struct LexData *Out, struct FileData const *Data, size_t *i);
+static void *LexChunk_Work(void *Arg);
+static uint32_t LexData_AddNum(struct LexData *Out, union TokenNum Num);
 static void LexData_AddSpecialChar(struct LexData *Out, size_t Pos, size_t Len, enum TokenType Type);
+static uint32_t LexData_AddStr(struct LexData *Out, char const *Text, size_t Len);
 static void LexData_AddToken(struct LexData *Out, struct Token const *Tok);
+static void LexData_Append(struct LexData *Out, struct LexData const *Chunk);
 static void LexData_Destroy(struct LexData *Data);
-static int LexString(struct FileData const *Data, struct Token *Out, size_t *i);
-static int LexNum(struct FileData const *Data, struct Token *Out, size_t *i);
-static int LexWord(struct FileData const *Data, struct Token *Out, size_t *i);
-static size_t LineNumber(char const *Str, size_t Pos);
-static void LogAstNodeContext(struct FileData const *Data, struct AstNode const *Node, char const *Fmt, ...);
-static void LogAstNodeErr(struct FileData const *Data, struct AstNode const *Node, char const *Fmt, ...);
+static char const *LexData_Text(struct LexData const *Lex, struct Token const *Tok);
+static int LexString(struct LexData *Out, struct FileData const *Data, size_t *i);
+static int LexNum(struct LexData *Out, struct FileData const *Data, size_t *i);
+static int LexRange(struct LexData *Out, struct FileData const *Data, size_t Begin, size_t End, size_t *OutStop);
+static int LexWord(struct LexData *Out, struct FileData const *Data, size_t *i);
+static void LogAstNodeContext(struct ModuleData const *Mod, uint32_t Node, char const *Fmt, ...);
+static void LogAstNodeErr(struct ModuleData const *Mod, uint32_t Node, char const *Fmt, ...);
+static void LogClose(FILE *Fp, char **Msg, size_t *MsgLen);
 static void LogErr(char const *Fmt, ...);
+static FILE *LogOpen(char **Msg, size_t *MsgLen);
 static void LogProgErr(struct FileData const *Data, size_t Pos, size_t Len, char const *Fmt, ...);
-static void LogProgPosition(struct FileData const *Data, size_t Pos, size_t Len, char const *HlStyle);
+static void LogProgPosition(FILE *Fp, struct FileData const *Data, size_t Pos, size_t Len, char const *HlStyle);
 static void LogTokErr(struct FileData const *Data, struct Token const *Tok, char const *Fmt, ...);
 static void ModuleData_Destroy(struct ModuleData *Data);
+static bool ModuleData_IsLive(struct ModuleData const *Mod, uint32_t Node);
+static uint32_t ModuleData_ProcBody(struct ModuleData *Mod, uint32_t Proc);
 static void ModuleDataGroup_Append(struct ModuleDataGroup *Group, struct ModuleData const *Data);
 static void ModuleDataGroup_Destroy(struct ModuleDataGroup *Group);
+static int ModuleLoad_Process(struct ModuleLoad *Load, unsigned Thread, struct ModuleLoad **OutImports, size_t *OutImportCnt);
+static void *ModuleLoader_Work(void *Arg);
 static struct Token const *NextToken(struct ParseState *Ps);
 static FILE *OpenFile(char const *File, char const *Mode);
-static int Parse(struct AstNode *Out, struct FileData const *File, struct LexData const *Lex);
+static int Parse(struct FlatAst *Out, struct FileData const *File, struct LexData const *Lex, bool Lazy);
 static int ParseArgList(struct AstNode *Out, struct ParseState *Ps);
 static int ParseBlock(struct AstNode *Out, struct ParseState *Ps);
 static int ParseBreak(struct AstNode *Out, struct ParseState *Ps);
+static void *ParseChunk_Work(void *Arg);
+static int ParseChunked(struct FlatAst *Out, struct FileData const *File, struct LexData const *Lex, size_t ChunkCnt, bool Lazy);
 static int ParseCondTree(struct AstNode *Out, struct ParseState *Ps);
 static int ParseContinue(struct AstNode *Out, struct ParseState *Ps);
 static int ParseDefer(struct AstNode *Out, struct ParseState *Ps);
@@ -463,8 +991,10 @@ static int ParseExprList(struct AstNode *Out, struct ParseState *Ps);
 static int ParseExprNud(struct AstNode *Out, struct ParseState *Ps, unsigned char const Term[], size_t TermCnt);
 static int ParseFor(struct AstNode *Out, struct ParseState *Ps);
 static int ParseImport(struct AstNode *Out, struct ParseState *Ps);
+static int ParseLazyBody(struct AstNode *Out, struct ParseState *Ps);
 static int ParseProc(struct AstNode *Out, struct ParseState *Ps);
-static int ParseProgram(struct AstNode *Out, struct ParseState *Ps);
+static int ParseProgram(struct FlatAst *Out, struct ParseState *Ps);
+static void ParseProgram_AddDecl(struct FlatAst *Out, uint32_t *Prev, struct AstNode const *Decl, struct ParseState *Ps);
 static int ParseResetVargs(struct AstNode *Out, struct ParseState *Ps);
 static int ParseReturn(struct AstNode *Out, struct ParseState *Ps);
 static int ParseStatement(struct AstNode *Out, struct ParseState *Ps);
@@ -479,24 +1009,57 @@ static int ParseWrappedExpr(struct AstNode *Out, struct ParseState *Ps, unsigned
 static int ParseWrappedType(struct AstNode *Out, struct ParseState *Ps, unsigned char const Term[], size_t TermCnt);
 static struct Token const *PeekPrevToken(struct ParseState const *Ps);
 static struct Token const *PeekToken(struct ParseState const *Ps);
+#ifndef LITHIC_LIB
+static void PrintJsonStr(FILE *Fp, char const *Str);
 static void PrintTimeData(void);
-static char *ResolveImport(struct AstNode const *Import);
+#endif
+static char *ResolveImport(struct FlatAst const *Ast, uint32_t Import);
+static int Reach_Decl(struct Reach *Reach, struct SymtabEntry const *Ent);
+static void Reach_Mark(struct Reach *Reach, struct SymtabEntry const *Ent);
+static void Reach_Node(struct Reach *Reach, size_t ModInd, uint32_t Node);
+static void Reach_Push(struct Reach *Reach, struct SymtabEntry const *Ent);
+static int ReadFull(int Fd, void *Buf, size_t Len);
 static struct Token const *RequireToken(struct ParseState *Ps);
+#ifdef SCAN_X86
+static size_t Scan_Avx2(char const *Data, size_t Len, size_t i, enum ScanClass Class);
+#endif
+static void Scan_Init(void);
+static bool Scan_IsStop(char Ch, enum ScanClass Class);
+static size_t Scan_Scalar(char const *Data, size_t Len, size_t i, enum ScanClass Class);
+#ifdef SCAN_X86
+static size_t Scan_Sse2(char const *Data, size_t Len, size_t i, enum ScanClass Class);
+#endif
+#ifndef LITHIC_LIB
+static void Server_Compact(void);
+#endif
+static int Server_Find(struct ModuleData *Out, FILE *Fp);
+static void Server_Keep(struct ModuleData *Data, struct stat const *Stat, uint64_t Hash);
+static void Server_Release(struct ModuleData const *Data);
+#ifndef LITHIC_LIB
+static int Server_Run(char const *Path);
+static void Server_Serve(int Conn);
+#endif
 static unsigned SizeModBits(enum SizeMod Mod);
 static void SkipParseNewlines(struct ParseState *Ps);
 static int StrNumCmp(char const *a, size_t LenA, char const *b, size_t LenB);
-static char *Substr(char const *Str, size_t Lb, size_t Ub);
 static void Symtab_AddType(struct Symtab *Symtab, struct SymtabEntry const *Ent);
 static void Symtab_AddValue(struct Symtab *Symtab, struct SymtabEntry const *Ent);
 static void Symtab_Destroy(struct Symtab *Symtab);
-static int Symtab_RegisterAstNode(struct Symtab *Symtab, struct FileData const *File, struct AstNode const *Node);
+static void Symtab_DestroyAll(struct Symtab *Symtabs, size_t Cnt);
+static size_t Symtab_Hash(char const *Name, char const *SuperName);
+static void Symtab_Index(uint32_t *Slots, size_t SlotCnt, struct SymtabEntry const *Ents, size_t Ind);
+static void Symtab_Prune(struct Symtab *Symtab);
+static int Symtab_RegisterAstNode(struct Symtab *Symtab, struct ModuleData const *Mod, uint32_t Node);
 static struct SymtabEntry const *Symtab_SearchTypes(struct Symtab const *Symtab, char const *Name);
 static struct SymtabEntry const *Symtab_SearchValues(struct Symtab const *Symtab, char const *Name, char const *SuperName);
-static void Token_Destroy(struct Token *Tok);
-static void Token_Print(FILE *Fp, struct Token const *Tok, size_t Ind);
+static void TimeData_AddEvent(char const *Phase, char const *Module, uint64_t Begin, uint64_t End, unsigned Thread);
+static void Token_Print(FILE *Fp, struct LexData const *Lex, struct Token const *Tok, size_t Ind);
 static enum AstNodeType TokenTypeToLed(enum TokenType Type);
 static enum AstNodeType TokenTypeToNud(enum TokenType Type);
+#ifndef LITHIC_LIB
 static void Usage(char const *Name);
+#endif
+static int WriteFull(int Fd, void const *Buf, size_t Len);
 
 static struct StrNumLimit StrNumLimits[] =
 {
@@ -598,6 +1161,57 @@ static char const *Keywords[] =
 	"Vargs"
 };
 
+static unsigned char KeywordTable[128] =
+{
+	// every keyword must hash to a distinct slot, unused slots are TT_IDENT.
+	[KEYWORD_HASH('A', 's', 's', 2)] = TT_KW_AS,
+	[KEYWORD_HASH('B', 'a', 'e', 4)] = TT_KW_BASE,
+	[KEYWORD_HASH('B', 'l', 'k', 5)] = TT_KW_BLOCK,
+	[KEYWORD_HASH('B', 'o', 'l', 4)] = TT_KW_BOOL,
+	[KEYWORD_HASH('B', 'r', 'k', 5)] = TT_KW_BREAK,
+	[KEYWORD_HASH('C', 'a', 'e', 4)] = TT_KW_CASE,
+	[KEYWORD_HASH('C', 'o', 'e', 8)] = TT_KW_CONTINUE,
+	[KEYWORD_HASH('D', 'e', 'r', 5)] = TT_KW_DEFER,
+	[KEYWORD_HASH('E', 'l', 'f', 4)] = TT_KW_ELIF,
+	[KEYWORD_HASH('E', 'l', 'e', 4)] = TT_KW_ELSE,
+	[KEYWORD_HASH('E', 'n', 'd', 3)] = TT_KW_END,
+	[KEYWORD_HASH('E', 'n', 'm', 4)] = TT_KW_ENUM,
+	[KEYWORD_HASH('E', 'x', 'c', 10)] = TT_KW_EXTERNPROC,
+	[KEYWORD_HASH('E', 'x', 'r', 9)] = TT_KW_EXTERNVAR,
+	[KEYWORD_HASH('F', 'a', 'e', 5)] = TT_KW_FALSE,
+	[KEYWORD_HASH('F', 'l', '2', 7)] = TT_KW_FLOAT32,
+	[KEYWORD_HASH('F', 'l', '4', 7)] = TT_KW_FLOAT64,
+	[KEYWORD_HASH('F', 'o', 'r', 3)] = TT_KW_FOR,
+	[KEYWORD_HASH('I', 'f', 'f', 2)] = TT_KW_IF,
+	[KEYWORD_HASH('I', 'm', 't', 6)] = TT_KW_IMPORT,
+	[KEYWORD_HASH('I', 'n', '8', 4)] = TT_KW_INT8,
+	[KEYWORD_HASH('I', 'n', '6', 5)] = TT_KW_INT16,
+	[KEYWORD_HASH('I', 'n', '2', 5)] = TT_KW_INT32,
+	[KEYWORD_HASH('I', 'n', '4', 5)] = TT_KW_INT64,
+	[KEYWORD_HASH('I', 's', 'e', 5)] = TT_KW_ISIZE,
+	[KEYWORD_HASH('L', 'e', 'f', 5)] = TT_KW_LENOF,
+	[KEYWORD_HASH('M', 'u', 't', 3)] = TT_KW_MUT,
+	[KEYWORD_HASH('N', 'e', 'g', 8)] = TT_KW_NEXTVARG,
+	[KEYWORD_HASH('N', 'u', 'l', 4)] = TT_KW_NULL,
+	[KEYWORD_HASH('P', 'r', 'c', 4)] = TT_KW_PROC,
+	[KEYWORD_HASH('R', 'e', 's', 10)] = TT_KW_RESETVARGS,
+	[KEYWORD_HASH('R', 'e', 'n', 6)] = TT_KW_RETURN,
+	[KEYWORD_HASH('S', 'e', 'f', 4)] = TT_KW_SELF,
+	[KEYWORD_HASH('S', 'i', 'f', 6)] = TT_KW_SIZEOF,
+	[KEYWORD_HASH('S', 't', 't', 6)] = TT_KW_STRUCT,
+	[KEYWORD_HASH('S', 'w', 'h', 6)] = TT_KW_SWITCH,
+	[KEYWORD_HASH('T', 'r', 'e', 4)] = TT_KW_TRUE,
+	[KEYWORD_HASH('U', 'i', '8', 5)] = TT_KW_UINT8,
+	[KEYWORD_HASH('U', 'i', '6', 6)] = TT_KW_UINT16,
+	[KEYWORD_HASH('U', 'i', '2', 6)] = TT_KW_UINT32,
+	[KEYWORD_HASH('U', 'i', '4', 6)] = TT_KW_UINT64,
+	[KEYWORD_HASH('U', 'n', 'n', 5)] = TT_KW_UNION,
+	[KEYWORD_HASH('U', 's', 'e', 5)] = TT_KW_USIZE,
+	[KEYWORD_HASH('V', 'a', 'r', 3)] = TT_KW_VAR,
+	[KEYWORD_HASH('V', 'a', 't', 9)] = TT_KW_VARGCOUNT,
+	[KEYWORD_HASH('V', 'a', 's', 5)] = TT_KW_VARGS
+};
+
 static char const *TokenTypeNames[] =
 {
 	"TT_IDENT",
@@ -816,6 +1430,8 @@ static struct BindPower ExprBindPower[] =
 	{0},
 	{0},
 	{0},
+	{0},
+	{0},
 	
 	// precedence group 14.
 	{27, 28}, // ++
@@ -891,207 +1507,114 @@ static struct BindPower ExprBindPower[] =
 	{2, 1} // |=
 };
 
-static struct Conf Conf;
-static struct TimeData TimeData;
+// identifiers which cannot be used as is in generated code, sorted.
+static char const *CReservedNames[] =
+{
+	"NULL", "_Bool", "_Complex", "_Imaginary", "auto", "bool", "break", "case",
+	"char", "const", "continue", "default", "do", "double", "else", "enum",
+	"extern", "false", "float", "for", "goto", "if", "inline", "int",
+	"int16_t", "int32_t", "int64_t", "int8_t", "long", "main", "memcmp",
+	"offsetof", "ptrdiff_t", "register", "restrict", "return", "short",
+	"signed", "size_t", "sizeof", "static", "struct", "switch", "true",
+	"typedef", "uint16_t", "uint32_t", "uint64_t", "uint8_t", "union",
+	"unsigned", "va_arg", "va_copy", "va_end", "va_list", "va_start", "void",
+	"volatile", "wchar_t", "while"
+};
+
+static struct Server Server =
+{
+	.Lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+// finds the first byte at or after `i` belonging to `Class`, or `Len` if there
+// is none; set by `Scan_Init` to the fastest implementation supported.
+static size_t (*Scan)(char const *Data, size_t Len, size_t i, enum ScanClass Class) = Scan_Scalar;
+static pthread_once_t ScanOnce = PTHREAD_ONCE_INIT;
+
+// context of the compilation running on a thread, which worker threads inherit
+// from the thread starting them.
+static __thread struct Lithic *Ctx;
+
+// set on threads whose errors may be spurious, e.g. during speculative lexing
+// or parsing, to keep them from being reported.
+static __thread bool LogMuted;
 
+// set on threads lexing a chunk, so that they intern strings without
+// contending for the lock on the context's interner.
+static __thread struct Interner *LocalInterner;
+
+#ifndef LITHIC_LIB
 int
 main(int Argc, char const *Argv[])
 {
-	atexit(PrintTimeData);
-	
-	// read configuration.
-	{
-		TimeData.ConfReadBegin = GetUnixTimeMs();
-		if (Conf_Read(Argc, Argv))
-			return 1;
-		TimeData.ConfReadEnd = GetUnixTimeMs();
-	}
-	
-	// read input file.
-	struct FileData FileData = {0};
-	{
-		TimeData.FileReadBegin = GetUnixTimeMs();
-		if (FileData_Read(&FileData, Conf.InFp, Conf.InFile))
-			return 1;
-		TimeData.FileReadEnd = GetUnixTimeMs();
-	}
-	
-	// lex input file.
-	struct LexData LexData = {0};
+	static struct Lithic Cli =
 	{
-		TimeData.LexBegin = GetUnixTimeMs();
-		if (Lex(&LexData, &FileData))
-		{
-			FileData_Destroy(&FileData);
-			return 1;
-		}
-		TimeData.LexEnd = GetUnixTimeMs();
-		
-		if (Conf.Flags & CF_DUMP_TOKS)
-		{
-			for (size_t i = 0; i < LexData.TokCnt; ++i)
-				Token_Print(Conf.OutFp, &LexData.Toks[i], i);
-			
-			LexData_Destroy(&LexData);
-			FileData_Destroy(&FileData);
-			return 0;
-		}
-	}
-	
-	// parse input file.
-	struct AstNode Ast = {0};
-	{
-		TimeData.ParseBegin = GetUnixTimeMs();
-		if (Parse(&Ast, &FileData, &LexData))
-		{
-			LexData_Destroy(&LexData);
-			FileData_Destroy(&FileData);
-			return 1;
-		}
-		TimeData.ParseEnd = GetUnixTimeMs();
-		
-		if (Conf.Flags & CF_DUMP_AST)
-		{
-			AstNode_Print(Conf.OutFp, &Ast, 0);
-			
-			AstNode_Destroy(&Ast);
-			LexData_Destroy(&LexData);
-			FileData_Destroy(&FileData);
-			return 0;
-		}
-	}
-	
-	struct ModuleData ModuleData =
-	{
-		.File = FileData,
-		.Lex = LexData,
-		.Ast = Ast,
-		.FullPath = FullPathname(Conf.InFile)
+		.TimeData.Lock = PTHREAD_MUTEX_INITIALIZER,
+		.Interner.Lock = PTHREAD_MUTEX_INITIALIZER,
+		.HookLock = PTHREAD_MUTEX_INITIALIZER
 	};
+	Ctx = &Cli;
 	
-	struct ModuleDataGroup ModuleDataGroup = {0};
-	ModuleDataGroup_Append(&ModuleDataGroup, &ModuleData);
-	
-	// extract and read imports.
-	{
-		TimeData.ExtractImportsBegin = GetUnixTimeMs();
-		if (ExtractImports(&FileData, &ModuleDataGroup, &Ast, 0))
-		{
-			ModuleDataGroup_Destroy(&ModuleDataGroup);
-			return 1;
-		}
-		TimeData.ExtractImportsEnd = GetUnixTimeMs();
-	}
-	
-	// build symtab globals.
-	struct Symtab Symtab = {0};
-	{
-		TimeData.BuildSymtabGlobalsBegin = GetUnixTimeMs();
-		if (BuildSymtabGlobals(&Symtab, &ModuleDataGroup))
-		{
-			ModuleDataGroup_Destroy(&ModuleDataGroup);
-			return 1;
-		}
-		TimeData.BuildSymtabGlobalsEnd = GetUnixTimeMs();
-	}
-	
-	// check acyclicity of language elements where necessary.
-	{
-		TimeData.CheckAcyclicityBegin = GetUnixTimeMs();
-		if (CheckAcyclicity(&Symtab))
-		{
-			Symtab_Destroy(&Symtab);
-			ModuleDataGroup_Destroy(&ModuleDataGroup);
-			return 1;
-		}
-		TimeData.CheckAcyclicityEnd = GetUnixTimeMs();
-	}
+	// timing data refers to interned strings, so print it first.
+	atexit(Interner_Quit);
+	atexit(PrintTimeData);
+	atexit(Conf_Quit);
 	
-	// analyze modules.
-	{
-		TimeData.AnalyzeBegin = GetUnixTimeMs();
-		if (Analyze(&Symtab, &ModuleDataGroup))
-		{
-			Symtab_Destroy(&Symtab);
-			ModuleDataGroup_Destroy(&ModuleDataGroup);
-			return 1;
-		}
-		TimeData.AnalyzeEnd = GetUnixTimeMs();
-	}
+	pthread_once(&ScanOnce, Scan_Init);
 	
-	// TODO: implement rest of transpilation process.
+	// server and client modes are selected by the first option.
+	if (Argc == 3 && !strcmp(Argv[1], "--server"))
+		return Server_Run(Argv[2]);
+	else if (Argc >= 3 && !strcmp(Argv[1], "--client"))
+		return Client_Run(Argv[2], Argc, Argv);
 	
-	Symtab_Destroy(&Symtab);
-	ModuleDataGroup_Destroy(&ModuleDataGroup);
-	return 0;
+	return Compile(Argc, Argv);
 }
+#endif
 
 static int
-Analyze(struct Symtab *Symtab, struct ModuleDataGroup const *Modules)
+Analyze(struct Symtab *Symtabs, struct ModuleDataGroup *Modules)
 {
-	// analyze imported modules.
-	{
-		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
-		{
-			struct ModuleData const *Mod = &Modules->Modules[i];
-			for (size_t j = 0; j < Mod->Ast.ChildCnt; ++j)
-			{
-				struct AstNode const *Child = &Mod->Ast.Children[j];
-				switch (Child->Type)
-				{
-				case ANT_PROC:
-					if (AnalyzeProc(Symtab, &Mod->File, Child))
-						return 1;
-					break;
-				case ANT_VAR:
-					if (AnalyzeGlobalVar(Symtab, &Mod->File, Child))
-						return 1;
-					break;
-				case ANT_STRUCT:
-				case ANT_UNION:
-					if (AnalyzeDataStructure(Symtab, &Mod->File, Child))
-						return 1;
-					break;
-				case ANT_ENUM:
-					if (AnalyzeEnum(Symtab, &Mod->File, Child))
-						return 1;
-					break;
-				default:
-					break;
-				}
-			}
-		}
-	}
+	// `Symtabs` holds the symtab of each module, by module index.
 	
-	// analyze main module.
+	// analyze imported modules, then the main module.
+	for (size_t i = 1; i <= Modules->ModuleCnt; ++i)
 	{
-		struct ModuleData const *Mod = &Modules->Modules[0];
-		for (size_t i = 0; i < Mod->Ast.ChildCnt; ++i)
+		uint64_t Begin = GetTimeNs();
+		size_t Ind = i % Modules->ModuleCnt;
+		struct Symtab *Symtab = &Symtabs[Ind];
+		struct ModuleData *Mod = &Modules->Modules[Ind];
+		struct FlatAst const *Ast = &Mod->Ast;
+		for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
 		{
-			struct AstNode const *Child = &Mod->Ast.Children[i];
-			switch (Child->Type)
+			if (!ModuleData_IsLive(Mod, Child))
+				continue;
+			
+			switch (Ast->Nodes[Child].Type)
 			{
 			case ANT_PROC:
-				if (AnalyzeProc(Symtab, &Mod->File, Child))
+				if (AnalyzeProc(Symtab, Mod, Child))
 					return 1;
 				break;
 			case ANT_VAR:
-				if (AnalyzeGlobalVar(Symtab, &Mod->File, Child))
+				if (AnalyzeGlobalVar(Symtab, Mod, Child))
 					return 1;
 				break;
 			case ANT_STRUCT:
 			case ANT_UNION:
-				if (AnalyzeDataStructure(Symtab, &Mod->File, Child))
+				if (AnalyzeDataStructure(Symtab, Mod, Child))
 					return 1;
 				break;
 			case ANT_ENUM:
-				if (AnalyzeEnum(Symtab, &Mod->File, Child))
+				if (AnalyzeEnum(Symtab, Mod, Child))
 					return 1;
 				break;
 			default:
 				break;
 			}
 		}
+		
+		TimeData_AddEvent("analyze", Mod->File.Name, Begin, GetTimeNs(), 0);
 	}
 	
 	return 0;
@@ -1100,39 +1623,40 @@ Analyze(struct Symtab *Symtab, struct ModuleDataGroup const *Modules)
 static int
 AnalyzeCommonType(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData const *Mod,
+	uint32_t Node
 )
 {
-	switch (Node->Type)
+	struct FlatAst const *Ast = &Mod->Ast;
+	switch (Ast->Nodes[Node].Type)
 	{
 	case ANT_TYPE:
 	case ANT_TYPE_PTR:
 	case ANT_TYPE_ARRAY:
-		return AnalyzeCommonType(Symtab, File, &Node->Children[0]);
+		return AnalyzeCommonType(Symtab, Mod, Ast->Nodes[Node].FirstChild);
 	case ANT_TYPE_ATOM:
 	{
-		struct Token const *Tok = Node->Toks[0];
+		struct Token const *Tok = FlatAst_Token(Ast, Node, 0);
 		switch (Tok->Type)
 		{
 		case TT_IDENT:
 		{
-			struct SymtabEntry const *Ent = Symtab_SearchTypes(Symtab, Tok->Data.Str.Text);
+			struct SymtabEntry const *Ent = Symtab_SearchTypes(Symtab, LexData_Text(&Ast->Lex, Tok));
 			if (!Ent)
 			{
-				LogAstNodeErr(File, Node, "use of unrecognized type!");
+				LogAstNodeErr(Mod, Node, "use of unrecognized type!");
 				return 1;
 			}
 			break;
 		}
 		case TT_KW_SELF:
-			LogAstNodeErr(File, Node, "Self cannot be used in common types!");
+			LogAstNodeErr(Mod, Node, "Self cannot be used in common types!");
 			return 1;
 		case TT_KW_NULL:
-			LogAstNodeErr(File, Node, "Null can only be used for function return types!");
+			LogAstNodeErr(Mod, Node, "Null can only be used for function return types!");
 			return 1;
 		case TT_TRIPLE_PERIOD:
-			LogAstNodeErr(File, Node, "... cannot be used in common types!");
+			LogAstNodeErr(Mod, Node, "... cannot be used in common types!");
 			return 1;
 		default:
 			break;
@@ -1142,77 +1666,81 @@ AnalyzeCommonType(
 	}
 	case ANT_TYPE_PROC:
 	{
-		struct AstNode const *RetType = &Node->Children[0];
-		if (RetType->Toks[0]->Type != TT_KW_NULL)
+		uint32_t RetType = Ast->Nodes[Node].FirstChild;
+		if (FlatAst_Token(Ast, RetType, 0)->Type != TT_KW_NULL)
 		{
-			if (AnalyzeCommonType(Symtab, File, RetType))
+			if (AnalyzeCommonType(Symtab, Mod, RetType))
 				return 1;
 		}
 		
-		for (size_t i = 1; i < Node->ChildCnt; ++i)
+		for (uint32_t Arg = Ast->Nodes[RetType].NextSibling; Arg; Arg = Ast->Nodes[Arg].NextSibling)
 		{
-			if (AnalyzeCommonType(Symtab, File, &Node->Children[i]))
+			if (AnalyzeCommonType(Symtab, Mod, Arg))
 				return 1;
 		}
 		
 		return 0;
 	}
 	case ANT_TYPE_BUFFER:
-		// TODO: implement common buffer type semanal.
-		return 1;
-	default:
-		return 0;
-	}
-}
+	{
+		uint32_t Elem = Ast->Nodes[Node].FirstChild;
+		uint32_t Len = Ast->Nodes[Elem].NextSibling;
+		
+		struct ConstVal Val;
+		if (AnalyzeConstExpr(Symtab, Mod, Len, &Val))
+			return 1;
+		if (Val.Type && (Val.Type != CVT_INT || (Val.Signed && (int64_t)Val.Int < 0)))
+		{
+			LogAstNodeErr(Mod, Len, "buffer length must be a non-negative integer!");
+			return 1;
+		}
+		
+		return AnalyzeCommonType(Symtab, Mod, Elem);
+	}
+	default:
+		return 0;
+	}
+}
 
 static int
 AnalyzeConstExpr(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData const *Mod,
+	uint32_t Node,
+	struct ConstVal *Out
 )
 {
-	// TODO: finish implementing const expr semanal.
+	// values which cannot be folded are left to the C compiler, which rejects
+	// them where it needs constants.
 	
-	switch (Node->Type)
-	{
-	case ANT_EXPR:
-		return AnalyzeConstExpr(Symtab, File, &Node->Children[0]);
-		
-		// ...
-		
-	default:
-		return 0;
-	}
+	struct ConstEval Ce = {.Mod = Mod};
+	return ConstEval_Expr(&Ce, Node, Out);
 }
 
 static int
 AnalyzeDataStructure(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData const *Mod,
+	uint32_t Node
 )
 {
-	for (size_t i = 0; i < Node->ChildCnt; ++i)
+	struct FlatAst const *Ast = &Mod->Ast;
+	for (uint32_t Memb = Ast->Nodes[Node].FirstChild; Memb; Memb = Ast->Nodes[Memb].NextSibling)
 	{
-		struct AstNode const *Memb = &Node->Children[i];
-		
 		// check for duplicate declaration.
-		for (size_t j = i + 1; j < Node->ChildCnt; ++j)
+		for (uint32_t Other = Ast->Nodes[Memb].NextSibling; Other; Other = Ast->Nodes[Other].NextSibling)
 		{
-			struct AstNode const *Other = &Node->Children[j];
-			
-			char const *MembName = Memb->Toks[0]->Data.Str.Text;
-			char const *OtherName = Other->Toks[0]->Data.Str.Text;
-			if (!strcmp(MembName, OtherName))
+			char const *MembName = FlatAst_TokenText(Ast, Memb, 0);
+			char const *OtherName = FlatAst_TokenText(Ast, Other, 0);
+			if (MembName == OtherName)
 			{
-				LogAstNodeErr(File, Other, "redeclaration of data structure member!");
-				LogAstNodeContext(File, Memb, "previously declared here:");
+				LogAstNodeErr(Mod, Other, "redeclaration of data structure member!");
+				LogAstNodeContext(Mod, Memb, "previously declared here:");
 				return 1;
 			}
 		}
 		
-		if (AnalyzeCommonType(Symtab, File, &Memb->Children[0]))
+		if (AnalyzeCommonType(Symtab, Mod, Ast->Nodes[Memb].FirstChild))
 			return 1;
 	}
 	
@@ -1222,14 +1750,16 @@ AnalyzeDataStructure(
 static int
 AnalyzeEnum(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData const *Mod,
+	uint32_t Node
 )
 {
+	struct FlatAst const *Ast = &Mod->Ast;
+	uint32_t Type = Ast->Nodes[Node].FirstChild;
+	
 	// require enum is derived from integer type.
 	{
-		struct AstNode const *Type = &Node->Children[0];
-		struct Token const *Tok = Type->Children[0].Toks[0];
+		struct Token const *Tok = FlatAst_Token(Ast, Ast->Nodes[Type].FirstChild, 0);
 		
 		switch (Tok->Type)
 		{
@@ -1245,125 +1775,352 @@ AnalyzeEnum(
 		case TT_KW_ISIZE:
 			break;
 		default:
-			LogAstNodeErr(File, Type, "enums must be derived from integer types!");
+			LogAstNodeErr(Mod, Type, "enums must be derived from integer types!");
 			return 1;
 		}
 	}
 	
-	for (size_t i = 1; i < Node->ChildCnt; ++i)
+	// the value of the previous member, untyped if not known.
+	struct ConstEval Ce = {.Mod = Mod};
+	struct ConstVal Base, Prev;
+	ConstEval_Type(Mod, Type, &Base);
+	
+	for (uint32_t Memb = Ast->Nodes[Type].NextSibling; Memb; Memb = Ast->Nodes[Memb].NextSibling)
 	{
-		struct AstNode const *Memb = &Node->Children[i];
-		
 		// check for duplicate declaration.
-		for (size_t j = i + 1; j < Node->ChildCnt; ++j)
+		for (uint32_t Other = Ast->Nodes[Memb].NextSibling; Other; Other = Ast->Nodes[Other].NextSibling)
 		{
-			struct AstNode const *Other = &Node->Children[j];
-			
-			char const *MembName = Memb->Toks[0]->Data.Str.Text;
-			char const *OtherName = Other->Toks[0]->Data.Str.Text;
-			if (!strcmp(MembName, OtherName))
+			char const *MembName = FlatAst_TokenText(Ast, Memb, 0);
+			char const *OtherName = FlatAst_TokenText(Ast, Other, 0);
+			if (MembName == OtherName)
 			{
-				LogAstNodeErr(File, Other, "redeclaration of enum member!");
-				LogAstNodeContext(File, Memb, "previously declared here:");
+				LogAstNodeErr(Mod, Other, "redeclaration of enum member!");
+				LogAstNodeContext(Mod, Memb, "previously declared here:");
 				return 1;
 			}
 		}
 		
-		if (Memb->ChildCnt == 1)
+		if (Ast->Nodes[Memb].ChildCnt == 1)
+		{
+			struct ConstVal Val;
+			if (AnalyzeConstExpr(Symtab, Mod, Ast->Nodes[Memb].FirstChild, &Val))
+				return 1;
+			
+			if (Val.Type && Val.Type != CVT_INT)
+			{
+				LogAstNodeErr(Mod, Ast->Nodes[Memb].FirstChild, "enum member values must be integers!");
+				return 1;
+			}
+			
+			Prev.Type = 0;
+			if (Val.Type && ConstEval_Assign(&Ce, Ast->Nodes[Memb].FirstChild, &Val, &Base, &Prev))
+				return 1;
+		}
+		else if (Memb == Ast->Nodes[Type].NextSibling)
+			Prev = Base;
+		else if (Prev.Type)
 		{
-			if (AnalyzeConstExpr(Symtab, File, &Memb->Children[0]))
+			// implicit values count up from the previous one, and must stay in
+			// range just as explicit ones.
+			struct ConstVal Next = {.Type = CVT_INT, .SizeMod = SM_64, .Signed = Prev.Signed, .Int = Prev.Int + 1};
+			if (Next.Int == (Next.Signed ? (uint64_t)INT64_MIN : 0))
+			{
+				LogAstNodeErr(Mod, Memb, "constant is out of range of its type!");
 				return 1;
+			}
 			
-			// TODO: implement typecheck for enum member.
+			if (ConstEval_Assign(&Ce, Memb, &Next, &Base, &Prev))
+				return 1;
+		}
+	}
+	
+	return 0;
+}
+
+static int
+AnalyzeGlobalInit(
+	struct Symtab *Symtab,
+	struct ModuleData const *Mod,
+	uint32_t Node
+)
+{
+	// C requires global initial values to be constants, so they must either
+	// fold or be built from the addresses of globals and procedures.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	uint32_t Lhs = Ast->Nodes[Node].FirstChild;
+	
+	struct ConstVal Val;
+	if (AnalyzeConstExpr(Symtab, Mod, Node, &Val))
+		return 1;
+	if (Val.Type)
+		return 0;
+	
+	switch (Ast->Nodes[Node].Type)
+	{
+	case ANT_EXPR:
+	case ANT_EXPR_CAST:
+		return AnalyzeGlobalInit(Symtab, Mod, Lhs);
+	case ANT_EXPR_NULL:
+	case ANT_EXPR_LAMBDA:
+		return 0;
+	case ANT_EXPR_LIST:
+		for (uint32_t Elem = Lhs; Elem; Elem = Ast->Nodes[Elem].NextSibling)
+		{
+			if (AnalyzeGlobalInit(Symtab, Mod, Elem))
+				return 1;
+		}
+		return 0;
+	case ANT_EXPR_STRUCT:
+	case ANT_EXPR_UNION:
+		for (uint32_t Memb = Lhs; Memb; Memb = Ast->Nodes[Memb].NextSibling)
+		{
+			if (AnalyzeGlobalInit(Symtab, Mod, Ast->Nodes[Memb].FirstChild))
+				return 1;
 		}
+		return 0;
+	case ANT_EXPR_ATOM:
+	{
+		struct Token const *Tok = FlatAst_Token(Ast, Node, 0);
+		if (Tok->Type == TT_LIT_STR || Tok->Type == TT_KW_NULL)
+			return 0;
+		
+		struct SymtabEntry const *Ent = NULL;
+		if (Tok->Type == TT_IDENT)
+			Ent = Symtab_SearchValues(Symtab, LexData_Text(&Ast->Lex, Tok), NULL);
+		if (Ent && Ent->Type == SET_PROC)
+			return 0;
+		break;
+	}
+	case ANT_EXPR_TYPE_ACCESS:
+	{
+		char const *TypeName = FlatAst_TokenText(Ast, Lhs, 0);
+		char const *Name = FlatAst_TokenText(Ast, Ast->Nodes[Lhs].NextSibling, 0);
+		struct SymtabEntry const *Ent = Symtab_SearchValues(Symtab, Name, TypeName);
+		if (Ent && Ent->Type == SET_PROC)
+			return 0;
+		break;
+	}
+	case ANT_EXPR_ADDR_OF:
+	{
+		while (Ast->Nodes[Lhs].Type == ANT_EXPR)
+			Lhs = Ast->Nodes[Lhs].FirstChild;
+		if (Ast->Nodes[Lhs].Type != ANT_EXPR_ATOM || FlatAst_Token(Ast, Lhs, 0)->Type != TT_IDENT)
+			break;
+		
+		struct SymtabEntry const *Ent = Symtab_SearchValues(Symtab, FlatAst_TokenText(Ast, Lhs, 0), NULL);
+		if (Ent)
+			return 0;
+		break;
+	}
+	default:
+		break;
 	}
 	
+	LogAstNodeErr(Mod, Node, "global variable initial values must be constant!");
 	return 1;
 }
 
 static int
 AnalyzeGlobalVar(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData const *Mod,
+	uint32_t Node
 )
 {
-	if (Node->Flags & ANF_EXTERN && Node->ChildCnt == 2)
+	struct FlatAst const *Ast = &Mod->Ast;
+	if (Ast->Nodes[Node].Flags & ANF_EXTERN && Ast->Nodes[Node].ChildCnt == 2)
 	{
-		LogAstNodeErr(File, Node, "external variables cannot be declared with an initial value!");
+		LogAstNodeErr(Mod, Node, "external variables cannot be declared with an initial value!");
 		return 1;
 	}
 	
-	struct AstNode const *VarType = &Node->Children[0];
-	if (AnalyzeCommonType(Symtab, File, VarType))
+	uint32_t VarType = Ast->Nodes[Node].FirstChild;
+	if (AnalyzeCommonType(Symtab, Mod, VarType))
 		return 1;
 	
-	if (Node->ChildCnt == 2)
+	if (Ast->Nodes[Node].ChildCnt == 2)
 	{
-		struct AstNode const *VarValue = &Node->Children[1];
-		if (AnalyzeConstExpr(Symtab, File, VarValue))
+		uint32_t VarValue = Ast->Nodes[VarType].NextSibling;
+		struct ConstVal Val;
+		if (AnalyzeConstExpr(Symtab, Mod, VarValue, &Val))
+			return 1;
+		if (!Val.Type && AnalyzeGlobalInit(Symtab, Mod, VarValue))
+			return 1;
+		
+		// constants must be representable in the variable's type.
+		struct ConstEval Ce = {.Mod = Mod};
+		struct ConstVal Type, Conv;
+		if (Val.Type && ConstEval_Type(Mod, VarType, &Type) && ConstEval_Assign(&Ce, VarValue, &Val, &Type, &Conv))
 			return 1;
 		
 		// TODO: perform global var initial assignment type analysis.
 	}
 	
-	return 1;
+	return 0;
 }
 
 static int
 AnalyzeProc(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData *Mod,
+	uint32_t Node
 )
 {
-	// TODO: implement procedure semantic analysis.
-	return 1;
+	// bodies of imported procedures are only parsed once needed.
+	if (!ModuleData_ProcBody(Mod, Node))
+		return 1;
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	uint32_t Args = Ast->Nodes[Node].FirstChild;
+	uint32_t RetType = Ast->Nodes[Args].NextSibling;
+	
+	// `Self` is only known once the method is emitted.
+	for (uint32_t Arg = Ast->Nodes[Args].FirstChild; Arg; Arg = Ast->Nodes[Arg].NextSibling)
+	{
+		if (FlatAst_Token(Ast, Arg, 0)->Type == TT_KW_SELF)
+			continue;
+		
+		if (AnalyzeCommonType(Symtab, Mod, Ast->Nodes[Arg].FirstChild))
+			return 1;
+	}
+	
+	if (FlatAst_Token(Ast, Ast->Nodes[RetType].FirstChild, 0)->Type != TT_KW_NULL)
+	{
+		if (AnalyzeCommonType(Symtab, Mod, RetType))
+			return 1;
+	}
+	
+	// TODO: implement statement semantic analysis.
+	return 0;
+}
+
+static void *
+Arena_Alloc(struct Arena *Arena, size_t Size)
+{
+	size_t Pad = 0;
+	if (Arena->Head)
+	{
+		uintptr_t Addr = (uintptr_t)&Arena->Head->Data[Arena->Head->Used];
+		Pad = -Addr & (ARENA_ALIGN - 1);
+	}
+	
+	// start new chunk if current one cannot fit allocation.
+	if (!Arena->Head || Arena->Head->Used + Pad + Size > Arena->Head->Cap)
+	{
+		size_t Cap = Size + ARENA_ALIGN > ARENA_CHUNK_SIZE ? Size + ARENA_ALIGN : ARENA_CHUNK_SIZE;
+		struct ArenaChunk *Chunk = malloc(sizeof(struct ArenaChunk) + Cap);
+		Chunk->Next = Arena->Head;
+		Chunk->Cap = Cap;
+		Chunk->Used = 0;
+		Arena->Head = Chunk;
+		
+		uintptr_t Addr = (uintptr_t)Chunk->Data;
+		Pad = -Addr & (ARENA_ALIGN - 1);
+	}
+	
+	void *Ptr = &Arena->Head->Data[Arena->Head->Used + Pad];
+	Arena->Head->Used += Pad + Size;
+	return Ptr;
 }
 
 static void
-AstNode_AddChild(struct AstNode *Node, struct AstNode const *Child)
+Arena_Destroy(struct Arena *Arena)
 {
-	++Node->ChildCnt;
-	Node->Children = reallocarray(
-		Node->Children,
-		Node->ChildCnt,
-		sizeof(struct AstNode)
-	);
-	Node->Children[Node->ChildCnt - 1] = *Child;
+	struct ArenaChunk *Chunk = Arena->Head;
+	while (Chunk)
+	{
+		struct ArenaChunk *Next = Chunk->Next;
+		free(Chunk);
+		Chunk = Next;
+	}
+	Arena->Head = NULL;
+}
+
+static void *
+Arena_Realloc(struct Arena *Arena, void *Ptr, size_t OldSize, size_t NewSize)
+{
+	// extend in place if `Ptr` is the most recent allocation and fits.
+	struct ArenaChunk *Head = Arena->Head;
+	if (Ptr
+		&& (unsigned char *)Ptr + OldSize == &Head->Data[Head->Used]
+		&& Head->Used - OldSize + NewSize <= Head->Cap)
+	{
+		Head->Used = Head->Used - OldSize + NewSize;
+		return Ptr;
+	}
+	
+	void *NewPtr = Arena_Alloc(Arena, NewSize);
+	if (Ptr)
+		memcpy(NewPtr, Ptr, OldSize < NewSize ? OldSize : NewSize);
+	return NewPtr;
 }
 
 static void
-AstNode_AddToken(struct AstNode *Node, struct Token const *Tok)
+Arena_Reset(struct Arena *Arena)
 {
-	++Node->TokCnt;
-	Node->Toks = reallocarray(
-		Node->Toks,
-		Node->TokCnt,
-		sizeof(struct Token *)
-	);
-	Node->Toks[Node->TokCnt - 1] = Tok;
+	// keep the most recent chunk for reuse, releasing all others.
+	if (!Arena->Head)
+		return;
+	
+	struct ArenaChunk *Chunk = Arena->Head->Next;
+	while (Chunk)
+	{
+		struct ArenaChunk *Next = Chunk->Next;
+		free(Chunk);
+		Chunk = Next;
+	}
+	Arena->Head->Next = NULL;
+	Arena->Head->Used = 0;
 }
 
 static void
-AstNode_Destroy(struct AstNode *Node)
+AstNode_AddChild(
+	struct AstNode *Node,
+	struct AstNode const *Child,
+	struct Arena *Arena
+)
 {
-	for (size_t i = 0; i < Node->ChildCnt; ++i)
-		AstNode_Destroy(&Node->Children[i]);
+	// capacity is implicitly the next power of two, so only grow on those.
+	if (!(Node->ChildCnt & (Node->ChildCnt - 1)))
+	{
+		Node->Children = Arena_Realloc(
+			Arena,
+			Node->Children,
+			Node->ChildCnt * sizeof(struct AstNode),
+			(Node->ChildCnt ? 2 * Node->ChildCnt : 1) * sizeof(struct AstNode)
+		);
+	}
 	
-	// free allocated memory if needed.
+	Node->Children[Node->ChildCnt++] = *Child;
+}
+
+static void
+AstNode_AddToken(
+	struct AstNode *Node,
+	struct Token const *Tok,
+	struct Arena *Arena
+)
+{
+	// capacity is implicitly the next power of two, so only grow on those.
+	if (!(Node->TokCnt & (Node->TokCnt - 1)))
 	{
-		if (Node->Toks)
-			free(Node->Toks);
-		
-		if (Node->Children)
-			free(Node->Children);
+		Node->Toks = Arena_Realloc(
+			Arena,
+			Node->Toks,
+			Node->TokCnt * sizeof(struct Token *),
+			(Node->TokCnt ? 2 * Node->TokCnt : 1) * sizeof(struct Token *)
+		);
 	}
+	
+	Node->Toks[Node->TokCnt++] = Tok;
 }
 
 static void
-AstNode_Print(FILE *Fp, struct AstNode const *Node, unsigned Depth)
+AstNode_Print(FILE *Fp, struct FlatAst const *Ast, uint32_t Node, unsigned Depth)
 {
+	struct FlatAstNode const *Flat = &Ast->Nodes[Node];
+	
 	// print out node.
 	{
 		for (unsigned i = 0; i < Depth; ++i)
@@ -1372,58 +2129,83 @@ AstNode_Print(FILE *Fp, struct AstNode const *Node, unsigned Depth)
 		fprintf(
 			Fp,
 			"%s (%c%c%c%c%c%c)\n",
-			AstNodeTypeNames[Node->Type],
-			Node->Flags & ANF_PUBLIC ? 'P' : '-',
-			Node->Flags & ANF_EXTERN ? 'E' : '-',
-			Node->Flags & ANF_MUT ? 'M' : '-',
-			Node->Flags & ANF_BASE ? 'B' : '-',
-			Node->Flags & ANF_VARIADIC ? 'V' : '-',
-			Node->Flags & ANF_NULLABLE ? 'N' : '-'
+			AstNodeTypeNames[Flat->Type],
+			Flat->Flags & ANF_PUBLIC ? 'P' : '-',
+			Flat->Flags & ANF_EXTERN ? 'E' : '-',
+			Flat->Flags & ANF_MUT ? 'M' : '-',
+			Flat->Flags & ANF_BASE ? 'B' : '-',
+			Flat->Flags & ANF_VARIADIC ? 'V' : '-',
+			Flat->Flags & ANF_NULLABLE ? 'N' : '-'
 		);
 		
-		for (size_t i = 0; i < Node->TokCnt; ++i)
+		for (size_t i = 0; i < Flat->TokCnt; ++i)
 		{
 			for (unsigned j = 0; j < Depth; ++j)
 				fprintf(Fp, "      ");
-			Token_Print(Fp, Node->Toks[i], i);
+			Token_Print(Fp, &Ast->Lex, FlatAst_Token(Ast, Node, i), i);
 		}
 	}
 	
 	// print out children.
 	{
-		for (size_t i = 0; i < Node->ChildCnt; ++i)
-			AstNode_Print(Fp, &Node->Children[i], Depth + 1);
+		for (uint32_t Child = Flat->FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+			AstNode_Print(Fp, Ast, Child, Depth + 1);
 	}
 }
 
 static int
-BuildSymtabGlobals(struct Symtab *Out, struct ModuleDataGroup const *Modules)
+BuildSymtabGlobals(
+	struct Symtab *Out,
+	struct ModuleDataGroup const *Modules,
+	size_t Home,
+	struct Symtab const *Public
+)
 {
-	struct Symtab Symtab = {0};
+	// builds the symtab seen from within module `Home`, which layers its
+	// private declarations over the public ones of every module.
+	
+	struct Symtab Symtab = {.Base = Public};
 	
 	// register symbols.
 	{
-		struct AstNode const *Ast = &Modules->Modules[0].Ast;
-		struct FileData const *File = &Modules->Modules[0].File;
-		for (size_t i = 0; i < Ast->ChildCnt; ++i)
+		struct ModuleData const *Mod = &Modules->Modules[Home];
+		struct FlatAst const *Ast = &Mod->Ast;
+		for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
 		{
-			if (Symtab_RegisterAstNode(&Symtab, File, &Ast->Children[i]))
+			if (Ast->Nodes[Child].Flags & ANF_PUBLIC)
+				continue;
+			
+			if (Symtab_RegisterAstNode(&Symtab, Mod, Child))
 			{
 				Symtab_Destroy(&Symtab);
 				return 1;
 			}
 		}
-		
-		for (size_t i = 1; i < Modules->ModuleCnt; ++i)
+	}
+	
+	*Out = Symtab;
+	return 0;
+}
+
+static int
+BuildSymtabPublic(struct Symtab *Out, struct ModuleDataGroup const *Modules)
+{
+	// builds the symtab of public declarations, which all modules share.
+	
+	struct Symtab Symtab = {0};
+	
+	// register symbols.
+	{
+		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
 		{
-			struct AstNode const *Ast = &Modules->Modules[i].Ast;
-			struct FileData const *File = &Modules->Modules[i].File;
-			for (size_t j = 0; j < Ast->ChildCnt; ++j)
+			struct ModuleData const *Mod = &Modules->Modules[i];
+			struct FlatAst const *Ast = &Mod->Ast;
+			for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
 			{
-				if (!(Ast->Children[j].Flags & ANF_PUBLIC))
+				if (!(Ast->Nodes[Child].Flags & ANF_PUBLIC))
 					continue;
 				
-				if (Symtab_RegisterAstNode(&Symtab, File, &Ast->Children[j]))
+				if (Symtab_RegisterAstNode(&Symtab, Mod, Child))
 				{
 					Symtab_Destroy(&Symtab);
 					return 1;
@@ -1437,126 +2219,583 @@ BuildSymtabGlobals(struct Symtab *Out, struct ModuleDataGroup const *Modules)
 }
 
 static int
-CheckAcyclicity(struct Symtab const *Symtab)
+Cache_Load(
+	struct LexData *OutLex,
+	struct FlatAst *OutAst,
+	struct FileData const *File,
+	uint64_t SrcHash
+)
+{
+	// returns nonzero on a cache miss, which is never reported as an error.
+	
+	char *Path = Cache_Path(SrcHash);
+	int Fd = open(Path, O_RDONLY);
+	free(Path);
+	if (Fd == -1)
+		return 1;
+	
+	int Rc = Image_Read(OutLex, OutAst, NULL, Fd, File, SrcHash);
+	close(Fd);
+	
+	return Rc;
+}
+
+static char *
+Cache_Path(uint64_t SrcHash)
+{
+	// entries are keyed by both source content and compiler, so that
+	// differing compilers can share a cache directory.
+	size_t Len = strlen(Ctx->Conf.CacheDir) + 40;
+	char *Path = malloc(Len);
+	snprintf(
+		Path,
+		Len,
+		"%s/%016" PRIx64 "-%016" PRIx64 ".lcc",
+		Ctx->Conf.CacheDir,
+		SrcHash,
+		Image_Fingerprint() ^ IMAGE_VERSION
+	);
+	return Path;
+}
+
+static void
+Cache_Store(
+	struct LexData const *Lex,
+	struct FlatAst const *Ast,
+	struct FileData const *File,
+	uint64_t SrcHash
+)
+{
+	// failing to store an entry only costs the next compilation time, so it
+	// is not reported.
+	
+	// write to a temporary file which is then renamed into place, so that
+	// concurrent compilations never see partial entries.
+	char *Path = Cache_Path(SrcHash);
+	size_t TmpLen = strlen(Path) + 8;
+	char *TmpPath = malloc(TmpLen);
+	snprintf(TmpPath, TmpLen, "%s.XXXXXX", Path);
+	
+	int Fd = mkstemp(TmpPath);
+	if (Fd != -1)
+		fchmod(Fd, 0644);
+	
+	FILE *Fp = Fd == -1 ? NULL : fdopen(Fd, "wb");
+	if (Fp)
+	{
+		bool Ok = !Image_Write(Fp, Lex, Ast, false, File->Data, SrcHash, File->Len);
+		Ok = !fclose(Fp) && Ok;
+		if (!Ok || rename(TmpPath, Path))
+			unlink(TmpPath);
+	}
+	else if (Fd != -1)
+	{
+		close(Fd);
+		unlink(TmpPath);
+	}
+	
+	// free allocated memory.
+	{
+		free(Path);
+		free(TmpPath);
+	}
+}
+
+static int
+CheckAcyclicity(struct Symtab const *Symtabs, struct ModuleDataGroup const *Modules)
 {
+	// `Symtabs` holds the symtab of each module by module index, followed by
+	// the public one they share. all types are checked together, so each
+	// cycle is reported once.
+	
+	size_t ModuleCnt = Modules->ModuleCnt;
+	struct Symtab const *Public = &Symtabs[ModuleCnt];
 	struct DepGraph Graph = {0};
 	
+	// dependency graph nodes are public types, then private types by module,
+	// each in symtab order.
+	size_t *Firsts = malloc((ModuleCnt + 1) * sizeof(size_t));
+	Firsts[ModuleCnt] = 0;
+	for (size_t i = 0, Cnt = Public->TypeCnt; i < ModuleCnt; ++i)
+	{
+		Firsts[i] = Cnt;
+		Cnt += Symtabs[i].TypeCnt;
+	}
+	
 	// register nodes and edges.
 	{
-		for (size_t i = 0; i < Symtab->TypeCnt; ++i)
+		for (size_t i = 0; i <= ModuleCnt; ++i)
 		{
-			struct DepNode DepNode =
+			struct Symtab const *Symtab = &Symtabs[(i + ModuleCnt) % (ModuleCnt + 1)];
+			for (size_t j = 0; j < Symtab->TypeCnt; ++j)
 			{
-				.Name = strdup(Symtab->Types[i].Name),
-				.DeclNode = Symtab->Types[i].DeclNode,
-				.DeclFile = Symtab->Types[i].DeclFile
-			};
-			DepGraph_AddNode(&Graph, &DepNode);
+				struct DepNode DepNode =
+				{
+					.Name = Symtab->Types[j].Name,
+					.DeclMod = Symtab->Types[j].DeclMod,
+					.DeclNode = Symtab->Types[j].DeclNode
+				};
+				DepGraph_AddNode(&Graph, &DepNode);
+			}
 		}
 		
-		for (size_t i = 0; i < Symtab->TypeCnt; ++i)
+		for (size_t i = 0; i < Graph.NodeCnt; ++i)
 		{
+			struct DepNode const *DepNode = &Graph.Nodes[i];
+			struct FlatAst const *Ast = &DepNode->DeclMod->Ast;
+			
 			// this is only relevant for structs / unions.
-			if (Symtab->Types[i].Type != SET_STRUCT
-				&& Symtab->Types[i].Type != SET_UNION)
-			{
+			unsigned char Type = Ast->Nodes[DepNode->DeclNode].Type;
+			if (Type != ANT_STRUCT && Type != ANT_UNION)
 				continue;
-			}
 			
-			struct DepNode const *DepNode = &Graph.Nodes[i];
-			struct AstNode const *AstNode = DepNode->DeclNode;
+			// member types are looked up as the declaring module sees them.
+			size_t ModInd = DepNode->DeclMod - Modules->Modules;
+			struct Symtab const *Symtab = &Symtabs[ModInd];
 			
-			for (size_t j = 0; j < AstNode->ChildCnt; ++j)
+			for (uint32_t Memb = Ast->Nodes[DepNode->DeclNode].FirstChild; Memb; Memb = Ast->Nodes[Memb].NextSibling)
 			{
-				struct AstNode const *Memb = &AstNode->Children[j];
-				struct AstNode const *Base = GetSizeBaseType(&Memb->Children[0]);
-				if (!Base || Base->Type != ANT_TYPE_ATOM)
+				uint32_t Base = GetSizeBaseType(Ast, Ast->Nodes[Memb].FirstChild);
+				if (!Base || Ast->Nodes[Base].Type != ANT_TYPE_ATOM)
 					continue;
 				
-				char const *BaseName = Base->Toks[0]->Data.Str.Text;
+				char const *BaseName = FlatAst_TokenText(Ast, Base, 0);
 				if (!BaseName)
 					continue;
 				
-				struct DepNode const *BaseDep = DepGraph_SearchNode(&Graph, BaseName);
-				if (BaseDep)
-					DepGraph_Connect(&Graph, DepNode, BaseDep);
+				struct SymtabEntry const *BaseEnt = Symtab_SearchTypes(Symtab, BaseName);
+				if (!BaseEnt)
+					continue;
+				
+				if (BaseEnt >= Symtab->Types && BaseEnt < Symtab->Types + Symtab->TypeCnt)
+					DepGraph_Connect(&Graph, i, Firsts[ModInd] + (BaseEnt - Symtab->Types));
+				else
+					DepGraph_Connect(&Graph, i, BaseEnt - Public->Types);
 			}
 		}
+		
+		DepGraph_Build(&Graph);
 	}
 	
-	// check for edge cycles between nodes.
+	// a type is cyclical if its strongly connected component has more than
+	// one node or it directly contains itself.
+	int Rc = 0;
 	{
+		uint32_t *Comps = malloc(Graph.NodeCnt * sizeof(uint32_t));
+		size_t CompCnt = DepGraph_FindComponents(&Graph, Comps);
+		
+		// chain component members together in declaration order.
+		uint32_t *Heads = malloc(CompCnt * sizeof(uint32_t));
+		uint32_t *Next = malloc(Graph.NodeCnt * sizeof(uint32_t));
+		memset(Heads, 0xff, CompCnt * sizeof(uint32_t));
+		for (size_t i = Graph.NodeCnt; i-- > 0;)
+		{
+			Next[i] = Heads[Comps[i]];
+			Heads[Comps[i]] = i;
+		}
+		
+		// report every cyclical group at its first declared type.
 		for (size_t i = 0; i < Graph.NodeCnt; ++i)
 		{
+			if (Heads[Comps[i]] != i)
+				continue;
+			
+			if (Next[i] == UINT32_MAX && !DepGraph_SearchEdge(&Graph, i, i))
+				continue;
+			
 			struct DepNode const *Node = &Graph.Nodes[i];
+			LogAstNodeErr(Node->DeclMod, Node->DeclNode, "type contains cyclical definition!");
 			
-			DepGraph_ResetVisited(&Graph);
-			struct DepNode const *Cycle = DepGraph_FindCycle(&Graph, Node, &Graph.Nodes[i]);
-			if (Cycle)
+			uint32_t Cycle = Next[i] == UINT32_MAX ? i : Next[i];
+			for (; Cycle != UINT32_MAX; Cycle = Next[Cycle])
 			{
-				LogAstNodeErr(Node->DeclFile, Node->DeclNode, "type contains cyclical definition!");
-				LogAstNodeContext(Cycle->DeclFile, Cycle->DeclNode, "by virtue of containing this type:");
-				DepGraph_Destroy(&Graph);
-				return 1;
+				struct DepNode const *CycleNode = &Graph.Nodes[Cycle];
+				LogAstNodeContext(CycleNode->DeclMod, CycleNode->DeclNode, "by virtue of containing this type:");
+				if (Cycle == i)
+					break;
 			}
+			
+			Rc = 1;
 		}
+		
+		free(Next);
+		free(Heads);
+		free(Comps);
 	}
 	
 	DepGraph_Destroy(&Graph);
-	return 0;
+	free(Firsts);
+	return Rc;
 }
 
+#ifndef LITHIC_LIB
 static int
-Conf_Read(int Argc, char const *Argv[])
+Client_Run(char const *Path, int Argc, char const *Argv[])
 {
-	atexit(Conf_Quit);
-	
-	struct option Opts[] =
-	{
-		{"ast", no_argument, NULL, 'a'},
-		{"conf", required_argument, NULL, 'c'},
-		{"help", no_argument, NULL, 'h'},
-		{"lex", no_argument, NULL, 'l'},
-		{"modpath", required_argument, NULL, 'm'},
-		{"out", required_argument, NULL, 'o'},
-		{"time", no_argument, NULL, 't'},
-		{0}
-	};
-	
-	// get option arguments.
-	int c, LongInd;
-	while ((c = getopt_long(Argc, (char *const *)Argv, "c:hm:o:", Opts, &LongInd)) != -1)
+	// forward the working directory and every argument but the client option
+	// itself, all null-terminated, with stdout and stderr attached.
+	char *Req;
+	size_t ReqLen;
+	DynStr_Init(&Req, &ReqLen);
 	{
-		switch (c)
+		char *Cwd = getcwd(NULL, 0);
+		if (!Cwd)
 		{
-		case 'a':
-			Conf.Flags |= CF_DUMP_AST;
-			break;
+			LogErr("failed to get working directory!");
+			free(Req);
+			return 1;
+		}
+		
+		DynStr_AppendBuf(&Req, &ReqLen, Cwd, strlen(Cwd) + 1);
+		free(Cwd);
+		
+		for (int i = 0; i < Argc; ++i)
+		{
+			if (i != 1 && i != 2)
+				DynStr_AppendBuf(&Req, &ReqLen, Argv[i], strlen(Argv[i]) + 1);
+		}
+	}
+	
+	struct sockaddr_un Addr = {.sun_family = AF_UNIX};
+	if (strlen(Path) >= sizeof(Addr.sun_path))
+	{
+		LogErr("socket path is too long - '%s'!", Path);
+		free(Req);
+		return 1;
+	}
+	strcpy(Addr.sun_path, Path);
+	
+	int Sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (Sock == -1 || connect(Sock, (struct sockaddr *)&Addr, sizeof(Addr)))
+	{
+		LogErr("failed to connect to compiler server - '%s'!", Path);
+		if (Sock != -1)
+			close(Sock);
+		free(Req);
+		return 1;
+	}
+	
+	// send request and wait for the exit code of its compilation.
+	int32_t Rc;
+	{
+		uint32_t Len = ReqLen;
+		int Fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+		
+		struct iovec Iov = {.iov_base = &Len, .iov_len = sizeof(Len)};
+		union
+		{
+			struct cmsghdr Hdr;
+			char Buf[CMSG_SPACE(sizeof(Fds))];
+		} Ctl = {0};
+		struct msghdr Msg =
+		{
+			.msg_iov = &Iov,
+			.msg_iovlen = 1,
+			.msg_control = Ctl.Buf,
+			.msg_controllen = sizeof(Ctl.Buf)
+		};
+		
+		struct cmsghdr *Cmsg = CMSG_FIRSTHDR(&Msg);
+		Cmsg->cmsg_level = SOL_SOCKET;
+		Cmsg->cmsg_type = SCM_RIGHTS;
+		Cmsg->cmsg_len = CMSG_LEN(sizeof(Fds));
+		memcpy(CMSG_DATA(Cmsg), Fds, sizeof(Fds));
+		
+		if (sendmsg(Sock, &Msg, 0) != sizeof(Len)
+			|| WriteFull(Sock, Req, ReqLen)
+			|| ReadFull(Sock, &Rc, sizeof(Rc)))
+		{
+			LogErr("lost connection to compiler server - '%s'!", Path);
+			Rc = 1;
+		}
+	}
+	
+	close(Sock);
+	free(Req);
+	
+	return Rc;
+}
+
+static int
+Compile(int Argc, char const *Argv[])
+{
+	// read configuration.
+	{
+		Ctx->TimeData.ConfReadBegin = GetTimeNs();
+		int Rc = Conf_Read(Argc, Argv);
+		if (Rc)
+			return Rc < 0 ? 0 : 1;
+		Ctx->TimeData.ConfReadEnd = GetTimeNs();
+	}
+	
+	// read input file.
+	struct FileData FileData = {0};
+	{
+		Ctx->TimeData.FileReadBegin = GetTimeNs();
+		if (FileData_Read(&FileData, Ctx->Conf.InFp, Ctx->Conf.InFile))
+			return 1;
+		Ctx->TimeData.FileReadEnd = GetTimeNs();
+		
+		TimeData_AddEvent("read", FileData.Name, Ctx->TimeData.FileReadBegin, Ctx->TimeData.FileReadEnd, 0);
+	}
+	
+	return CompileModule(&FileData);
+}
+#endif
+
+static int
+CompileModule(struct FileData *FileData)
+{
+	// takes ownership of `FileData`.
+	
+	// lex input file.
+	struct LexData LexData = {0};
+	{
+		Ctx->TimeData.LexBegin = GetTimeNs();
+		if (Lex(&LexData, FileData))
+		{
+			FileData_Destroy(FileData);
+			return 1;
+		}
+		Ctx->TimeData.LexEnd = GetTimeNs();
+		
+		TimeData_AddEvent("lex", FileData->Name, Ctx->TimeData.LexBegin, Ctx->TimeData.LexEnd, 0);
+		
+		if (Ctx->Conf.Flags & CF_DUMP_TOKS)
+		{
+			for (size_t i = 0; i < LexData.TokCnt; ++i)
+				Token_Print(Ctx->Conf.OutFp, &LexData, &LexData.Toks[i], i);
+			
+			LexData_Destroy(&LexData);
+			FileData_Destroy(FileData);
+			return 0;
+		}
+	}
+	
+	// parse input file.
+	struct FlatAst Ast = {0};
+	{
+		Ctx->TimeData.ParseBegin = GetTimeNs();
+		if (Parse(&Ast, FileData, &LexData, false))
+		{
+			LexData_Destroy(&LexData);
+			FileData_Destroy(FileData);
+			return 1;
+		}
+		Ctx->TimeData.ParseEnd = GetTimeNs();
+		
+		TimeData_AddEvent("parse", FileData->Name, Ctx->TimeData.ParseBegin, Ctx->TimeData.ParseEnd, 0);
+		
+		if (Ctx->Conf.Flags & CF_DUMP_AST)
+		{
+			AstNode_Print(Ctx->Conf.OutFp, &Ast, 0, 0);
+			
+			FlatAst_Destroy(&Ast);
+			LexData_Destroy(&LexData);
+			FileData_Destroy(FileData);
+			return 0;
+		}
+		
+		if (Ctx->Conf.Flags & CF_EMIT_INTERFACE)
+		{
+			int Rc = Interface_Write(Ctx->Conf.OutFp, FileData, &Ast);
+			
+			FlatAst_Destroy(&Ast);
+			LexData_Destroy(&LexData);
+			FileData_Destroy(FileData);
+			return Rc;
+		}
+	}
+	
+	struct ModuleData ModuleData =
+	{
+		.File = *FileData,
+		.Lex = LexData,
+		.Ast = Ast,
+		.FullPath = FullPathname(FileData->Name)
+	};
+	
+	struct ModuleDataGroup ModuleDataGroup = {0};
+	ModuleDataGroup_Append(&ModuleDataGroup, &ModuleData);
+	
+	// extract and read imports.
+	{
+		Ctx->TimeData.ExtractImportsBegin = GetTimeNs();
+		if (ExtractImports(&ModuleDataGroup))
+		{
+			ModuleDataGroup_Destroy(&ModuleDataGroup);
+			return 1;
+		}
+		Ctx->TimeData.ExtractImportsEnd = GetTimeNs();
+	}
+	
+	// build symtab globals. public declarations are registered once, in a
+	// symtab following those of the modules, which each add their private
+	// declarations on top.
+	size_t ModuleCnt = ModuleDataGroup.ModuleCnt;
+	struct Symtab *Symtabs = calloc(ModuleCnt + 1, sizeof(struct Symtab));
+	{
+		Ctx->TimeData.BuildSymtabGlobalsBegin = GetTimeNs();
+		if (BuildSymtabPublic(&Symtabs[ModuleCnt], &ModuleDataGroup))
+		{
+			Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+			ModuleDataGroup_Destroy(&ModuleDataGroup);
+			return 1;
+		}
+		
+		for (size_t i = 0; i < ModuleCnt; ++i)
+		{
+			if (BuildSymtabGlobals(&Symtabs[i], &ModuleDataGroup, i, &Symtabs[ModuleCnt]))
+			{
+				Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+				ModuleDataGroup_Destroy(&ModuleDataGroup);
+				return 1;
+			}
+			ModuleDataGroup.Modules[i].Symtab = &Symtabs[i];
+		}
+		Ctx->TimeData.BuildSymtabGlobalsEnd = GetTimeNs();
+	}
+	
+	// find declarations of imported modules in use, unless each module is
+	// emitted whole for separate compilation. the symtabs are then cut down to
+	// those, so that later stages only see reachable declarations.
+	if (!Ctx->Conf.OutDir)
+	{
+		Ctx->TimeData.FindReachableBegin = GetTimeNs();
+		if (FindReachable(Symtabs, &ModuleDataGroup))
+		{
+			Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+			ModuleDataGroup_Destroy(&ModuleDataGroup);
+			return 1;
+		}
+		
+		for (size_t i = 0; i <= ModuleCnt; ++i)
+			Symtab_Prune(&Symtabs[i]);
+		Ctx->TimeData.FindReachableEnd = GetTimeNs();
+	}
+	
+	// check acyclicity of language elements where necessary.
+	{
+		Ctx->TimeData.CheckAcyclicityBegin = GetTimeNs();
+		if (CheckAcyclicity(Symtabs, &ModuleDataGroup))
+		{
+			Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+			ModuleDataGroup_Destroy(&ModuleDataGroup);
+			return 1;
+		}
+		Ctx->TimeData.CheckAcyclicityEnd = GetTimeNs();
+	}
+	
+	// analyze modules.
+	{
+		Ctx->TimeData.AnalyzeBegin = GetTimeNs();
+		if (Analyze(Symtabs, &ModuleDataGroup))
+		{
+			Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+			ModuleDataGroup_Destroy(&ModuleDataGroup);
+			return 1;
+		}
+		Ctx->TimeData.AnalyzeEnd = GetTimeNs();
+	}
+	
+	// emit C code.
+	{
+		Ctx->TimeData.EmitBegin = GetTimeNs();
+		if (Emit(Symtabs, &ModuleDataGroup))
+		{
+			Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+			ModuleDataGroup_Destroy(&ModuleDataGroup);
+			return 1;
+		}
+		Ctx->TimeData.EmitEnd = GetTimeNs();
+	}
+	
+	Symtab_DestroyAll(Symtabs, ModuleCnt + 1);
+	ModuleDataGroup_Destroy(&ModuleDataGroup);
+	return 0;
+}
+
+#ifndef LITHIC_LIB
+static int
+Conf_Read(int Argc, char const *Argv[])
+{
+	// returns -1 if there is nothing left to do.
+	
+	struct option Opts[] =
+	{
+		{"ast", no_argument, NULL, 'a'},
+		{"cache-dir", required_argument, NULL, 'C'},
+		{"conf", required_argument, NULL, 'c'},
+		{"emit-interface", no_argument, NULL, 'I'},
+		{"help", no_argument, NULL, 'h'},
+		{"jobs", required_argument, NULL, 'j'},
+		{"lex", no_argument, NULL, 'l'},
+		{"modpath", required_argument, NULL, 'm'},
+		{"out", required_argument, NULL, 'o'},
+		{"out-dir", required_argument, NULL, 'O'},
+		{"time", no_argument, NULL, 't'},
+		{"time-format", required_argument, NULL, 'T'},
+		{"unity", no_argument, NULL, 'u'},
+		{0}
+	};
+	
+	// get option arguments, resetting state left by previous server requests.
+	optind = 0;
+	int c, LongInd;
+	while ((c = getopt_long(Argc, (char *const *)Argv, "c:hj:m:o:", Opts, &LongInd)) != -1)
+	{
+		switch (c)
+		{
+		case 'a':
+			Ctx->Conf.Flags |= CF_DUMP_AST;
+			break;
+		case 'C':
+			if (mkdir(optarg, 0755) && errno != EEXIST)
+			{
+				LogErr("failed to create cache directory - '%s'!", optarg);
+				return 1;
+			}
+			Ctx->Conf.CacheDir = optarg;
+			break;
 		case 'c':
-			if (!strcmp(optarg, "no-float"))
-				Conf.Flags |= CF_NO_FLOAT;
-			else
+			if (Lithic_SetConfFlag(Ctx, optarg))
 			{
 				LogErr("unrecognized option - '%s'!", optarg);
 				return 1;
 			}
 			break;
+		case 'I':
+			Ctx->Conf.Flags |= CF_EMIT_INTERFACE;
+			break;
 		case 'h':
 			Usage(Argv[0]);
-			exit(0);
+			return -1;
+		case 'j':
+		{
+			char *End;
+			unsigned long JobCnt = strtoul(optarg, &End, 10);
+			if (*End || JobCnt == 0 || JobCnt > UINT16_MAX)
+			{
+				LogErr("invalid job count - '%s'!", optarg);
+				return 1;
+			}
+			
+			Ctx->Conf.JobCnt = JobCnt;
+			break;
+		}
 		case 'l':
-			Conf.Flags |= CF_DUMP_TOKS;
+			Ctx->Conf.Flags |= CF_DUMP_TOKS;
 			break;
 		case 'm':
 		{
-			if (Conf.ModulePathCnt >= MAX_MODULE_PATHS)
+			if (Ctx->Conf.ModulePathCnt >= MAX_MODULE_PATHS)
 			{
 				LogErr("cannot add more than %d module search paths!", MAX_MODULE_PATHS);
 				return 1;
 			}
 			
-			Conf.ModulePaths[Conf.ModulePathCnt] = optarg;
-			++Conf.ModulePathCnt;
+			Ctx->Conf.ModulePaths[Ctx->Conf.ModulePathCnt] = optarg;
+			++Ctx->Conf.ModulePathCnt;
 			
 			DIR *Dp = opendir(optarg);
 			if (!Dp)
@@ -1568,16 +2807,24 @@ Conf_Read(int Argc, char const *Argv[])
 			
 			break;
 		}
+		case 'O':
+			if (mkdir(optarg, 0755) && errno != EEXIST)
+			{
+				LogErr("failed to create output directory - '%s'!", optarg);
+				return 1;
+			}
+			Ctx->Conf.OutDir = optarg;
+			break;
 		case 'o':
-			if (Conf.OutFp)
+			if (Ctx->Conf.OutFp)
 			{
 				LogErr("cannot specify multiple output files!");
 				return 1;
 			}
 			
-			Conf.OutFile = optarg;
-			Conf.OutFp = OpenFile(optarg, "wb");
-			if (!Conf.OutFp)
+			Ctx->Conf.OutFile = optarg;
+			Ctx->Conf.OutFp = OpenFile(optarg, "wb");
+			if (!Ctx->Conf.OutFp)
 			{
 				LogErr("failed to open output file for writing - '%s'!", optarg);
 				return 1;
@@ -1585,7 +2832,25 @@ Conf_Read(int Argc, char const *Argv[])
 			
 			break;
 		case 't':
-			Conf.Flags |= CF_TIME;
+			Ctx->Conf.Flags |= CF_TIME;
+			break;
+		case 'T':
+			if (!strcmp(optarg, "text"))
+				Ctx->Conf.TimeFormat = TF_TEXT;
+			else if (!strcmp(optarg, "json"))
+				Ctx->Conf.TimeFormat = TF_JSON;
+			else if (!strcmp(optarg, "trace"))
+				Ctx->Conf.TimeFormat = TF_TRACE;
+			else
+			{
+				LogErr("unrecognized time format - '%s'!", optarg);
+				return 1;
+			}
+			
+			Ctx->Conf.Flags |= CF_TIME;
+			break;
+		case 'u':
+			Ctx->Conf.Flags |= CF_UNITY;
 			break;
 		default:
 			Usage(Argv[0]);
@@ -1601,21 +2866,34 @@ Conf_Read(int Argc, char const *Argv[])
 			return 1;
 		}
 		
-		Conf.InFile = Argv[Argc - 1];
-		Conf.InFp = OpenFile(Argv[Argc - 1], "rb");
-		if (!Conf.InFp)
+		Ctx->Conf.InFile = Argv[Argc - 1];
+		Ctx->Conf.InFp = OpenFile(Argv[Argc - 1], "rb");
+		if (!Ctx->Conf.InFp)
 		{
 			LogErr("failed to open input file for reading - '%s'!", Argv[Argc - 1]);
 			return 1;
 		}
 	}
 	
+	// a unity build is a single file by definition.
+	if (Ctx->Conf.Flags & CF_UNITY && Ctx->Conf.OutDir)
+	{
+		LogErr("unity output cannot be split into an output directory!");
+		return 1;
+	}
+	
 	// set unset default configuration.
 	{
-		if (!Conf.OutFp)
+		if (!Ctx->Conf.OutFp)
+		{
+			Ctx->Conf.OutFile = "stdout";
+			Ctx->Conf.OutFp = stdout;
+		}
+		
+		if (!Ctx->Conf.JobCnt)
 		{
-			Conf.OutFile = "stdout";
-			Conf.OutFp = stdout;
+			long CpuCnt = sysconf(_SC_NPROCESSORS_ONLN);
+			Ctx->Conf.JobCnt = CpuCnt > 0 ? CpuCnt : 1;
 		}
 	}
 	
@@ -1627,472 +2905,5984 @@ Conf_Quit(void)
 {
 	// close opened files.
 	{
-		if (Conf.OutFp)
-			fclose(Conf.OutFp);
+		if (Ctx->Conf.OutFp && Ctx->Conf.OutFp != stdout)
+			fclose(Ctx->Conf.OutFp);
 		
-		if (Conf.InFp)
-			fclose(Conf.InFp);
+		if (Ctx->Conf.InFp)
+			fclose(Ctx->Conf.InFp);
+		
+		Ctx->Conf.OutFp = NULL;
+		Ctx->Conf.InFp = NULL;
 	}
 }
+#endif
 
 static int
-ConvEscSequence(
-	char const *Src,
-	size_t SrcLen,
-	size_t *i,
-	char **Str,
-	size_t *Len
+ConstEval_Assign(
+	struct ConstEval const *Ce,
+	uint32_t Node,
+	struct ConstVal const *Val,
+	struct ConstVal const *To,
+	struct ConstVal *Out
 )
 {
-	if (!strncmp(&Src[*i], "\\n", 2))
-	{
-		DynStr_AppendChar(Str, Len, '\n');
-		*i += 2;
-	}
-	else if (!strncmp(&Src[*i], "\\r", 2))
+	// implicit conversions of integers must also keep their value, which
+	// casts are free to change.
+	
+	if (ConstEval_Convert(Ce, Node, Val, To, Out))
+		return 1;
+	
+	if (Val->Type == CVT_INT && To->Type == CVT_INT
+		&& (Out->Int != Val->Int || (Out->Signed != Val->Signed && (int64_t)Val->Int < 0)))
 	{
-		DynStr_AppendChar(Str, Len, '\r');
-		*i += 2;
+		LogAstNodeErr(Ce->Mod, Node, "constant is out of range of its type!");
+		return 1;
 	}
-	else if (!strncmp(&Src[*i], "\\t", 2))
+	
+	return 0;
+}
+
+static int
+ConstEval_Atom(struct ConstEval const *Ce, uint32_t Node, struct ConstVal *Out)
+{
+	struct FlatAst const *Ast = &Ce->Mod->Ast;
+	struct Token const *Tok = FlatAst_Token(Ast, Node, 0);
+	
+	switch (Tok->Type)
 	{
-		DynStr_AppendChar(Str, Len, '\t');
-		*i += 2;
-	}
-	else if (!strncmp(&Src[*i], "\\\\", 2))
+	case TT_LIT_INT:
 	{
-		DynStr_AppendChar(Str, Len, '\\');
-		*i += 2;
+		// literals take the type of their emitted form.
+		uint64_t Val = Ast->Lex.Nums[Tok->Payload].Int;
+		*Out = (struct ConstVal){.Type = CVT_INT, .SizeMod = SM_32, .Signed = Val <= INT32_MAX, .Int = Val};
+		if (Tok->SizeMod == SM_64)
+		{
+			Out->SizeMod = SM_64;
+			Out->Signed = Val <= INT64_MAX;
+		}
+		else if (Tok->SizeMod == SM_SIZE)
+		{
+			Out->SizeMod = SM_SIZE;
+			Out->Signed = false;
+		}
+		
+		return 0;
 	}
-	else if (!strncmp(&Src[*i], "\\'", 2))
+	case TT_LIT_FLOAT:
 	{
-		DynStr_AppendChar(Str, Len, '\'');
-		*i += 2;
+		double Val = Ast->Lex.Nums[Tok->Payload].Float;
+		*Out = (struct ConstVal)
+		{
+			.Type = CVT_FLOAT,
+			.SizeMod = Tok->SizeMod,
+			.Float = Tok->SizeMod == SM_32 ? (float)Val : Val
+		};
+		return 0;
 	}
-	else if (!strncmp(&Src[*i], "\\\"", 2))
+	case TT_LIT_BOOL:
+		*Out = (struct ConstVal){.Type = CVT_BOOL, .Int = Tok->Payload != 0};
+		return 0;
+	case TT_IDENT:
+	{
+		char const *Name = LexData_Text(&Ast->Lex, Tok);
+		if (Ce->Es && EmitFindLocal(Ce->Es, Name))
+			return 0;
+		
+		struct SymtabEntry const *Ent = Symtab_SearchValues(Ce->Mod->Symtab, Name, NULL);
+		if (!Ent || Ent->Type != SET_VAR)
+			return 0;
+		
+		return ConstEval_Var(Ce, Ent, Out);
+	}
+	default:
+		return 0;
+	}
+}
+
+static int
+ConstEval_Binary(
+	struct ConstEval const *Ce,
+	uint32_t Node,
+	unsigned char Op,
+	struct ConstVal const *Lhs,
+	struct ConstVal const *Rhs,
+	struct ConstVal *Out
+)
+{
+	// operations follow C, which would otherwise perform them. those C leaves
+	// undefined are rejected.
+	
+	*Out = (struct ConstVal){0};
+	if (Op == ANT_EXPR_LOG_XOR)
+	{
+		*Out = (struct ConstVal){.Type = CVT_BOOL, .Int = ConstVal_Truth(Lhs) != ConstVal_Truth(Rhs)};
+		return 0;
+	}
+	
+	// shifts promote their operands separately, taking the left one's type.
+	if (Op == ANT_EXPR_SHL || Op == ANT_EXPR_SHR)
+	{
+		if (Lhs->Type == CVT_FLOAT || Rhs->Type == CVT_FLOAT)
+			return 0;
+		
+		struct ConstVal Val = *Lhs, Cnt = *Rhs;
+		ConstVal_Promote(&Val);
+		ConstVal_Promote(&Cnt);
+		
+		unsigned Bits = SizeModBits(Val.SizeMod);
+		if ((Cnt.Signed && (int64_t)Cnt.Int < 0) || Cnt.Int >= Bits)
+		{
+			LogAstNodeErr(Ce->Mod, Node, "shift amount out of range in constant expression!");
+			return 1;
+		}
+		
+		if (Op == ANT_EXPR_SHR)
+			Val.Int = Val.Signed ? (uint64_t)((int64_t)Val.Int >> Cnt.Int) : Val.Int >> Cnt.Int;
+		else
+		{
+			int64_t Max = Bits == 64 ? INT64_MAX : INT32_MAX;
+			if (Val.Signed && ((int64_t)Val.Int < 0 || (int64_t)Val.Int > Max >> Cnt.Int))
+			{
+				LogAstNodeErr(Ce->Mod, Node, "integer overflow in constant expression!");
+				return 1;
+			}
+			Val.Int <<= Cnt.Int;
+		}
+		
+		ConstVal_Wrap(&Val);
+		*Out = Val;
+		return 0;
+	}
+	
+	struct ConstVal Type, a, b;
+	ConstEval_Common(Lhs, Rhs, &Type);
+	if (ConstEval_Convert(Ce, Node, Lhs, &Type, &a) || ConstEval_Convert(Ce, Node, Rhs, &Type, &b))
+		return 1;
+	
+	int Cmp;
+	if (Type.Type == CVT_FLOAT)
+		Cmp = (a.Float > b.Float) - (a.Float < b.Float);
+	else if (Type.Signed)
+		Cmp = ((int64_t)a.Int > (int64_t)b.Int) - ((int64_t)a.Int < (int64_t)b.Int);
+	else
+		Cmp = (a.Int > b.Int) - (a.Int < b.Int);
+	
+	*Out = (struct ConstVal){.Type = CVT_BOOL};
+	switch (Op)
+	{
+	case ANT_EXPR_GREATER:
+		Out->Int = Cmp > 0;
+		return 0;
+	case ANT_EXPR_GREQUAL:
+		Out->Int = Cmp >= 0;
+		return 0;
+	case ANT_EXPR_LESS:
+		Out->Int = Cmp < 0;
+		return 0;
+	case ANT_EXPR_LEQUAL:
+		Out->Int = Cmp <= 0;
+		return 0;
+	case ANT_EXPR_EQUAL:
+		Out->Int = Cmp == 0;
+		return 0;
+	case ANT_EXPR_NEQUAL:
+		Out->Int = Cmp != 0;
+		return 0;
+	default:
+		break;
+	}
+	
+	// infinities and NaNs have no literal, so are left to run time.
+	*Out = Type;
+	if (Type.Type == CVT_FLOAT)
+	{
+		switch (Op)
+		{
+		case ANT_EXPR_MUL:
+			Out->Float = a.Float * b.Float;
+			break;
+		case ANT_EXPR_DIV:
+			Out->Float = a.Float / b.Float;
+			break;
+		case ANT_EXPR_ADD:
+			Out->Float = a.Float + b.Float;
+			break;
+		case ANT_EXPR_SUB:
+			Out->Float = a.Float - b.Float;
+			break;
+		default:
+			Out->Type = CVT_NONE;
+			return 0;
+		}
+		
+		if (Type.SizeMod == SM_32)
+			Out->Float = (float)Out->Float;
+		if (!isfinite(Out->Float))
+			Out->Type = CVT_NONE;
+		
+		return 0;
+	}
+	
+	unsigned Bits = SizeModBits(Type.SizeMod);
+	bool Overflow = false;
+	switch (Op)
+	{
+	case ANT_EXPR_MUL:
+	case ANT_EXPR_ADD:
+	case ANT_EXPR_SUB:
+		if (Type.Signed)
+		{
+			int64_t Res;
+			Overflow = ConstVal_SignedArith(Op, (int64_t)a.Int, (int64_t)b.Int, Bits, &Res);
+			Out->Int = Res;
+		}
+		else if (Op == ANT_EXPR_MUL)
+			Out->Int = a.Int * b.Int;
+		else
+			Out->Int = Op == ANT_EXPR_ADD ? a.Int + b.Int : a.Int - b.Int;
+		break;
+	case ANT_EXPR_DIV:
+	case ANT_EXPR_MOD:
+		if (!b.Int)
+		{
+			LogAstNodeErr(Ce->Mod, Node, "division by zero in constant expression!");
+			return 1;
+		}
+		
+		if (Type.Signed)
+		{
+			int64_t x = a.Int, y = b.Int;
+			if (y == -1 && x == (Bits == 64 ? INT64_MIN : INT32_MIN))
+				Overflow = true;
+			else
+				Out->Int = Op == ANT_EXPR_DIV ? x / y : x % y;
+		}
+		else
+			Out->Int = Op == ANT_EXPR_DIV ? a.Int / b.Int : a.Int % b.Int;
+		break;
+	case ANT_EXPR_BIT_AND:
+		Out->Int = a.Int & b.Int;
+		break;
+	case ANT_EXPR_BIT_XOR:
+		Out->Int = a.Int ^ b.Int;
+		break;
+	case ANT_EXPR_BIT_OR:
+		Out->Int = a.Int | b.Int;
+		break;
+	default:
+		Out->Type = CVT_NONE;
+		return 0;
+	}
+	
+	if (Overflow)
+	{
+		LogAstNodeErr(Ce->Mod, Node, "integer overflow in constant expression!");
+		return 1;
+	}
+	
+	ConstVal_Wrap(Out);
+	return 0;
+}
+
+static void
+ConstEval_Common(struct ConstVal const *Lhs, struct ConstVal const *Rhs, struct ConstVal *Out)
+{
+	// finds the type C converts both operands of an arithmetic operator to.
+	
+	*Out = (struct ConstVal){.Type = CVT_FLOAT, .SizeMod = SM_32};
+	if (Lhs->Type == CVT_FLOAT || Rhs->Type == CVT_FLOAT)
+	{
+		if ((Lhs->Type == CVT_FLOAT && Lhs->SizeMod == SM_64) || (Rhs->Type == CVT_FLOAT && Rhs->SizeMod == SM_64))
+			Out->SizeMod = SM_64;
+		return;
+	}
+	
+	struct ConstVal a = *Lhs, b = *Rhs;
+	ConstVal_Promote(&a);
+	ConstVal_Promote(&b);
+	
+	// an unsigned operand wins unless the signed one is wider.
+	unsigned BitsA = SizeModBits(a.SizeMod), BitsB = SizeModBits(b.SizeMod);
+	struct ConstVal const *Win;
+	if (a.Signed == b.Signed)
+		Win = BitsB > BitsA ? &b : &a;
+	else if (a.Signed)
+		Win = BitsA > BitsB ? &a : &b;
+	else
+		Win = BitsB > BitsA ? &b : &a;
+	
+	*Out = (struct ConstVal){.Type = CVT_INT, .SizeMod = Win->SizeMod, .Signed = Win->Signed};
+}
+
+static int
+ConstEval_Convert(
+	struct ConstEval const *Ce,
+	uint32_t Node,
+	struct ConstVal const *Val,
+	struct ConstVal const *To,
+	struct ConstVal *Out
+)
+{
+	// converts to the type of `To` as C would, rejecting values which do not
+	// fit where C leaves that undefined.
+	
+	struct ConstVal Res = *To;
+	Res.Int = 0;
+	Res.Float = 0.0;
+	
+	switch (To->Type)
+	{
+	case CVT_BOOL:
+		Res.Int = ConstVal_Truth(Val);
+		break;
+	case CVT_FLOAT:
+		if (Val->Type == CVT_FLOAT)
+			Res.Float = To->SizeMod == SM_32 ? (float)Val->Float : Val->Float;
+		else if (Val->Type == CVT_INT && Val->Signed)
+			Res.Float = To->SizeMod == SM_32 ? (float)(int64_t)Val->Int : (double)(int64_t)Val->Int;
+		else
+			Res.Float = To->SizeMod == SM_32 ? (float)Val->Int : (double)Val->Int;
+		
+		if (!isfinite(Res.Float))
+		{
+			LogAstNodeErr(Ce->Mod, Node, "constant is out of range of its type!");
+			return 1;
+		}
+		break;
+	default:
+	{
+		if (Val->Type != CVT_FLOAT)
+		{
+			Res.Int = Val->Int;
+			ConstVal_Wrap(&Res);
+			break;
+		}
+		
+		// floats are truncated, and the result must fit.
+		unsigned Bits = SizeModBits(To->SizeMod);
+		double Ub = To->Signed ? (double)((uint64_t)1 << (Bits - 1)) : 2.0 * (double)((uint64_t)1 << (Bits - 1));
+		double Lb = To->Signed ? -Ub : 0.0;
+		if (!((Val->Float > Lb - 1.0 || Val->Float == Lb) && Val->Float < Ub))
+		{
+			LogAstNodeErr(Ce->Mod, Node, "constant is out of range of its type!");
+			return 1;
+		}
+		
+		Res.Int = To->Signed ? (uint64_t)(int64_t)Val->Float : (uint64_t)Val->Float;
+		ConstVal_Wrap(&Res);
+		break;
+	}
+	}
+	
+	*Out = Res;
+	return 0;
+}
+
+static int
+ConstEval_Expr(struct ConstEval const *Ce, uint32_t Node, struct ConstVal *Out)
+{
+	// `Out` is left without a type where the value is not known at compile
+	// time. errors are only returned for values known to be invalid.
+	
+	*Out = (struct ConstVal){0};
+	struct FlatAst const *Ast = &Ce->Mod->Ast;
+	unsigned char Type = Ast->Nodes[Node].Type;
+	uint32_t Lhs = Ast->Nodes[Node].FirstChild;
+	uint32_t Rhs = Lhs ? Ast->Nodes[Lhs].NextSibling : 0;
+	
+	struct ConstVal a, b;
+	switch (Type)
+	{
+	case ANT_EXPR:
+		return ConstEval_Expr(Ce, Lhs, Out);
+	case ANT_EXPR_ATOM:
+		return ConstEval_Atom(Ce, Node, Out);
+	case ANT_EXPR_TYPE_ACCESS:
+	{
+		// methods are accessed the same way as enum members.
+		char const *TypeName = FlatAst_TokenText(Ast, Lhs, 0);
+		char const *Name = FlatAst_TokenText(Ast, Rhs, 0);
+		if (Symtab_SearchValues(Ce->Mod->Symtab, Name, TypeName))
+			return 0;
+		
+		struct SymtabEntry const *Ent = Symtab_SearchTypes(Ce->Mod->Symtab, TypeName);
+		if (!Ent || Ent->Type != SET_ENUM)
+			return 0;
+		
+		struct FlatAst const *EnumAst = &Ent->DeclMod->Ast;
+		uint32_t Base = EnumAst->Nodes[Ent->DeclNode].FirstChild;
+		for (uint32_t Memb = EnumAst->Nodes[Base].NextSibling; Memb; Memb = EnumAst->Nodes[Memb].NextSibling)
+		{
+			if (FlatAst_TokenText(EnumAst, Memb, 0) == Name)
+				return ConstEval_Member(Ce, Ent->DeclMod, Ent->DeclNode, Memb, Out);
+		}
+		
+		return 0;
+	}
+	case ANT_EXPR_SIZEOF:
+	{
+		struct ModuleData const *TypeMod = Ce->Mod;
+		uint32_t TypeNode = Lhs;
+		if (Ast->Nodes[Lhs].Type != ANT_TYPE && !ConstEval_TypeOf(Ce, Lhs, &TypeMod, &TypeNode))
+			return 0;
+		
+		return ConstEval_SizeOf(Ce, TypeMod, TypeNode, Out);
+	}
+	case ANT_EXPR_LENOF:
+	{
+		struct Token const *Tok = FlatAst_Token(Ast, Lhs, 0);
+		if (Ast->Nodes[Lhs].Type == ANT_EXPR_ATOM && Tok->Type == TT_LIT_STR)
+		{
+			*Out = (struct ConstVal){.Type = CVT_INT, .SizeMod = SM_SIZE, .Int = Ast->Lex.Strs[Tok->Payload].Len};
+			return 0;
+		}
+		
+		struct ModuleData const *TypeMod;
+		uint32_t TypeNode;
+		if (!ConstEval_TypeOf(Ce, Lhs, &TypeMod, &TypeNode) || TypeMod->Ast.Nodes[TypeNode].Type != ANT_TYPE_BUFFER)
+			return 0;
+		
+		return ConstEval_Len(Ce, TypeMod, TypeNode, Out);
+	}
+	case ANT_EXPR_CAST:
+	{
+		struct ConstVal To;
+		if (ConstEval_Expr(Ce, Lhs, &a))
+			return 1;
+		if (!a.Type || !ConstEval_Type(Ce->Mod, Rhs, &To))
+			return 0;
+		
+		return ConstEval_Convert(Ce, Node, &a, &To, Out);
+	}
+	case ANT_EXPR_UNARY_MINUS:
+	case ANT_EXPR_LOG_NOT:
+	case ANT_EXPR_BIT_NOT:
+		if (ConstEval_Expr(Ce, Lhs, &a))
+			return 1;
+		return a.Type ? ConstEval_Unary(Ce, Node, Type, &a, Out) : 0;
+	case ANT_EXPR_LOG_AND:
+	case ANT_EXPR_LOG_OR:
+		// the right operand is only needed if the left one does not decide.
+		if (ConstEval_Expr(Ce, Lhs, &a))
+			return 1;
+		if (!a.Type)
+			return 0;
+		
+		if (ConstVal_Truth(&a) == (Type == ANT_EXPR_LOG_OR))
+		{
+			*Out = (struct ConstVal){.Type = CVT_BOOL, .Int = Type == ANT_EXPR_LOG_OR};
+			return 0;
+		}
+		
+		if (ConstEval_Expr(Ce, Rhs, &b))
+			return 1;
+		if (b.Type)
+			*Out = (struct ConstVal){.Type = CVT_BOOL, .Int = ConstVal_Truth(&b)};
+		return 0;
+	case ANT_EXPR_TERNARY:
+	{
+		// both branches give the type of the result.
+		struct ConstVal Cond, Common;
+		if (ConstEval_Expr(Ce, Lhs, &Cond))
+			return 1;
+		if (!Cond.Type)
+			return 0;
+		
+		if (ConstEval_Expr(Ce, Rhs, &a) || ConstEval_Expr(Ce, Ast->Nodes[Rhs].NextSibling, &b))
+			return 1;
+		if (!a.Type || !b.Type)
+			return 0;
+		
+		if (a.Type == CVT_BOOL && b.Type == CVT_BOOL)
+		{
+			*Out = ConstVal_Truth(&Cond) ? a : b;
+			return 0;
+		}
+		
+		ConstEval_Common(&a, &b, &Common);
+		return ConstEval_Convert(Ce, Node, ConstVal_Truth(&Cond) ? &a : &b, &Common, Out);
+	}
+	case ANT_EXPR_MUL:
+	case ANT_EXPR_DIV:
+	case ANT_EXPR_MOD:
+	case ANT_EXPR_ADD:
+	case ANT_EXPR_SUB:
+	case ANT_EXPR_SHR:
+	case ANT_EXPR_SHL:
+	case ANT_EXPR_BIT_AND:
+	case ANT_EXPR_BIT_XOR:
+	case ANT_EXPR_BIT_OR:
+	case ANT_EXPR_GREATER:
+	case ANT_EXPR_GREQUAL:
+	case ANT_EXPR_LESS:
+	case ANT_EXPR_LEQUAL:
+	case ANT_EXPR_EQUAL:
+	case ANT_EXPR_NEQUAL:
+	case ANT_EXPR_LOG_XOR:
+		if (ConstEval_Expr(Ce, Lhs, &a))
+			return 1;
+		if (!a.Type)
+			return 0;
+		
+		if (ConstEval_Expr(Ce, Rhs, &b))
+			return 1;
+		return b.Type ? ConstEval_Binary(Ce, Node, Type, &a, &b, Out) : 0;
+	default:
+		return 0;
+	}
+}
+
+static int
+ConstEval_Len(
+	struct ConstEval const *Ce,
+	struct ModuleData const *Mod,
+	uint32_t Buf,
+	struct ConstVal *Out
+)
+{
+	// finds the length of a buffer type as a `Usize`.
+	
+	*Out = (struct ConstVal){0};
+	struct FlatAst const *Ast = &Mod->Ast;
+	uint32_t Len = Ast->Nodes[Ast->Nodes[Buf].FirstChild].NextSibling;
+	
+	struct ConstEval Inner;
+	struct ConstVal Val;
+	if (ConstEval_Nest(Ce, Mod, Buf, &Inner) || ConstEval_Expr(&Inner, Len, &Val))
+		return 1;
+	
+	if (Val.Type == CVT_INT && !(Val.Signed && (int64_t)Val.Int < 0))
+		*Out = (struct ConstVal){.Type = CVT_INT, .SizeMod = SM_SIZE, .Int = Val.Int};
+	return 0;
+}
+
+static int
+ConstEval_Member(
+	struct ConstEval const *Ce,
+	struct ModuleData const *Mod,
+	uint32_t Enum,
+	uint32_t Memb,
+	struct ConstVal *Out
+)
+{
+	// members without a value count up from the last one with one, or from
+	// zero, each being `(Base)(Prev + 1)`.
+	
+	*Out = (struct ConstVal){0};
+	struct FlatAst const *Ast = &Mod->Ast;
+	uint32_t Base = Ast->Nodes[Enum].FirstChild;
+	
+	struct ConstEval Inner;
+	struct ConstVal Type, Val;
+	if (ConstEval_Nest(Ce, Mod, Memb, &Inner))
+		return 1;
+	if (!ConstEval_Type(Mod, Base, &Type))
+		return 0;
+	
+	uint32_t From = 0;
+	size_t Steps = 0;
+	for (uint32_t It = Ast->Nodes[Base].NextSibling; It; It = Ast->Nodes[It].NextSibling)
+	{
+		if (Ast->Nodes[It].ChildCnt)
+		{
+			From = It;
+			Steps = 0;
+		}
+		else
+			++Steps;
+		
+		if (It == Memb)
+			break;
+	}
+	
+	if (From)
+	{
+		struct ConstEval FromEval;
+		struct ConstVal Init;
+		if (From != Memb && ConstEval_Nest(&Inner, Mod, From, &FromEval))
+			return 1;
+		if (ConstEval_Expr(From != Memb ? &FromEval : &Inner, Ast->Nodes[From].FirstChild, &Init))
+			return 1;
+		if (!Init.Type)
+			return 0;
+		if (ConstEval_Convert(&Inner, From, &Init, &Type, &Val))
+			return 1;
+	}
+	else
+	{
+		Val = Type;
+		--Steps;
+	}
+	
+	struct ConstVal One = {.Type = CVT_INT, .SizeMod = SM_32, .Signed = true, .Int = 1};
+	for (; Steps; --Steps)
+	{
+		struct ConstVal Sum;
+		if (ConstEval_Binary(&Inner, Memb, ANT_EXPR_ADD, &Val, &One, &Sum))
+			return 1;
+		if (ConstEval_Convert(&Inner, Memb, &Sum, &Type, &Val))
+			return 1;
+	}
+	
+	*Out = Val;
+	return 0;
+}
+
+static int
+ConstEval_Nest(
+	struct ConstEval const *Ce,
+	struct ModuleData const *Mod,
+	uint32_t Decl,
+	struct ConstEval *Out
+)
+{
+	// moves on to evaluating the value of a declaration, which must not
+	// already be under evaluation.
+	
+	for (struct ConstEval const *It = Ce; It; It = It->Outer)
+	{
+		if (It->Mod == Mod && It->Decl == Decl)
+		{
+			LogAstNodeErr(Mod, Decl, "constant value depends on itself!");
+			return 1;
+		}
+	}
+	
+	*Out = (struct ConstEval){.Mod = Mod, .Outer = Ce, .Decl = Decl};
+	return 0;
+}
+
+static int
+ConstEval_SizeOf(
+	struct ConstEval const *Ce,
+	struct ModuleData const *Mod,
+	uint32_t Type,
+	struct ConstVal *Out
+)
+{
+	// sizes of aggregates and pointers are left to the C compiler.
+	
+	*Out = (struct ConstVal){0};
+	struct FlatAst const *Ast = &Mod->Ast;
+	while (Ast->Nodes[Type].Type == ANT_TYPE)
+		Type = Ast->Nodes[Type].FirstChild;
+	
+	uint64_t Size;
+	if (Ast->Nodes[Type].Type == ANT_TYPE_BUFFER)
+	{
+		struct ConstVal Elem, Len;
+		if (ConstEval_SizeOf(Ce, Mod, Ast->Nodes[Type].FirstChild, &Elem) || ConstEval_Len(Ce, Mod, Type, &Len))
+			return 1;
+		if (!Elem.Type || !Len.Type)
+			return 0;
+		
+		Size = Elem.Int * Len.Int;
+	}
+	else
+	{
+		struct ConstVal Scalar;
+		if (!ConstEval_Type(Mod, Type, &Scalar))
+			return 0;
+		
+		Size = Scalar.Type == CVT_BOOL ? 1 : SizeModBits(Scalar.SizeMod) / 8;
+	}
+	
+	*Out = (struct ConstVal){.Type = CVT_INT, .SizeMod = SM_SIZE, .Int = Size};
+	return 0;
+}
+
+static bool
+ConstEval_Type(struct ModuleData const *Mod, uint32_t Type, struct ConstVal *Out)
+{
+	// describes scalar types in `Out`, returning false for others.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	while (Ast->Nodes[Type].Type == ANT_TYPE)
+		Type = Ast->Nodes[Type].FirstChild;
+	if (Ast->Nodes[Type].Type != ANT_TYPE_ATOM)
+		return false;
+	
+	*Out = (struct ConstVal){.Type = CVT_INT};
+	struct Token const *Tok = FlatAst_Token(Ast, Type, 0);
+	switch (Tok->Type)
+	{
+	case TT_KW_UINT8:
+		Out->SizeMod = SM_8;
+		return true;
+	case TT_KW_UINT16:
+		Out->SizeMod = SM_16;
+		return true;
+	case TT_KW_UINT32:
+		Out->SizeMod = SM_32;
+		return true;
+	case TT_KW_UINT64:
+		Out->SizeMod = SM_64;
+		return true;
+	case TT_KW_USIZE:
+		Out->SizeMod = SM_SIZE;
+		return true;
+	case TT_KW_INT8:
+		Out->SizeMod = SM_8;
+		Out->Signed = true;
+		return true;
+	case TT_KW_INT16:
+		Out->SizeMod = SM_16;
+		Out->Signed = true;
+		return true;
+	case TT_KW_INT32:
+		Out->SizeMod = SM_32;
+		Out->Signed = true;
+		return true;
+	case TT_KW_INT64:
+		Out->SizeMod = SM_64;
+		Out->Signed = true;
+		return true;
+	case TT_KW_ISIZE:
+		Out->SizeMod = SM_SIZE;
+		Out->Signed = true;
+		return true;
+	case TT_KW_BOOL:
+		Out->Type = CVT_BOOL;
+		return true;
+	case TT_KW_FLOAT32:
+		Out->Type = CVT_FLOAT;
+		Out->SizeMod = SM_32;
+		return true;
+	case TT_KW_FLOAT64:
+		Out->Type = CVT_FLOAT;
+		Out->SizeMod = SM_64;
+		return true;
+	case TT_IDENT:
+	{
+		// enums are plain integers of their base type.
+		struct SymtabEntry const *Ent = Symtab_SearchTypes(Mod->Symtab, LexData_Text(&Ast->Lex, Tok));
+		if (!Ent || Ent->Type != SET_ENUM)
+			return false;
+		
+		return ConstEval_Type(Ent->DeclMod, Ent->DeclMod->Ast.Nodes[Ent->DeclNode].FirstChild, Out);
+	}
+	default:
+		return false;
+	}
+}
+
+static bool
+ConstEval_TypeOf(
+	struct ConstEval const *Ce,
+	uint32_t Node,
+	struct ModuleData const **OutMod,
+	uint32_t *OutType
+)
+{
+	// finds the declared type of an expression without evaluating it. outside
+	// of procedures, only global variables have one.
+	
+	if (Ce->Es)
+	{
+		struct EmitType Type = EmitTypeOf(Ce->Es, Node);
+		EmitTypeStrip(&Type);
+		if (!Type.Node || Type.Ref)
+			return false;
+		
+		*OutMod = Type.Mod;
+		*OutType = Type.Node;
+		return true;
+	}
+	
+	struct FlatAst const *Ast = &Ce->Mod->Ast;
+	while (Ast->Nodes[Node].Type == ANT_EXPR)
+		Node = Ast->Nodes[Node].FirstChild;
+	if (Ast->Nodes[Node].Type != ANT_EXPR_ATOM || FlatAst_Token(Ast, Node, 0)->Type != TT_IDENT)
+		return false;
+	
+	struct SymtabEntry const *Ent = Symtab_SearchValues(Ce->Mod->Symtab, FlatAst_TokenText(Ast, Node, 0), NULL);
+	if (!Ent || Ent->Type != SET_VAR)
+		return false;
+	
+	struct FlatAst const *DeclAst = &Ent->DeclMod->Ast;
+	uint32_t Type = DeclAst->Nodes[Ent->DeclNode].FirstChild;
+	while (DeclAst->Nodes[Type].Type == ANT_TYPE)
+		Type = DeclAst->Nodes[Type].FirstChild;
+	
+	*OutMod = Ent->DeclMod;
+	*OutType = Type;
+	return true;
+}
+
+static int
+ConstEval_Unary(
+	struct ConstEval const *Ce,
+	uint32_t Node,
+	unsigned char Op,
+	struct ConstVal const *Val,
+	struct ConstVal *Out
+)
+{
+	*Out = (struct ConstVal){0};
+	if (Op == ANT_EXPR_LOG_NOT)
+	{
+		*Out = (struct ConstVal){.Type = CVT_BOOL, .Int = !ConstVal_Truth(Val)};
+		return 0;
+	}
+	
+	if (Val->Type == CVT_FLOAT)
+	{
+		if (Op == ANT_EXPR_UNARY_MINUS)
+		{
+			*Out = *Val;
+			Out->Float = -Val->Float;
+		}
+		return 0;
+	}
+	
+	struct ConstVal Res = *Val;
+	ConstVal_Promote(&Res);
+	if (Op == ANT_EXPR_BIT_NOT)
+		Res.Int = ~Res.Int;
+	else
+	{
+		int64_t Min = SizeModBits(Res.SizeMod) == 64 ? INT64_MIN : INT32_MIN;
+		if (Res.Signed && (int64_t)Res.Int == Min)
+		{
+			LogAstNodeErr(Ce->Mod, Node, "integer overflow in constant expression!");
+			return 1;
+		}
+		Res.Int = -Res.Int;
+	}
+	
+	ConstVal_Wrap(&Res);
+	*Out = Res;
+	return 0;
+}
+
+static int
+ConstEval_Var(struct ConstEval const *Ce, struct SymtabEntry const *Ent, struct ConstVal *Out)
+{
+	// immutable global variables with a scalar initial value are constants.
+	
+	struct ModuleData const *Mod = Ent->DeclMod;
+	struct FlatAst const *Ast = &Mod->Ast;
+	uint32_t Type = Ast->Nodes[Ent->DeclNode].FirstChild;
+	uint32_t Value = Ast->Nodes[Type].NextSibling;
+	
+	*Out = (struct ConstVal){0};
+	if (!Value || Ast->Nodes[Ent->DeclNode].Flags & ANF_EXTERN)
+		return 0;
+	if (Ast->Nodes[Ast->Nodes[Type].FirstChild].Flags & ANF_MUT)
+		return 0;
+	
+	struct ConstEval Inner;
+	struct ConstVal To, Val;
+	if (!ConstEval_Type(Mod, Type, &To))
+		return 0;
+	if (ConstEval_Nest(Ce, Mod, Ent->DeclNode, &Inner) || ConstEval_Expr(&Inner, Value, &Val))
+		return 1;
+	
+	return Val.Type ? ConstEval_Convert(&Inner, Value, &Val, &To, Out) : 0;
+}
+
+static void
+ConstVal_Promote(struct ConstVal *Val)
+{
+	// integers narrower than `int` and booleans promote to `int`.
+	if (Val->Type == CVT_BOOL || (Val->Type == CVT_INT && SizeModBits(Val->SizeMod) < 32))
+	{
+		Val->Type = CVT_INT;
+		Val->SizeMod = SM_32;
+		Val->Signed = true;
+	}
+}
+
+static bool
+ConstVal_SignedArith(unsigned char Op, int64_t Lhs, int64_t Rhs, unsigned Bits, int64_t *Out)
+{
+	// returns whether the result overflows signed integers of `Bits`.
+	
+	bool Overflow;
+	switch (Op)
+	{
+	case ANT_EXPR_ADD:
+		Overflow = (Rhs > 0 && Lhs > INT64_MAX - Rhs) || (Rhs < 0 && Lhs < INT64_MIN - Rhs);
+		*Out = Overflow ? 0 : Lhs + Rhs;
+		break;
+	case ANT_EXPR_SUB:
+		Overflow = (Rhs < 0 && Lhs > INT64_MAX + Rhs) || (Rhs > 0 && Lhs < INT64_MIN + Rhs);
+		*Out = Overflow ? 0 : Lhs - Rhs;
+		break;
+	default:
+		if (Lhs > 0)
+			Overflow = Rhs > 0 ? Lhs > INT64_MAX / Rhs : Rhs < INT64_MIN / Lhs;
+		else
+			Overflow = Rhs > 0 ? Lhs < INT64_MIN / Rhs : Lhs && Rhs < INT64_MAX / Lhs;
+		*Out = Overflow ? 0 : Lhs * Rhs;
+		break;
+	}
+	
+	int64_t Max = Bits == 64 ? INT64_MAX : ((int64_t)1 << (Bits - 1)) - 1;
+	return Overflow || *Out > Max || *Out < -Max - 1;
+}
+
+static bool
+ConstVal_Truth(struct ConstVal const *Val)
+{
+	return Val->Type == CVT_FLOAT ? Val->Float != 0.0 : Val->Int != 0;
+}
+
+static void
+ConstVal_Wrap(struct ConstVal *Val)
+{
+	// truncates integers to their width, then extends them back.
+	
+	unsigned Bits = SizeModBits(Val->SizeMod);
+	if (Val->Type != CVT_INT || Bits >= 64)
+		return;
+	
+	uint64_t Mask = ((uint64_t)1 << Bits) - 1;
+	Val->Int &= Mask;
+	if (Val->Signed && Val->Int >> (Bits - 1))
+		Val->Int |= ~Mask;
+}
+
+static int
+ConvEscSequence(
+	char const *Src,
+	size_t SrcLen,
+	size_t *i,
+	char **Str,
+	size_t *Len
+)
+{
+	if (!strncmp(&Src[*i], "\\n", 2))
+	{
+		DynStr_AppendChar(Str, Len, '\n');
+		*i += 2;
+	}
+	else if (!strncmp(&Src[*i], "\\r", 2))
+	{
+		DynStr_AppendChar(Str, Len, '\r');
+		*i += 2;
+	}
+	else if (!strncmp(&Src[*i], "\\t", 2))
+	{
+		DynStr_AppendChar(Str, Len, '\t');
+		*i += 2;
+	}
+	else if (!strncmp(&Src[*i], "\\\\", 2))
+	{
+		DynStr_AppendChar(Str, Len, '\\');
+		*i += 2;
+	}
+	else if (!strncmp(&Src[*i], "\\'", 2))
+	{
+		DynStr_AppendChar(Str, Len, '\'');
+		*i += 2;
+	}
+	else if (!strncmp(&Src[*i], "\\\"", 2))
 	{
 		DynStr_AppendChar(Str, Len, '\"');
 		*i += 2;
 	}
-	else if (!strncmp(&Src[*i], "\\b", 2))
+	else if (!strncmp(&Src[*i], "\\b", 2))
+	{
+		if (*i + 10 >= SrcLen)
+			return 1;
+		
+		uint8_t Val = 0;
+		for (size_t j = *i + 2; j < *i + 10; ++j)
+		{
+			if (!strchr("01", Src[j]))
+				return 1;
+			
+			Val <<= 1;
+			Val += Src[j] - '0';
+		}
+		
+		DynStr_AppendChar(Str, Len, Val);
+		*i += 10;
+	}
+	else if (!strncmp(&Src[*i], "\\x", 2))
+	{
+		if (*i + 4 >= SrcLen)
+			return 1;
+		
+		uint8_t Val = 0;
+		for (size_t j = *i + 2; j < *i + 4; ++j)
+		{
+			if (!isxdigit(Src[j]))
+				return 1;
+			
+			Val <<= 4;
+			Val += HexDigitValue[(size_t)Src[j]];
+		}
+		
+		DynStr_AppendChar(Str, Len, Val);
+		*i += 4;
+	}
+	else
+		return 1;
+	
+	return 0;
+}
+
+static uint32_t
+DepGraph_AddNode(struct DepGraph *Graph, struct DepNode const *Node)
+{
+	if (Graph->NodeCnt >= Graph->NodeCap)
+	{
+		Graph->NodeCap = Graph->NodeCap ? 2 * Graph->NodeCap : 64;
+		Graph->Nodes = reallocarray(
+			Graph->Nodes,
+			Graph->NodeCap,
+			sizeof(struct DepNode)
+		);
+	}
+	
+	Graph->Nodes[Graph->NodeCnt] = *Node;
+	return Graph->NodeCnt++;
+}
+
+static void
+DepGraph_Build(struct DepGraph *Graph)
+{
+	// counting sort edges by source node.
+	Graph->SuccBegins = calloc(Graph->NodeCnt + 1, sizeof(uint32_t));
+	Graph->Succs = malloc((Graph->EdgeCnt + 1) * sizeof(uint32_t));
+	
+	for (size_t i = 0; i < Graph->EdgeCnt; ++i)
+		++Graph->SuccBegins[Graph->Edges[i].From + 1];
+	
+	for (size_t i = 0; i < Graph->NodeCnt; ++i)
+		Graph->SuccBegins[i + 1] += Graph->SuccBegins[i];
+	
+	// `SuccBegins[i]` is used as an insertion cursor for node `i`, leaving it
+	// at the beginning of node `i + 1` so the rows just need shifting after.
+	for (size_t i = 0; i < Graph->EdgeCnt; ++i)
+	{
+		struct DepEdge const *Edge = &Graph->Edges[i];
+		Graph->Succs[Graph->SuccBegins[Edge->From]++] = Edge->To;
+	}
+	
+	memmove(&Graph->SuccBegins[1], &Graph->SuccBegins[0], Graph->NodeCnt * sizeof(uint32_t));
+	Graph->SuccBegins[0] = 0;
+}
+
+static void
+DepGraph_Connect(struct DepGraph *Graph, uint32_t From, uint32_t To)
+{
+	if (Graph->EdgeCnt >= Graph->EdgeCap)
+	{
+		Graph->EdgeCap = Graph->EdgeCap ? 2 * Graph->EdgeCap : 64;
+		Graph->Edges = reallocarray(
+			Graph->Edges,
+			Graph->EdgeCap,
+			sizeof(struct DepEdge)
+		);
+	}
+	
+	Graph->Edges[Graph->EdgeCnt++] = (struct DepEdge){.From = From, .To = To};
+}
+
+static void
+DepGraph_Destroy(struct DepGraph *Graph)
+{
+	free(Graph->Nodes);
+	free(Graph->Edges);
+	free(Graph->SuccBegins);
+	free(Graph->Succs);
+}
+
+static size_t
+DepGraph_FindComponents(struct DepGraph const *Graph, uint32_t *OutComps)
+{
+	// iterative version of Tarjan's strongly connected components algorithm,
+	// writing the component index of each node into `OutComps`.
+	
+	size_t NodeCnt = Graph->NodeCnt;
+	uint32_t *Order = malloc(NodeCnt * sizeof(uint32_t));
+	uint32_t *Low = malloc(NodeCnt * sizeof(uint32_t));
+	uint32_t *Stack = malloc(NodeCnt * sizeof(uint32_t));
+	uint32_t *Calls = malloc(NodeCnt * sizeof(uint32_t));
+	uint32_t *NextSuccs = malloc(NodeCnt * sizeof(uint32_t));
+	
+	// nodes with an order but no component yet are on `Stack`.
+	memset(Order, 0xff, NodeCnt * sizeof(uint32_t));
+	memset(OutComps, 0xff, NodeCnt * sizeof(uint32_t));
+	
+	size_t StackCnt = 0, CallCnt = 0, CompCnt = 0;
+	uint32_t NextOrder = 0;
+	for (size_t Root = 0; Root < NodeCnt; ++Root)
+	{
+		if (Order[Root] != UINT32_MAX)
+			continue;
+		
+		Order[Root] = Low[Root] = NextOrder++;
+		NextSuccs[Root] = Graph->SuccBegins[Root];
+		Stack[StackCnt++] = Root;
+		Calls[CallCnt++] = Root;
+		
+		while (CallCnt)
+		{
+			uint32_t Node = Calls[CallCnt - 1];
+			
+			// descend into next unvisited successor.
+			if (NextSuccs[Node] < Graph->SuccBegins[Node + 1])
+			{
+				uint32_t Succ = Graph->Succs[NextSuccs[Node]++];
+				if (Order[Succ] == UINT32_MAX)
+				{
+					Order[Succ] = Low[Succ] = NextOrder++;
+					NextSuccs[Succ] = Graph->SuccBegins[Succ];
+					Stack[StackCnt++] = Succ;
+					Calls[CallCnt++] = Succ;
+				}
+				else if (OutComps[Succ] == UINT32_MAX && Order[Succ] < Low[Node])
+					Low[Node] = Order[Succ];
+				
+				continue;
+			}
+			
+			// all successors done, return to caller.
+			--CallCnt;
+			if (CallCnt && Low[Node] < Low[Calls[CallCnt - 1]])
+				Low[Calls[CallCnt - 1]] = Low[Node];
+			
+			// pop component if node is its root.
+			if (Low[Node] == Order[Node])
+			{
+				uint32_t Memb;
+				do
+				{
+					Memb = Stack[--StackCnt];
+					OutComps[Memb] = CompCnt;
+				} while (Memb != Node);
+				
+				++CompCnt;
+			}
+		}
+	}
+	
+	free(NextSuccs);
+	free(Calls);
+	free(Stack);
+	free(Low);
+	free(Order);
+	
+	return CompCnt;
+}
+
+static bool
+DepGraph_SearchEdge(struct DepGraph const *Graph, uint32_t From, uint32_t To)
+{
+	for (uint32_t i = Graph->SuccBegins[From]; i < Graph->SuccBegins[From + 1]; ++i)
+	{
+		if (Graph->Succs[i] == To)
+			return true;
+	}
+	return false;
+}
+
+static void
+DynStr_AppendBuf(char **Str, size_t *Len, char const *Buf, size_t BufLen)
+{
+	*Str = realloc(*Str, *Len + BufLen + 1);
+	memcpy(*Str + *Len, Buf, BufLen);
+	*Len += BufLen;
+	(*Str)[*Len] = 0;
+}
+
+static void
+DynStr_AppendChar(char **Str, size_t *Len, char Ch)
+{
+	++*Len;
+	*Str = realloc(*Str, *Len + 1);
+	(*Str)[*Len - 1] = Ch;
+	(*Str)[*Len] = 0;
+}
+
+static void
+DynStr_AppendStr(char **Str, size_t *Len, char const *Append)
+{
+	size_t AppendLen = strlen(Append);
+	*Str = realloc(*Str, *Len + AppendLen + 1);
+	strcpy(*Str + *Len, Append);
+	*Len += AppendLen;
+}
+
+static void
+DynStr_Init(char **Str, size_t *Len)
+{
+	*Str = malloc(1);
+	(*Str)[0] = 0;
+	*Len = 0;
+}
+
+static int
+Emit(struct Symtab const *Symtabs, struct ModuleDataGroup *Modules)
+{
+	// only the main module's procedures are defined, unless the whole program
+	// is emitted as one translation unit.
+	
+	if (Ctx->Conf.OutDir)
+		return EmitSeparate(Symtabs, Modules);
+	
+	bool Unity = Ctx->Conf.Flags & CF_UNITY;
+	if (Unity)
+	{
+		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+		{
+			if (Modules->Modules[i].Interface)
+			{
+				LogErr("unity output needs module source, not an interface - '%s'!", Modules->Modules[i].File.Name);
+				return 1;
+			}
+		}
+	}
+	
+	struct EmitState Es =
+	{
+		.Out =
+		{
+			.Fp = Ctx->Conf.OutFp,
+			.File = Ctx->Conf.OutFile
+		},
+		.Symtabs = Symtabs,
+		.Modules = Modules
+	};
+	EmitSetModule(&Es, &Modules->Modules[0]);
+	
+	uint64_t Begin = GetTimeNs();
+	int Rc = 0;
+	
+	// write out prelude.
+	{
+		Emitter_Str(&Es.Out, "// generated by lithic from ");
+		Emitter_Str(&Es.Out, Es.Mod->File.Name);
+		Emitter_Str(&Es.Out, ".\n\n");
+		EmitPrelude(&Es);
+	}
+	
+	// declare the types of every module, as public ones may contain private
+	// ones. each is defined only after the types it contains.
+	{
+		bool Any = false;
+		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+			EmitTypeNames(&Es, &Modules->Modules[i], &Any);
+		
+		unsigned char **Marks = malloc(Modules->ModuleCnt * sizeof(unsigned char *));
+		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+			Marks[i] = calloc(Modules->Modules[i].Ast.NodeCnt, 1);
+		
+		for (size_t i = 0; i < Modules->ModuleCnt && !Rc; ++i)
+			Rc = EmitTypeDecls(&Es, &Modules->Modules[i], EV_ALL, Marks);
+		
+		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+			free(Marks[i]);
+		free(Marks);
+	}
+	
+	// declare procedures, and the other modules' variables.
+	if (!Rc)
+	{
+		Emitter_Char(&Es.Out, '\n');
+		for (size_t i = 0; i < Modules->ModuleCnt && !Rc; ++i)
+			Rc = EmitProcHeads(&Es, &Modules->Modules[i], i == 0 || Unity ? EV_ALL : EV_PUBLIC);
+	}
+	
+	// declare imported variables and define the emitted modules' own, those
+	// of imported modules first as initializers may refer to them.
+	if (!Rc)
+	{
+		bool Any = false;
+		for (size_t i = Modules->ModuleCnt; i-- > 0 && !Rc;)
+		{
+			bool Define = i == 0 || Unity;
+			Rc = EmitGlobalVars(&Es, &Modules->Modules[i], Define ? EV_ALL : EV_PUBLIC, Define, &Any);
+		}
+	}
+	
+	// define lambdas and procedures, callees before their callers so the C
+	// compiler sees small helpers before the code that might inline them.
+	if (!Rc)
+	{
+		struct DepGraph Graph = {0};
+		uint32_t *Order = EmitProcOrder(&Es, 0, Unity ? Modules->ModuleCnt : 1, &Graph);
+		for (size_t i = 0; i < Graph.NodeCnt && !Rc; ++i)
+		{
+			struct DepNode const *Node = &Graph.Nodes[Order[i]];
+			EmitSetModule(&Es, Node->DeclMod);
+			Rc = EmitProc(&Es, Node->DeclNode);
+		}
+		
+		free(Order);
+		DepGraph_Destroy(&Graph);
+	}
+	
+	if (!Rc)
+		Rc = EmitMain(&Es);
+	
+	if (!Rc)
+		Rc = Emitter_Flush(&Es.Out, true);
+	
+	TimeData_AddEvent("emit", Modules->Modules[0].File.Name, Begin, GetTimeNs(), 0);
+	
+	// free allocated memory.
+	{
+		free(Es.Out.Buf);
+		free(Es.Locals);
+		free(Es.Defers);
+		free(Es.Jumps);
+	}
+	
+	return Rc;
+}
+
+static int
+EmitArgs(
+	struct EmitState *Es,
+	uint32_t Call,
+	uint32_t FirstArg,
+	struct ModuleData const *ParamMod,
+	uint32_t FirstParam,
+	unsigned char Flags,
+	bool Separate
+)
+{
+	// parameters are either `ANT_ARG` nodes or bare types of procedure types,
+	// and `Flags` are the variadicity flags of their list. `Separate` is set if
+	// an argument has already been written.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct FlatAst const *ParamAst = &ParamMod->Ast;
+	
+	uint32_t Arg = FirstArg;
+	for (uint32_t Param = FirstParam; Param; Param = ParamAst->Nodes[Param].NextSibling)
+	{
+		if (!Arg)
+		{
+			LogAstNodeErr(Es->Mod, Call, "too few arguments in procedure call!");
+			return 1;
+		}
+		
+		if (Separate)
+			Emitter_Str(&Es->Out, ", ");
+		Separate = true;
+		
+		uint32_t ParamType = Param;
+		if (ParamAst->Nodes[Param].Type == ANT_ARG)
+			ParamType = ParamAst->Nodes[Param].FirstChild;
+		
+		struct EmitType Expect = {.Mod = ParamMod, .Node = ParamType};
+		if (EmitExpr(Es, Arg, &Expect, false))
+			return 1;
+		
+		Arg = Ast->Nodes[Arg].NextSibling;
+	}
+	
+	if (!(Flags & ANF_VARIADIC))
+	{
+		if (Arg)
+		{
+			LogAstNodeErr(Es->Mod, Call, "too many arguments in procedure call!");
+			return 1;
+		}
+		
+		return 0;
+	}
+	
+	// length-enabled variadic arguments are preceded by their count.
+	if (!(Flags & ANF_BASE))
+	{
+		size_t VargCnt = 0;
+		for (uint32_t Varg = Arg; Varg; Varg = Ast->Nodes[Varg].NextSibling)
+			++VargCnt;
+		
+		if (Separate)
+			Emitter_Str(&Es->Out, ", ");
+		Separate = true;
+		Emitter_Uint(&Es->Out, VargCnt);
+	}
+	
+	for (; Arg; Arg = Ast->Nodes[Arg].NextSibling)
+	{
+		if (Separate)
+			Emitter_Str(&Es->Out, ", ");
+		Separate = true;
+		
+		if (EmitExpr(Es, Arg, NULL, false))
+			return 1;
+	}
+	
+	return 0;
+}
+
+static int
+EmitCall(struct EmitState *Es, uint32_t Node)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	uint32_t Callee = Ast->Nodes[Node].FirstChild;
+	uint32_t FirstArg = Ast->Nodes[Callee].NextSibling;
+	
+	// calls to declared procedures.
+	struct SymtabEntry const *Proc = NULL;
+	uint32_t SelfExpr = 0;
+	bool SelfIsPtr = false;
+	{
+		switch (Ast->Nodes[Callee].Type)
+		{
+		case ANT_EXPR_ATOM:
+		{
+			struct Token const *Tok = FlatAst_Token(Ast, Callee, 0);
+			if (Tok->Type != TT_IDENT)
+				break;
+			
+			char const *Name = LexData_Text(&Ast->Lex, Tok);
+			if (EmitFindLocal(Es, Name))
+				break;
+			
+			Proc = Symtab_SearchValues(Es->Symtab, Name, NULL);
+			if (Proc && Proc->Type != SET_PROC)
+				Proc = NULL;
+			
+			break;
+		}
+		case ANT_EXPR_TYPE_ACCESS:
+		{
+			uint32_t Lhs = Ast->Nodes[Callee].FirstChild;
+			uint32_t Rhs = Ast->Nodes[Lhs].NextSibling;
+			Proc = Symtab_SearchValues(
+				Es->Symtab,
+				FlatAst_TokenText(Ast, Rhs, 0),
+				FlatAst_TokenText(Ast, Lhs, 0)
+			);
+			
+			if (!Proc)
+			{
+				LogAstNodeErr(Es->Mod, Callee, "call to undeclared method!");
+				return 1;
+			}
+			
+			break;
+		}
+		case ANT_EXPR_ACCESS:
+		{
+			// members holding procedures take priority over methods.
+			uint32_t Lhs = Ast->Nodes[Callee].FirstChild;
+			uint32_t Rhs = Ast->Nodes[Lhs].NextSibling;
+			char const *Name = FlatAst_TokenText(Ast, Rhs, 0);
+			
+			struct EmitType LhsType = EmitTypeOf(Es, Lhs);
+			struct SymtabEntry const *Ent = EmitTypeEntry(Es, &LhsType);
+			if (!Ent)
+			{
+				struct EmitType Pointee = EmitTypeDeref(&LhsType);
+				Ent = EmitTypeEntry(Es, &Pointee);
+				SelfIsPtr = true;
+			}
+			
+			if (!Ent)
+			{
+				LogAstNodeErr(Es->Mod, Lhs, "cannot determine type of method receiver!");
+				return 1;
+			}
+			
+			if (!SelfIsPtr && EmitFindMember(Ent, Name))
+				break;
+			
+			Proc = Symtab_SearchValues(Es->Symtab, Name, Ent->Name);
+			if (!Proc)
+			{
+				LogAstNodeErr(Es->Mod, Rhs, "no such member or method!");
+				return 1;
+			}
+			
+			SelfExpr = Lhs;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	
+	if (Proc)
+	{
+		struct FlatAst const *ProcAst = &Proc->DeclMod->Ast;
+		uint32_t ArgList = ProcAst->Nodes[Proc->DeclNode].FirstChild;
+		uint32_t Param = ProcAst->Nodes[ArgList].FirstChild;
+		unsigned char Flags = ProcAst->Nodes[ArgList].Flags;
+		
+		EmitProcName(Es, Proc->DeclMod, Proc->DeclNode);
+		Emitter_Char(&Es->Out, '(');
+		
+		// pass the receiver in the form its `Self` argument takes.
+		if (SelfExpr)
+		{
+			if (!Param || FlatAst_Token(ProcAst, Param, 0)->Type != TT_KW_SELF)
+			{
+				LogAstNodeErr(Es->Mod, Callee, "method does not take Self!");
+				return 1;
+			}
+			
+			uint32_t SelfType = ProcAst->Nodes[ProcAst->Nodes[Param].FirstChild].FirstChild;
+			bool WantPtr = ProcAst->Nodes[SelfType].Type == ANT_TYPE_PTR;
+			if (WantPtr && !SelfIsPtr)
+				Emitter_Char(&Es->Out, '&');
+			else if (!WantPtr && SelfIsPtr)
+				Emitter_Char(&Es->Out, '*');
+			
+			if (EmitExpr(Es, SelfExpr, NULL, true))
+				return 1;
+			
+			Param = ProcAst->Nodes[Param].NextSibling;
+		}
+		
+		if (EmitArgs(Es, Node, FirstArg, Proc->DeclMod, Param, Flags, SelfExpr))
+			return 1;
+		
+		Emitter_Char(&Es->Out, ')');
+		return 0;
+	}
+	
+	// calls through procedure values, which must at least be declared.
+	uint32_t Named = Callee;
+	while (Ast->Nodes[Named].Type == ANT_EXPR)
+		Named = Ast->Nodes[Named].FirstChild;
+	if (Ast->Nodes[Named].Type == ANT_EXPR_ATOM && FlatAst_Token(Ast, Named, 0)->Type == TT_IDENT)
+	{
+		char const *Name = FlatAst_TokenText(Ast, Named, 0);
+		if (!EmitFindLocal(Es, Name) && !Symtab_SearchValues(Es->Symtab, Name, NULL))
+		{
+			LogAstNodeErr(Es->Mod, Named, "use of undeclared identifier!");
+			return 1;
+		}
+	}
+	
+	struct EmitType Type = EmitTypeOf(Es, Callee);
+	EmitTypeStrip(&Type);
+	if (!Type.Node || Type.Ref || Type.Mod->Ast.Nodes[Type.Node].Type != ANT_TYPE_PROC)
+	{
+		LogAstNodeErr(Es->Mod, Callee, "called value is not a procedure!");
+		return 1;
+	}
+	
+	struct FlatAst const *TypeAst = &Type.Mod->Ast;
+	uint32_t RetType = TypeAst->Nodes[Type.Node].FirstChild;
+	unsigned char Flags = TypeAst->Nodes[Type.Node].Flags;
+	
+	if (EmitExpr(Es, Callee, NULL, true))
+		return 1;
+	Emitter_Char(&Es->Out, '(');
+	if (EmitArgs(Es, Node, FirstArg, Type.Mod, TypeAst->Nodes[RetType].NextSibling, Flags, false))
+		return 1;
+	Emitter_Char(&Es->Out, ')');
+	
+	return 0;
+}
+
+static int
+EmitCaseCheck(struct EmitState *Es, uint32_t Node)
+{
+	// case labels must be integer constants, distinct once converted to the
+	// promoted type switched on where it is known.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct ConstEval Ce = {.Mod = Es->Mod, .Es = Es};
+	uint32_t Cond = Ast->Nodes[Node].FirstChild;
+	
+	struct ModuleData const *TypeMod;
+	uint32_t TypeNode;
+	struct ConstVal Type;
+	bool Typed = ConstEval_TypeOf(&Ce, Cond, &TypeMod, &TypeNode) && ConstEval_Type(TypeMod, TypeNode, &Type);
+	if (Typed)
+		ConstVal_Promote(&Type);
+	
+	uint32_t *Labels = NULL;
+	uint64_t *Vals = NULL;
+	size_t LabelCnt = 0, LabelCap = 0;
+	
+	int Rc = 0;
+	for (uint32_t Case = Ast->Nodes[Cond].NextSibling; Case && !Rc; Case = Ast->Nodes[Case].NextSibling)
+	{
+		if (Ast->Nodes[Case].Type != ANT_CASE)
+			continue;
+		
+		uint32_t Matches = Ast->Nodes[Ast->Nodes[Case].FirstChild].FirstChild;
+		uint32_t Match = Matches;
+		if (Ast->Nodes[Matches].Type == ANT_EXPR_LIST)
+			Match = Ast->Nodes[Matches].FirstChild;
+		
+		for (; Match && !Rc; Match = Ast->Nodes[Matches].Type == ANT_EXPR_LIST ? Ast->Nodes[Match].NextSibling : 0)
+		{
+			struct ConstVal Val;
+			if ((Rc = ConstEval_Expr(&Ce, Match, &Val)))
+				break;
+			
+			if (Val.Type != CVT_INT && Val.Type != CVT_BOOL)
+			{
+				LogAstNodeErr(Es->Mod, Match, "case labels must be integer constants!");
+				Rc = 1;
+				break;
+			}
+			
+			if (Typed && Type.Type == CVT_INT)
+			{
+				struct ConstVal Conv;
+				if ((Rc = ConstEval_Convert(&Ce, Match, &Val, &Type, &Conv)))
+					break;
+				Val = Conv;
+			}
+			
+			for (size_t i = 0; i < LabelCnt; ++i)
+			{
+				if (Vals[i] == Val.Int)
+				{
+					LogAstNodeErr(Es->Mod, Match, "duplicate case label!");
+					LogAstNodeContext(Es->Mod, Labels[i], "previously used here:");
+					Rc = 1;
+					break;
+				}
+			}
+			if (Rc)
+				break;
+			
+			if (LabelCnt >= LabelCap)
+			{
+				LabelCap = LabelCap ? 2 * LabelCap : 16;
+				Labels = reallocarray(Labels, LabelCap, sizeof(uint32_t));
+				Vals = reallocarray(Vals, LabelCap, sizeof(uint64_t));
+			}
+			Labels[LabelCnt] = Match;
+			Vals[LabelCnt++] = Val.Int;
+		}
+	}
+	
+	free(Labels);
+	free(Vals);
+	return Rc;
+}
+
+static int
+EmitConstExpr(struct EmitState *Es, uint32_t Node, bool *OutDone)
+{
+	// writes the value of `Node` if it is known at compile time, setting
+	// `OutDone` if so.
+	
+	struct ConstEval Ce = {.Mod = Es->Mod, .Es = Es};
+	struct ConstVal Val;
+	
+	*OutDone = false;
+	if (ConstEval_Expr(&Ce, Node, &Val))
+		return 1;
+	
+	if (Val.Type)
+	{
+		EmitConstVal(Es, &Val, false);
+		*OutDone = true;
+	}
+	
+	return 0;
+}
+
+static void
+EmitConstVal(struct EmitState *Es, struct ConstVal const *Val, bool Bare)
+{
+	// values are written with their own C type, unless `Bare` is set for a
+	// cast around them.
+	
+	static char const *SignedNames[] = {NULL, "int8_t", "int16_t", "int32_t", "int64_t", "ptrdiff_t"};
+	static char const *UnsignedNames[] = {NULL, "uint8_t", "uint16_t", "uint32_t", "uint64_t", "size_t"};
+	
+	if (Val->Type == CVT_BOOL)
+	{
+		Emitter_Str(&Es->Out, Val->Int ? "true" : "false");
+		return;
+	}
+	
+	if (Val->Type == CVT_FLOAT)
+	{
+		char Buf[40];
+		int Len = snprintf(Buf, sizeof(Buf), "%.17g", Val->Float);
+		if (Buf[0] == '-')
+			Emitter_Char(&Es->Out, '(');
+		Emitter_Buf(&Es->Out, Buf, Len);
+		if (!strpbrk(Buf, ".e"))
+			Emitter_Str(&Es->Out, ".0");
+		if (Val->SizeMod == SM_32)
+			Emitter_Char(&Es->Out, 'f');
+		if (Buf[0] == '-')
+			Emitter_Char(&Es->Out, ')');
+		return;
+	}
+	
+	// `int` and `unsigned` need no cast.
+	bool Neg = Val->Signed && (int64_t)Val->Int < 0;
+	bool Min = Neg && (Val->Int == (uint64_t)INT64_MIN || (Val->SizeMod == SM_32 && Val->Int == (uint64_t)(int64_t)INT32_MIN));
+	char const *Cast = NULL;
+	if (!Bare && Val->SizeMod != SM_32)
+		Cast = Val->Signed ? SignedNames[Val->SizeMod] : UnsignedNames[Val->SizeMod];
+	bool Paren = Cast || (Neg && !Min && !Bare);
+	
+	if (Cast)
+	{
+		Emitter_Str(&Es->Out, "((");
+		Emitter_Str(&Es->Out, Cast);
+		Emitter_Char(&Es->Out, ')');
+	}
+	else if (Paren)
+		Emitter_Char(&Es->Out, '(');
+	
+	// the most negative values have no literal.
+	if (Min)
+		Emitter_Str(&Es->Out, Val->Int == (uint64_t)INT64_MIN ? "INT64_MIN" : "INT32_MIN");
+	else if (Neg)
+	{
+		Emitter_Char(&Es->Out, '-');
+		Emitter_Uint(&Es->Out, -Val->Int);
+	}
+	else
+	{
+		Emitter_Uint(&Es->Out, Val->Int);
+		if (Val->Int > INT64_MAX || (!Val->Signed && !Cast && !Bare))
+			Emitter_Char(&Es->Out, 'u');
+	}
+	
+	if (Paren)
+		Emitter_Char(&Es->Out, ')');
+}
+
+static int
+EmitDecl(
+	struct EmitState *Es,
+	struct ModuleData const *Mod,
+	uint32_t Type,
+	char const *Name
+)
+{
+	// `Name` is emitted as is, or left out for an abstract declarator.
+	
+	if (EmitDeclPrefix(Es, Mod, Type))
+		return 1;
+	
+	if (Name)
+	{
+		char Last = Es->Out.Len ? Es->Out.Buf[Es->Out.Len - 1] : 0;
+		if (isalnum(Last) || Last == '_')
+			Emitter_Char(&Es->Out, ' ');
+		Emitter_Str(&Es->Out, Name);
+	}
+	
+	return EmitDeclSuffix(Es, Mod, Type);
+}
+
+static void
+EmitDeclName(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Node)
+{
+	// names a top-level declaration, or prefixes the members of one. private
+	// declarations of imported modules may clash with those of others, so
+	// they are qualified by module. external variables keep their C name.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	if (Mod->ImportName && !(Ast->Nodes[Node].Flags & (ANF_PUBLIC | ANF_EXTERN)))
+		EmitModulePrefix(Es, Mod);
+	EmitIdent(Es, FlatAst_TokenText(Ast, Node, 0));
+}
+
+static int
+EmitDeclPrefix(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Type)
+{
+	// C declarators wrap around the declared name, so types are written as
+	// the part before the name and the part after it, see `EmitDeclSuffix`.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	switch (Ast->Nodes[Type].Type)
+	{
+	case ANT_TYPE:
+	case ANT_TYPE_BUFFER:
+		return EmitDeclPrefix(Es, Mod, Ast->Nodes[Type].FirstChild);
+	case ANT_TYPE_ARRAY:
+		Emitter_Str(&Es->Out, "struct lc_Array");
+		return 0;
+	case ANT_TYPE_PTR:
+	{
+		uint32_t Pointee = Ast->Nodes[Type].FirstChild;
+		if (EmitDeclPrefix(Es, Mod, Pointee))
+			return 1;
+		
+		unsigned char PointeeType = Ast->Nodes[Pointee].Type;
+		if (PointeeType == ANT_TYPE_BUFFER || PointeeType == ANT_TYPE_PROC)
+			Emitter_Str(&Es->Out, " (*");
+		else if (PointeeType != ANT_TYPE_PTR)
+			Emitter_Str(&Es->Out, " *");
+		else
+			Emitter_Char(&Es->Out, '*');
+		
+		return 0;
+	}
+	case ANT_TYPE_PROC:
+		if (EmitDeclPrefix(Es, Mod, Ast->Nodes[Type].FirstChild))
+			return 1;
+		Emitter_Str(&Es->Out, " (*");
+		return 0;
+	case ANT_TYPE_ATOM:
+	{
+		struct Token const *Tok = FlatAst_Token(Ast, Type, 0);
+		switch (Tok->Type)
+		{
+		case TT_KW_UINT8:
+			Emitter_Str(&Es->Out, "uint8_t");
+			return 0;
+		case TT_KW_UINT16:
+			Emitter_Str(&Es->Out, "uint16_t");
+			return 0;
+		case TT_KW_UINT32:
+			Emitter_Str(&Es->Out, "uint32_t");
+			return 0;
+		case TT_KW_UINT64:
+			Emitter_Str(&Es->Out, "uint64_t");
+			return 0;
+		case TT_KW_USIZE:
+			Emitter_Str(&Es->Out, "size_t");
+			return 0;
+		case TT_KW_INT8:
+			Emitter_Str(&Es->Out, "int8_t");
+			return 0;
+		case TT_KW_INT16:
+			Emitter_Str(&Es->Out, "int16_t");
+			return 0;
+		case TT_KW_INT32:
+			Emitter_Str(&Es->Out, "int32_t");
+			return 0;
+		case TT_KW_INT64:
+			Emitter_Str(&Es->Out, "int64_t");
+			return 0;
+		case TT_KW_ISIZE:
+			Emitter_Str(&Es->Out, "ptrdiff_t");
+			return 0;
+		case TT_KW_BOOL:
+			Emitter_Str(&Es->Out, "bool");
+			return 0;
+		case TT_KW_FLOAT32:
+			Emitter_Str(&Es->Out, "float");
+			return 0;
+		case TT_KW_FLOAT64:
+			Emitter_Str(&Es->Out, "double");
+			return 0;
+		case TT_KW_NULL:
+			Emitter_Str(&Es->Out, "void");
+			return 0;
+		case TT_KW_VARGS:
+			Emitter_Str(&Es->Out, Ast->Nodes[Type].Flags & ANF_BASE ? "va_list" : "struct lc_Vargs");
+			return 0;
+		case TT_KW_SELF:
+		case TT_IDENT:
+		{
+			char const *Name = Tok->Type == TT_IDENT ? LexData_Text(&Ast->Lex, Tok) : Es->SelfName;
+			struct SymtabEntry const *Ent = Name ? Symtab_SearchTypes(EmitSymtab(Es, Mod), Name) : NULL;
+			if (!Ent)
+			{
+				LogAstNodeErr(Mod, Type, "use of unrecognized type!");
+				return 1;
+			}
+			
+			// enums are plain integers of their base type.
+			if (Ent->Type == SET_ENUM)
+			{
+				uint32_t Base = Ent->DeclMod->Ast.Nodes[Ent->DeclNode].FirstChild;
+				return EmitDeclPrefix(Es, Ent->DeclMod, Base);
+			}
+			
+			Emitter_Str(&Es->Out, Ent->Type == SET_STRUCT ? "struct " : "union ");
+			EmitDeclName(Es, Ent->DeclMod, Ent->DeclNode);
+			return 0;
+		}
+		default:
+			LogAstNodeErr(Mod, Type, "type cannot be emitted here!");
+			return 1;
+		}
+	}
+	default:
+		return 0;
+	}
+}
+
+static int
+EmitDeclSuffix(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Type)
+{
+	struct FlatAst const *Ast = &Mod->Ast;
+	switch (Ast->Nodes[Type].Type)
+	{
+	case ANT_TYPE:
+		return EmitDeclSuffix(Es, Mod, Ast->Nodes[Type].FirstChild);
+	case ANT_TYPE_PTR:
+	{
+		uint32_t Pointee = Ast->Nodes[Type].FirstChild;
+		unsigned char PointeeType = Ast->Nodes[Pointee].Type;
+		if (PointeeType == ANT_TYPE_BUFFER || PointeeType == ANT_TYPE_PROC)
+			Emitter_Char(&Es->Out, ')');
+		
+		return EmitDeclSuffix(Es, Mod, Pointee);
+	}
+	case ANT_TYPE_BUFFER:
+	{
+		// the size expression belongs to the module declaring the type.
+		uint32_t Elem = Ast->Nodes[Type].FirstChild;
+		struct ModuleData *PrevMod = EmitSetModule(Es, Mod);
+		
+		Emitter_Char(&Es->Out, '[');
+		int Rc = EmitExpr(Es, Ast->Nodes[Elem].NextSibling, NULL, false);
+		Emitter_Char(&Es->Out, ']');
+		
+		EmitSetModule(Es, PrevMod);
+		if (Rc)
+			return 1;
+		
+		return EmitDeclSuffix(Es, Mod, Elem);
+	}
+	case ANT_TYPE_PROC:
+	{
+		uint32_t RetType = Ast->Nodes[Type].FirstChild;
+		unsigned char Flags = Ast->Nodes[Type].Flags;
+		
+		Emitter_Str(&Es->Out, ")(");
+		for (uint32_t Param = Ast->Nodes[RetType].NextSibling; Param; Param = Ast->Nodes[Param].NextSibling)
+		{
+			if (EmitDecl(Es, Mod, Param, NULL))
+				return 1;
+			if (Ast->Nodes[Param].NextSibling)
+				Emitter_Str(&Es->Out, ", ");
+		}
+		
+		if (Flags & ANF_VARIADIC)
+		{
+			if (Ast->Nodes[RetType].NextSibling)
+				Emitter_Str(&Es->Out, ", ");
+			Emitter_Str(&Es->Out, Flags & ANF_BASE ? "..." : "size_t, ...");
+		}
+		else if (!Ast->Nodes[RetType].NextSibling)
+			Emitter_Str(&Es->Out, "void");
+		
+		Emitter_Char(&Es->Out, ')');
+		return EmitDeclSuffix(Es, Mod, RetType);
+	}
+	default:
+		return 0;
+	}
+}
+
+static void
+EmitDefer_Add(struct EmitState *Es, uint32_t Stmt)
+{
+	// a zero statement ends the walk over variadic arguments.
+	if (Es->DeferCnt >= Es->DeferCap)
+	{
+		Es->DeferCap = Es->DeferCap ? 2 * Es->DeferCap : 16;
+		Es->Defers = reallocarray(Es->Defers, Es->DeferCap, sizeof(uint32_t));
+	}
+	
+	Es->Defers[Es->DeferCnt++] = Stmt;
+}
+
+static int
+EmitDefers(struct EmitState *Es, size_t Until)
+{
+	// deferred statements run in reverse order, each seeing only the defers
+	// registered before it.
+	size_t DeferCnt = Es->DeferCnt;
+	int Rc = 0;
+	for (size_t i = DeferCnt; i-- > Until && !Rc;)
+	{
+		Es->DeferCnt = i;
+		if (!Es->Defers[i])
+		{
+			Emitter_Indent(&Es->Out, Es->Indent);
+			Emitter_Str(&Es->Out, "va_end(lc_Args);\n");
+		}
+		else
+			Rc = EmitStatement(Es, Es->Defers[i]);
+	}
+	Es->DeferCnt = DeferCnt;
+	return Rc;
+}
+
+static int
+EmitExpr(
+	struct EmitState *Es,
+	uint32_t Node,
+	struct EmitType const *Expect,
+	bool Paren
+)
+{
+	// `Expect` is the type the value is used as, if known. unless `Paren` is
+	// set, the outermost operator is not parenthesized.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct FlatAstNode const *Flat = &Ast->Nodes[Node];
+	uint32_t Lhs = Flat->FirstChild;
+	uint32_t Rhs = Lhs ? Ast->Nodes[Lhs].NextSibling : 0;
+	
+	// operations on values known at compile time are folded, as is anything
+	// within global initial values, where C only takes constants.
+	if (!Es->Proc || Flat->Type == ANT_EXPR_SIZEOF || Flat->Type == ANT_EXPR_LENOF
+		|| (Flat->Type >= ANT_EXPR_CAST && Flat->Type <= ANT_EXPR_TERNARY))
+	{
+		bool Folded;
+		if (EmitConstExpr(Es, Node, &Folded))
+			return 1;
+		if (Folded)
+			return 0;
+	}
+	
+	char const *Op = NULL;
+	switch (Flat->Type)
+	{
+	case ANT_EXPR:
+		return EmitExpr(Es, Lhs, Expect, Paren);
+	case ANT_EXPR_ATOM:
+		return EmitExprAtom(Es, Node);
+	case ANT_EXPR_LIST:
+	{
+		struct EmitType Type = Expect ? *Expect : (struct EmitType){0};
+		EmitTypeStrip(&Type);
+		
+		unsigned char TypeType = Type.Node ? Type.Mod->Ast.Nodes[Type.Node].Type : 0;
+		if (Type.Ref || (TypeType != ANT_TYPE_ARRAY && TypeType != ANT_TYPE_BUFFER))
+		{
+			LogAstNodeErr(Es->Mod, Node, "cannot determine type of list expression!");
+			return 1;
+		}
+		
+		struct EmitType Elem = {.Mod = Type.Mod, .Node = Type.Mod->Ast.Nodes[Type.Node].FirstChild};
+		if (TypeType == ANT_TYPE_ARRAY)
+			Emitter_Str(&Es->Out, "((struct lc_Array){");
+		
+		Emitter_Char(&Es->Out, '(');
+		if (EmitDecl(Es, Elem.Mod, Elem.Node, NULL))
+			return 1;
+		Emitter_Str(&Es->Out, "[]){");
+		
+		if (EmitExprList(Es, Node, &Elem))
+			return 1;
+		Emitter_Char(&Es->Out, '}');
+		
+		if (TypeType == ANT_TYPE_ARRAY)
+		{
+			Emitter_Str(&Es->Out, ", ");
+			Emitter_Uint(&Es->Out, Flat->ChildCnt);
+			Emitter_Str(&Es->Out, "})");
+		}
+		
+		return 0;
+	}
+	case ANT_EXPR_LENOF:
+	{
+		struct FlatAstNode const *Arg = &Ast->Nodes[Lhs];
+		if (Arg->Type == ANT_EXPR_ATOM)
+		{
+			struct Token const *Tok = FlatAst_Token(Ast, Lhs, 0);
+			if (Tok->Type == TT_LIT_STR)
+			{
+				Emitter_Uint(&Es->Out, Ast->Lex.Strs[Tok->Payload].Len);
+				return 0;
+			}
+			if (Tok->Type == TT_KW_VARGS && !(Arg->Flags & ANF_BASE))
+			{
+				Emitter_Str(&Es->Out, "lc_VargCnt");
+				return 0;
+			}
+		}
+		
+		struct EmitType Type = EmitTypeOf(Es, Lhs);
+		EmitTypeStrip(&Type);
+		
+		struct FlatAstNode const *TypeNode = Type.Node && !Type.Ref ? &Type.Mod->Ast.Nodes[Type.Node] : NULL;
+		if (TypeNode && TypeNode->Type == ANT_TYPE_BUFFER)
+		{
+			Emitter_Str(&Es->Out, "(sizeof(");
+			if (EmitExpr(Es, Lhs, NULL, false))
+				return 1;
+			Emitter_Str(&Es->Out, ") / sizeof(");
+			if (EmitExpr(Es, Lhs, NULL, true))
+				return 1;
+			Emitter_Str(&Es->Out, "[0]))");
+			return 0;
+		}
+		
+		bool IsVargs = TypeNode && TypeNode->Type == ANT_TYPE_ATOM
+			&& FlatAst_Token(&Type.Mod->Ast, Type.Node, 0)->Type == TT_KW_VARGS
+			&& !(TypeNode->Flags & ANF_BASE);
+		if (!TypeNode || (TypeNode->Type != ANT_TYPE_ARRAY && !IsVargs))
+		{
+			LogAstNodeErr(Es->Mod, Lhs, "cannot take length of value!");
+			return 1;
+		}
+		
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Str(&Es->Out, ".Len");
+		return 0;
+	}
+	case ANT_EXPR_NEXTVARG:
+	{
+		if (EmitVariadicCheck(Es, Node))
+			return 1;
+		
+		// arguments narrower than `int` and single precision floats arrive
+		// promoted.
+		char const *Promoted = NULL;
+		{
+			uint32_t Atom = Ast->Nodes[Lhs].FirstChild;
+			struct SymtabEntry const *Ent = NULL;
+			struct ModuleData const *AtomMod = Es->Mod;
+			
+			if (Ast->Nodes[Atom].Type == ANT_TYPE_ATOM && FlatAst_Token(Ast, Atom, 0)->Type == TT_IDENT)
+			{
+				Ent = Symtab_SearchTypes(Es->Symtab, FlatAst_TokenText(Ast, Atom, 0));
+				if (Ent && Ent->Type == SET_ENUM)
+				{
+					AtomMod = Ent->DeclMod;
+					Atom = AtomMod->Ast.Nodes[AtomMod->Ast.Nodes[Ent->DeclNode].FirstChild].FirstChild;
+				}
+			}
+			
+			if (AtomMod->Ast.Nodes[Atom].Type == ANT_TYPE_ATOM)
+			{
+				switch (FlatAst_Token(&AtomMod->Ast, Atom, 0)->Type)
+				{
+				case TT_KW_UINT8:
+				case TT_KW_UINT16:
+				case TT_KW_INT8:
+				case TT_KW_INT16:
+				case TT_KW_BOOL:
+					Promoted = "int";
+					break;
+				case TT_KW_FLOAT32:
+					Promoted = "double";
+					break;
+				default:
+					break;
+				}
+			}
+		}
+		
+		if (Promoted)
+		{
+			Emitter_Str(&Es->Out, "((");
+			if (EmitDecl(Es, Es->Mod, Lhs, NULL))
+				return 1;
+			Emitter_Str(&Es->Out, ")va_arg(lc_Args, ");
+			Emitter_Str(&Es->Out, Promoted);
+			Emitter_Str(&Es->Out, "))");
+			return 0;
+		}
+		
+		Emitter_Str(&Es->Out, "va_arg(lc_Args, ");
+		if (EmitDecl(Es, Es->Mod, Lhs, NULL))
+			return 1;
+		Emitter_Char(&Es->Out, ')');
+		return 0;
+	}
+	case ANT_EXPR_LAMBDA:
+		EmitProcName(Es, Es->Mod, Node);
+		return 0;
+	case ANT_EXPR_SIZEOF:
+		Emitter_Str(&Es->Out, "sizeof(");
+		if (Ast->Nodes[Lhs].Type == ANT_TYPE)
+		{
+			if (EmitDecl(Es, Es->Mod, Lhs, NULL))
+				return 1;
+		}
+		else if (EmitExpr(Es, Lhs, NULL, false))
+			return 1;
+		Emitter_Char(&Es->Out, ')');
+		return 0;
+	case ANT_EXPR_STRUCT:
+	case ANT_EXPR_UNION:
+		return EmitTypeLiteral(Es, Node);
+	case ANT_EXPR_VARGCOUNT:
+		if (EmitVariadicCheck(Es, Node))
+			return 1;
+		Emitter_Str(&Es->Out, "lc_VargCnt");
+		return 0;
+	case ANT_EXPR_NULL:
+		Emitter_Char(&Es->Out, '(');
+		if (EmitDecl(Es, Es->Mod, Lhs, NULL))
+			return 1;
+		Emitter_Str(&Es->Out, "){0}");
+		return 0;
+	case ANT_EXPR_CALL:
+		return EmitCall(Es, Node);
+	case ANT_EXPR_NTH:
+	{
+		struct EmitType Type = EmitTypeOf(Es, Lhs);
+		EmitTypeStrip(&Type);
+		
+		// arrays only know their element type here.
+		if (Type.Node && !Type.Ref && Type.Mod->Ast.Nodes[Type.Node].Type == ANT_TYPE_ARRAY)
+		{
+			Emitter_Str(&Es->Out, "((");
+			if (EmitDecl(Es, Type.Mod, Type.Mod->Ast.Nodes[Type.Node].FirstChild, NULL))
+				return 1;
+			Emitter_Str(&Es->Out, " *)");
+			if (EmitExpr(Es, Lhs, NULL, true))
+				return 1;
+			Emitter_Str(&Es->Out, ".Data)[");
+		}
+		else
+		{
+			if (EmitExpr(Es, Lhs, NULL, true))
+				return 1;
+			Emitter_Char(&Es->Out, '[');
+		}
+		
+		if (EmitExpr(Es, Rhs, NULL, false))
+			return 1;
+		Emitter_Char(&Es->Out, ']');
+		return 0;
+	}
+	case ANT_EXPR_ACCESS:
+	{
+		// members are reachable through a pointer as well.
+		struct EmitType LhsType = EmitTypeOf(Es, Lhs);
+		bool Indirect = !EmitTypeEntry(Es, &LhsType);
+		if (Indirect)
+		{
+			struct EmitType Pointee = EmitTypeDeref(&LhsType);
+			Indirect = EmitTypeEntry(Es, &Pointee);
+		}
+		
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Str(&Es->Out, Indirect ? "->" : ".");
+		EmitIdent(Es, FlatAst_TokenText(Ast, Rhs, 0));
+		return 0;
+	}
+	case ANT_EXPR_TYPE_ACCESS:
+	{
+		// enum members and methods share the same naming scheme.
+		char const *TypeName = FlatAst_TokenText(Ast, Lhs, 0);
+		struct SymtabEntry const *Method = Symtab_SearchValues(Es->Symtab, FlatAst_TokenText(Ast, Rhs, 0), TypeName);
+		if (Method && Method->Type == SET_PROC)
+		{
+			EmitProcName(Es, Method->DeclMod, Method->DeclNode);
+			return 0;
+		}
+		
+		struct SymtabEntry const *Ent = Symtab_SearchTypes(Es->Symtab, TypeName);
+		if (!Ent)
+		{
+			LogAstNodeErr(Es->Mod, Lhs, "use of unrecognized type!");
+			return 1;
+		}
+		
+		EmitDeclName(Es, Ent->DeclMod, Ent->DeclNode);
+		Emitter_Char(&Es->Out, '_');
+		Emitter_Str(&Es->Out, FlatAst_TokenText(Ast, Rhs, 0));
+		return 0;
+	}
+	case ANT_EXPR_CAST:
+		Emitter_Str(&Es->Out, "((");
+		if (EmitDecl(Es, Es->Mod, Rhs, NULL))
+			return 1;
+		Emitter_Char(&Es->Out, ')');
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Char(&Es->Out, ')');
+		return 0;
+	case ANT_EXPR_ADDR_OF:
+		Op = "&";
+		break;
+	case ANT_EXPR_DEREF:
+		Op = "*";
+		break;
+	case ANT_EXPR_PRE_INC:
+		Op = "++";
+		break;
+	case ANT_EXPR_PRE_DEC:
+		Op = "--";
+		break;
+	case ANT_EXPR_UNARY_MINUS:
+		Op = "-";
+		break;
+	case ANT_EXPR_LOG_NOT:
+		Op = "!";
+		break;
+	case ANT_EXPR_BIT_NOT:
+		Op = "~";
+		break;
+	case ANT_EXPR_POST_INC:
+	case ANT_EXPR_POST_DEC:
+		if (Paren)
+			Emitter_Char(&Es->Out, '(');
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Str(&Es->Out, Flat->Type == ANT_EXPR_POST_INC ? "++" : "--");
+		if (Paren)
+			Emitter_Char(&Es->Out, ')');
+		return 0;
+	case ANT_EXPR_EQUAL:
+	case ANT_EXPR_NEQUAL:
+		// aggregates have no equality of their own, as neither their bytes
+		// nor the pointers within arrays say whether their values match.
+		for (uint32_t Side = Lhs; Side; Side = Side == Lhs ? Rhs : 0)
+		{
+			struct EmitType Type = EmitTypeOf(Es, Side);
+			struct SymtabEntry const *Ent = EmitTypeEntry(Es, &Type);
+			EmitTypeStrip(&Type);
+			
+			unsigned char TypeType = Type.Node && !Type.Ref ? Type.Mod->Ast.Nodes[Type.Node].Type : 0;
+			if (TypeType == ANT_TYPE_ARRAY || TypeType == ANT_TYPE_BUFFER
+				|| (Ent && (Ent->Type == SET_STRUCT || Ent->Type == SET_UNION)))
+			{
+				LogAstNodeErr(Es->Mod, Node, "aggregates cannot be compared for equality!");
+				return 1;
+			}
+		}
+		
+		Op = Flat->Type == ANT_EXPR_EQUAL ? " == " : " != ";
+		break;
+	case ANT_EXPR_LOG_XOR:
+		Emitter_Str(&Es->Out, "(!");
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Str(&Es->Out, " != !");
+		if (EmitExpr(Es, Rhs, NULL, true))
+			return 1;
+		Emitter_Char(&Es->Out, ')');
+		return 0;
+	case ANT_EXPR_TERNARY:
+	{
+		uint32_t Else = Ast->Nodes[Rhs].NextSibling;
+		if (Paren)
+			Emitter_Char(&Es->Out, '(');
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Str(&Es->Out, " ? ");
+		if (EmitExpr(Es, Rhs, Expect, true))
+			return 1;
+		Emitter_Str(&Es->Out, " : ");
+		if (EmitExpr(Es, Else, Expect, true))
+			return 1;
+		if (Paren)
+			Emitter_Char(&Es->Out, ')');
+		return 0;
+	}
+	case ANT_EXPR_MUL:
+		Op = " * ";
+		break;
+	case ANT_EXPR_DIV:
+		Op = " / ";
+		break;
+	case ANT_EXPR_MOD:
+		Op = " % ";
+		break;
+	case ANT_EXPR_ADD:
+		Op = " + ";
+		break;
+	case ANT_EXPR_SUB:
+		Op = " - ";
+		break;
+	case ANT_EXPR_SHR:
+		Op = " >> ";
+		break;
+	case ANT_EXPR_SHL:
+		Op = " << ";
+		break;
+	case ANT_EXPR_BIT_AND:
+		Op = " & ";
+		break;
+	case ANT_EXPR_BIT_XOR:
+		Op = " ^ ";
+		break;
+	case ANT_EXPR_BIT_OR:
+		Op = " | ";
+		break;
+	case ANT_EXPR_GREATER:
+		Op = " > ";
+		break;
+	case ANT_EXPR_GREQUAL:
+		Op = " >= ";
+		break;
+	case ANT_EXPR_LESS:
+		Op = " < ";
+		break;
+	case ANT_EXPR_LEQUAL:
+		Op = " <= ";
+		break;
+	case ANT_EXPR_LOG_AND:
+		Op = " && ";
+		break;
+	case ANT_EXPR_LOG_OR:
+		Op = " || ";
+		break;
+	case ANT_EXPR_ASSIGN:
+		Op = " = ";
+		break;
+	case ANT_EXPR_ADD_ASSIGN:
+		Op = " += ";
+		break;
+	case ANT_EXPR_SUB_ASSIGN:
+		Op = " -= ";
+		break;
+	case ANT_EXPR_MUL_ASSIGN:
+		Op = " *= ";
+		break;
+	case ANT_EXPR_DIV_ASSIGN:
+		Op = " /= ";
+		break;
+	case ANT_EXPR_MOD_ASSIGN:
+		Op = " %= ";
+		break;
+	case ANT_EXPR_SHR_ASSIGN:
+		Op = " >>= ";
+		break;
+	case ANT_EXPR_SHL_ASSIGN:
+		Op = " <<= ";
+		break;
+	case ANT_EXPR_BIT_AND_ASSIGN:
+		Op = " &= ";
+		break;
+	case ANT_EXPR_BIT_XOR_ASSIGN:
+		Op = " ^= ";
+		break;
+	case ANT_EXPR_BIT_OR_ASSIGN:
+		Op = " |= ";
+		break;
+	default:
+		LogAstNodeErr(Es->Mod, Node, "cannot emit expression!");
+		return 1;
+	}
+	
+	// generic unary and binary operators, with assignments passing their
+	// target type on to the assigned value.
+	if (Paren)
+		Emitter_Char(&Es->Out, '(');
+	
+	if (!Rhs)
+	{
+		Emitter_Str(&Es->Out, Op);
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+	}
+	else
+	{
+		if (EmitExpr(Es, Lhs, NULL, true))
+			return 1;
+		Emitter_Str(&Es->Out, Op);
+		
+		struct EmitType Target = {0};
+		if (Flat->Type >= ANT_EXPR_ASSIGN && Flat->Type <= ANT_EXPR_BIT_OR_ASSIGN)
+			Target = EmitTypeOf(Es, Lhs);
+		
+		if (EmitExpr(Es, Rhs, Target.Node ? &Target : NULL, true))
+			return 1;
+	}
+	
+	if (Paren)
+		Emitter_Char(&Es->Out, ')');
+	
+	return 0;
+}
+
+static int
+EmitExprAtom(struct EmitState *Es, uint32_t Node)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct Token const *Tok = FlatAst_Token(Ast, Node, 0);
+	bool Base = Ast->Nodes[Node].Flags & ANF_BASE;
+	
+	switch (Tok->Type)
+	{
+	case TT_IDENT:
+	{
+		char const *Name = LexData_Text(&Ast->Lex, Tok);
+		if (EmitFindLocal(Es, Name))
+		{
+			EmitIdent(Es, Name);
+			return 0;
+		}
+		
+		struct SymtabEntry const *Ent = Symtab_SearchValues(Es->Symtab, Name, NULL);
+		if (!Ent)
+		{
+			LogAstNodeErr(Es->Mod, Node, "use of undeclared identifier!");
+			return 1;
+		}
+		
+		if (Ent->Type == SET_PROC)
+			EmitProcName(Es, Ent->DeclMod, Ent->DeclNode);
+		else
+			EmitDeclName(Es, Ent->DeclMod, Ent->DeclNode);
+		return 0;
+	}
+	case TT_LIT_STR:
+	{
+		struct TokenStr const *Str = &Ast->Lex.Strs[Tok->Payload];
+		Emitter_Str(&Es->Out, Base ? "((uint8_t *)" : "((struct lc_Array){(uint8_t *)");
+		EmitStrLit(Es, Str->Text, Str->Len);
+		if (!Base)
+		{
+			Emitter_Str(&Es->Out, ", ");
+			Emitter_Uint(&Es->Out, Str->Len);
+			Emitter_Char(&Es->Out, '}');
+		}
+		Emitter_Char(&Es->Out, ')');
+		return 0;
+	}
+	case TT_LIT_INT:
+	{
+		// literals are unsigned magnitudes sized by their modifier.
+		uint64_t Val = Ast->Lex.Nums[Tok->Payload].Int;
+		char const *Cast = NULL;
+		if (Tok->SizeMod == SM_64)
+			Cast = Val > INT64_MAX ? "((uint64_t)" : "((int64_t)";
+		else if (Tok->SizeMod == SM_SIZE)
+			Cast = "((size_t)";
+		
+		if (Cast)
+			Emitter_Str(&Es->Out, Cast);
+		Emitter_Uint(&Es->Out, Val);
+		if (Val > INT32_MAX)
+			Emitter_Char(&Es->Out, 'u');
+		if (Cast)
+			Emitter_Char(&Es->Out, ')');
+		
+		return 0;
+	}
+	case TT_LIT_FLOAT:
+	{
+		char Buf[40];
+		int Len = snprintf(Buf, sizeof(Buf), "%.17g", Ast->Lex.Nums[Tok->Payload].Float);
+		Emitter_Buf(&Es->Out, Buf, Len);
+		if (!strpbrk(Buf, ".en"))
+			Emitter_Str(&Es->Out, ".0");
+		if (Tok->SizeMod == SM_32)
+			Emitter_Char(&Es->Out, 'f');
+		return 0;
+	}
+	case TT_LIT_BOOL:
+		Emitter_Str(&Es->Out, Tok->Payload ? "true" : "false");
+		return 0;
+	case TT_KW_SELF:
+		if (!Es->SelfName)
+		{
+			LogAstNodeErr(Es->Mod, Node, "Self can only be used in methods!");
+			return 1;
+		}
+		Emitter_Str(&Es->Out, "Self");
+		return 0;
+	case TT_KW_VARGCOUNT:
+		if (EmitVariadicCheck(Es, Node))
+			return 1;
+		Emitter_Str(&Es->Out, "lc_VargCnt");
+		return 0;
+	case TT_KW_VARGS:
+		if (EmitVariadicCheck(Es, Node))
+			return 1;
+		Emitter_Str(&Es->Out, Base ? "lc_Args" : "((struct lc_Vargs){&lc_Args, lc_VargCnt})");
+		return 0;
+	case TT_KW_NULL:
+		Emitter_Char(&Es->Out, '0');
+		return 0;
+	default:
+		LogAstNodeErr(Es->Mod, Node, "cannot emit expression!");
+		return 1;
+	}
+}
+
+static int
+EmitExprList(struct EmitState *Es, uint32_t List, struct EmitType const *Elem)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	for (uint32_t Item = Ast->Nodes[List].FirstChild; Item; Item = Ast->Nodes[Item].NextSibling)
+	{
+		if (EmitExpr(Es, Item, Elem, false))
+			return 1;
+		if (Ast->Nodes[Item].NextSibling)
+			Emitter_Str(&Es->Out, ", ");
+	}
+	
+	return 0;
+}
+
+static struct EmitLocal const *
+EmitFindLocal(struct EmitState const *Es, char const *Name)
+{
+	// `Self` is stored without a name.
+	for (size_t i = Es->LocalCnt; i-- > 0;)
+	{
+		if (Es->Locals[i].Name == Name)
+			return &Es->Locals[i];
+	}
+	
+	return NULL;
+}
+
+static uint32_t
+EmitFindMember(struct SymtabEntry const *Ent, char const *Name)
+{
+	if (Ent->Type != SET_STRUCT && Ent->Type != SET_UNION)
+		return 0;
+	
+	struct FlatAst const *Ast = &Ent->DeclMod->Ast;
+	for (uint32_t Memb = Ast->Nodes[Ent->DeclNode].FirstChild; Memb; Memb = Ast->Nodes[Memb].NextSibling)
+	{
+		if (FlatAst_TokenText(Ast, Memb, 0) == Name)
+			return Memb;
+	}
+	
+	return 0;
+}
+
+static int
+EmitGlobalVar(struct EmitState *Es, uint32_t Node, bool Define)
+{
+	// variables of other modules and external ones are only declared.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	if (!Define || Ast->Nodes[Node].Flags & ANF_EXTERN)
+		Emitter_Str(&Es->Out, "extern ");
+	else if (!(Ast->Nodes[Node].Flags & ANF_PUBLIC))
+		Emitter_Str(&Es->Out, "static ");
+	
+	if (EmitVar(Es, Node, !Define || Ast->Nodes[Node].Flags & ANF_EXTERN))
+		return 1;
+	Emitter_Str(&Es->Out, ";\n");
+	
+	return Emitter_Flush(&Es->Out, false);
+}
+
+static int
+EmitGlobalVars(
+	struct EmitState *Es,
+	struct ModuleData const *Mod,
+	unsigned char Vis,
+	bool Define,
+	bool *Any
+)
+{
+	// `Any` tracks whether a variable has been written, to separate the first
+	// one from what came before.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+	{
+		if (Ast->Nodes[Child].Type != ANT_VAR || !ModuleData_IsLive(Mod, Child))
+			continue;
+		if (!(Vis & (Ast->Nodes[Child].Flags & ANF_PUBLIC ? EV_PUBLIC : EV_PRIVATE)))
+			continue;
+		
+		if (!*Any)
+			Emitter_Char(&Es->Out, '\n');
+		*Any = true;
+		
+		EmitSetModule(Es, Mod);
+		if (EmitGlobalVar(Es, Child, Define))
+			return 1;
+	}
+	
+	return 0;
+}
+
+static void
+EmitIdent(struct EmitState *Es, char const *Name)
+{
+	// names which C or the prelude reserve are moved out of the way.
+	bool Reserved = !strncmp(Name, "lc_", 3);
+	
+	size_t Lb = 0, Ub = sizeof(CReservedNames) / sizeof(CReservedNames[0]);
+	while (!Reserved && Lb < Ub)
+	{
+		size_t Mid = (Lb + Ub) / 2;
+		int Cmp = strcmp(Name, CReservedNames[Mid]);
+		if (!Cmp)
+			Reserved = true;
+		else if (Cmp < 0)
+			Ub = Mid;
+		else
+			Lb = Mid + 1;
+	}
+	
+	if (Reserved)
+		Emitter_Str(&Es->Out, "lc_u_");
+	Emitter_Str(&Es->Out, Name);
+}
+
+static int
+EmitJump(struct EmitState *Es, uint32_t Node)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	bool IsBreak = Ast->Nodes[Node].Type == ANT_BREAK;
+	char const *Label = Ast->Nodes[Node].TokCnt == 2 ? FlatAst_TokenText(Ast, Node, 1) : NULL;
+	
+	// unlabeled jumps target the innermost loop, labeled ones the innermost
+	// loop or block of that name.
+	size_t Target = Es->JumpCnt;
+	bool Native = true;
+	for (size_t i = Es->JumpCnt; i-- > 0;)
+	{
+		struct EmitJump const *Jump = &Es->Jumps[i];
+		if (Label ? Jump->Label == Label : Jump->Loop)
+		{
+			Target = i;
+			break;
+		}
+		
+		if (Jump->Loop)
+			Native = false;
+	}
+	
+	if (Target == Es->JumpCnt)
+	{
+		LogAstNodeErr(Es->Mod, Node, Label ? "no enclosing loop or block of that name!" : "jump outside of a loop!");
+		return 1;
+	}
+	
+	struct EmitJump *Jump = &Es->Jumps[Target];
+	if (!IsBreak && !Jump->Loop)
+	{
+		LogAstNodeErr(Es->Mod, Node, "cannot continue a block!");
+		return 1;
+	}
+	
+	if (EmitDefers(Es, Jump->DeferCnt))
+		return 1;
+	
+	// C jumps suffice unless a switch or block is in the way.
+	Native = Native && Jump->Loop && Jump->SwitchDepth == Es->SwitchDepth;
+	Emitter_Indent(&Es->Out, Es->Indent);
+	if (Native)
+		Emitter_Str(&Es->Out, IsBreak ? "break;\n" : "continue;\n");
+	else
+	{
+		Emitter_Str(&Es->Out, IsBreak ? "goto lc_Break" : "goto lc_Continue");
+		Emitter_Uint(&Es->Out, Jump->Node);
+		Emitter_Str(&Es->Out, ";\n");
+		
+		if (IsBreak)
+			Jump->BreakUsed = true;
+		else
+			Jump->ContinueUsed = true;
+	}
+	
+	return 0;
+}
+
+static void
+EmitJump_Pop(struct EmitState *Es)
+{
+	// places the break label after the construct if anything jumps to it.
+	struct EmitJump const *Jump = &Es->Jumps[--Es->JumpCnt];
+	if (Jump->BreakUsed)
+	{
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "lc_Break");
+		Emitter_Uint(&Es->Out, Jump->Node);
+		Emitter_Str(&Es->Out, ":;\n");
+	}
+}
+
+static void
+EmitJump_Push(struct EmitState *Es, uint32_t Node, char const *Label, bool Loop)
+{
+	if (Es->JumpCnt >= Es->JumpCap)
+	{
+		Es->JumpCap = Es->JumpCap ? 2 * Es->JumpCap : 16;
+		Es->Jumps = reallocarray(Es->Jumps, Es->JumpCap, sizeof(struct EmitJump));
+	}
+	
+	Es->Jumps[Es->JumpCnt++] = (struct EmitJump)
+	{
+		.Node = Node,
+		.Label = Label,
+		.DeferCnt = Es->DeferCnt,
+		.SwitchDepth = Es->SwitchDepth,
+		.Loop = Loop
+	};
+}
+
+static void
+EmitLocal_Add(
+	struct EmitState *Es,
+	char const *Name,
+	struct ModuleData const *Mod,
+	uint32_t Type
+)
+{
+	if (Es->LocalCnt >= Es->LocalCap)
+	{
+		Es->LocalCap = Es->LocalCap ? 2 * Es->LocalCap : 32;
+		Es->Locals = reallocarray(Es->Locals, Es->LocalCap, sizeof(struct EmitLocal));
+	}
+	
+	Es->Locals[Es->LocalCnt++] = (struct EmitLocal)
+	{
+		.Name = Name,
+		.Mod = Mod,
+		.Type = Type
+	};
+}
+
+static int
+EmitMain(struct EmitState *Es)
+{
+	// the entry point hands its arguments to `Main`, which may omit them.
+	
+	EmitSetModule(Es, &Es->Modules->Modules[0]);
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	
+	char const *MainName = Interner_Add("Main", 4);
+	struct SymtabEntry const *Main = Symtab_SearchValues(Es->Symtab, MainName, NULL);
+	if (!Main || Main->Type != SET_PROC || Main->DeclMod != Es->Mod)
+		return 0;
+	
+	uint32_t Args = Ast->Nodes[Main->DeclNode].FirstChild;
+	uint32_t RetType = Ast->Nodes[Args].NextSibling;
+	bool RetNull = FlatAst_Token(Ast, Ast->Nodes[RetType].FirstChild, 0)->Type == TT_KW_NULL;
+	int Rc = 0;
+	
+	Emitter_Str(&Es->Out, "\nint\nmain(int argc, char **argv)\n{\n\t");
+	if (!RetNull)
+		Emitter_Str(&Es->Out, "return ");
+	EmitProcName(Es, Es->Mod, Main->DeclNode);
+	Emitter_Char(&Es->Out, '(');
+	if (Ast->Nodes[Args].ChildCnt == 2)
+	{
+		uint32_t ArgvType = Ast->Nodes[Ast->Nodes[Args].FirstChild].NextSibling;
+		Emitter_Str(&Es->Out, "argc, (");
+		Rc = EmitDecl(Es, Es->Mod, Ast->Nodes[ArgvType].FirstChild, NULL);
+		Emitter_Str(&Es->Out, ")argv");
+	}
+	Emitter_Str(&Es->Out, RetNull ? ");\n\treturn 0;\n}\n" : ");\n}\n");
+	
+	return Rc;
+}
+
+static void
+EmitModulePrefix(struct EmitState *Es, struct ModuleData const *Mod)
+{
+	// qualifies names private to an imported module by its import path, so
+	// they are the same in every program and output file. the path length
+	// keeps paths and names from running into each other.
+	
+	Emitter_Str(&Es->Out, "lc_m");
+	Emitter_Uint(&Es->Out, strlen(Mod->ImportName));
+	Emitter_Char(&Es->Out, '_');
+	for (char const *c = Mod->ImportName; *c; ++c)
+		Emitter_Char(&Es->Out, *c == '/' ? '_' : *c);
+	Emitter_Char(&Es->Out, '_');
+}
+
+static void
+EmitPrelude(struct EmitState *Es)
+{
+	// the types may be seen through several generated headers.
+	Emitter_Str(
+		&Es->Out,
+		"#include <stdarg.h>\n"
+		"#include <stdbool.h>\n"
+		"#include <stddef.h>\n"
+		"#include <stdint.h>\n"
+		"#include <string.h>\n"
+		"\n"
+		"#ifndef lc_Prelude\n"
+		"#define lc_Prelude\n"
+		"\n"
+		"struct lc_Array\n"
+		"{\n"
+		"\tvoid *Data;\n"
+		"\tsize_t Len;\n"
+		"};\n"
+		"\n"
+		"struct lc_Vargs\n"
+		"{\n"
+		"\tva_list *Args;\n"
+		"\tsize_t Len;\n"
+		"};\n"
+		"\n"
+		"#endif\n"
+	);
+}
+
+static int
+EmitProc(struct EmitState *Es, uint32_t Node)
+{
+	// defines a procedure or hoisted lambda of the current module.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	uint32_t Args = Ast->Nodes[Node].FirstChild;
+	uint32_t Body = Ast->Nodes[Node].Type == ANT_PROC
+		? ModuleData_ProcBody(Es->Mod, Node)
+		: Ast->Nodes[Ast->Nodes[Args].NextSibling].NextSibling;
+	if (!Body)
+		return 1;
+	
+	Emitter_Char(&Es->Out, '\n');
+	if (EmitProcHead(Es, Node, true))
+		return 1;
+	Emitter_Char(&Es->Out, '\n');
+	
+	Es->Proc = Node;
+	Es->LocalCnt = 0;
+	Es->DeferCnt = 0;
+	Es->JumpCnt = 0;
+	Es->Indent = 0;
+	
+	for (uint32_t Arg = Ast->Nodes[Args].FirstChild; Arg; Arg = Ast->Nodes[Arg].NextSibling)
+		EmitLocal_Add(Es, FlatAst_TokenText(Ast, Arg, 0), Es->Mod, Ast->Nodes[Arg].FirstChild);
+	
+	// variadic arguments are walked from the start of the procedure, and the
+	// walk is ended wherever it returns.
+	int Rc;
+	if (Ast->Nodes[Args].Flags & ANF_VARIADIC)
+	{
+		Emitter_Str(&Es->Out, "{\n\tva_list lc_Args;\n\tva_start(lc_Args, ");
+		EmitVariadicLast(Es);
+		Emitter_Str(&Es->Out, ");\n");
+		
+		Es->Indent = 1;
+		EmitDefer_Add(Es, 0);
+		Rc = EmitStatementList(Es, Body, 0);
+		
+		// as well as where the body falls through.
+		uint32_t Last = 0;
+		for (uint32_t Stmt = Ast->Nodes[Body].FirstChild; Stmt; Stmt = Ast->Nodes[Stmt].NextSibling)
+			Last = Stmt;
+		if (!Rc && (!Last || Ast->Nodes[Last].Type != ANT_RETURN))
+			Rc = EmitDefers(Es, 0);
+		
+		Emitter_Str(&Es->Out, "}\n");
+	}
+	else
+		Rc = EmitStatementList(Es, Body, 0);
+	
+	Es->Proc = 0;
+	Es->SelfName = NULL;
+	
+	return Rc || Emitter_Flush(&Es->Out, false);
+}
+
+static void
+EmitProcDeps(
+	struct EmitState *Es,
+	struct DepGraph *Graph,
+	uint32_t *const *Ids,
+	uint32_t From,
+	uint32_t Node
+)
+{
+	// connects `From` to the procedures and lambdas referred to within
+	// `Node`, ignoring locals shadowing procedures. methods called through a
+	// value are not followed, as that needs its type.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct SymtabEntry const *Ent = NULL;
+	switch (Ast->Nodes[Node].Type)
+	{
+	case ANT_EXPR_LAMBDA:
+		DepGraph_Connect(Graph, From, Ids[Es->Mod - Es->Modules->Modules][Node] - 1);
+		return;
+	case ANT_EXPR_ATOM:
+		if (FlatAst_Token(Ast, Node, 0)->Type == TT_IDENT)
+			Ent = Symtab_SearchValues(Es->Symtab, FlatAst_TokenText(Ast, Node, 0), NULL);
+		break;
+	case ANT_EXPR_TYPE_ACCESS:
+	{
+		uint32_t Lhs = Ast->Nodes[Node].FirstChild;
+		uint32_t Rhs = Ast->Nodes[Lhs].NextSibling;
+		Ent = Symtab_SearchValues(Es->Symtab, FlatAst_TokenText(Ast, Rhs, 0), FlatAst_TokenText(Ast, Lhs, 0));
+		break;
+	}
+	default:
+		for (uint32_t Child = Ast->Nodes[Node].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+			EmitProcDeps(Es, Graph, Ids, From, Child);
+		return;
+	}
+	
+	// procedures of modules not being defined, or not reachable, are left out.
+	uint32_t const *ModIds = Ent ? Ids[Ent->DeclMod - Es->Modules->Modules] : NULL;
+	if (ModIds && Ent->Type == SET_PROC && ModIds[Ent->DeclNode])
+		DepGraph_Connect(Graph, From, ModIds[Ent->DeclNode] - 1);
+}
+
+static int
+EmitProcHead(struct EmitState *Es, uint32_t Node, bool Define)
+{
+	// writes the signature of a procedure or lambda, which is split over two
+	// lines in definitions.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	uint32_t Args = Ast->Nodes[Node].FirstChild;
+	uint32_t RetType = Ast->Nodes[Args].NextSibling;
+	
+	Es->SelfName = NULL;
+	if (Ast->Nodes[Node].Type == ANT_PROC && Ast->Nodes[Node].TokCnt == 2)
+		Es->SelfName = FlatAst_TokenText(Ast, Node, 0);
+	
+	if (Ast->Nodes[Node].Type == ANT_EXPR_LAMBDA || !(Ast->Nodes[Node].Flags & ANF_PUBLIC))
+		Emitter_Str(&Es->Out, "static ");
+	
+	if (EmitDeclPrefix(Es, Es->Mod, RetType))
+		return 1;
+	
+	char Last = Es->Out.Buf[Es->Out.Len - 1];
+	if (Define)
+		Emitter_Char(&Es->Out, '\n');
+	else if (isalnum(Last) || Last == '_')
+		Emitter_Char(&Es->Out, ' ');
+	
+	EmitProcName(Es, Es->Mod, Node);
+	Emitter_Char(&Es->Out, '(');
+	
+	for (uint32_t Arg = Ast->Nodes[Args].FirstChild; Arg; Arg = Ast->Nodes[Arg].NextSibling)
+	{
+		char const *Name = FlatAst_TokenText(Ast, Arg, 0);
+		if (EmitDeclPrefix(Es, Es->Mod, Ast->Nodes[Arg].FirstChild))
+			return 1;
+		
+		Last = Es->Out.Buf[Es->Out.Len - 1];
+		if (isalnum(Last) || Last == '_')
+			Emitter_Char(&Es->Out, ' ');
+		if (Name)
+			EmitIdent(Es, Name);
+		else
+			Emitter_Str(&Es->Out, "Self");
+		
+		if (EmitDeclSuffix(Es, Es->Mod, Ast->Nodes[Arg].FirstChild))
+			return 1;
+		
+		if (Ast->Nodes[Arg].NextSibling)
+			Emitter_Str(&Es->Out, ", ");
+	}
+	
+	unsigned char Flags = Ast->Nodes[Args].Flags;
+	if (Flags & ANF_VARIADIC)
+	{
+		if (Ast->Nodes[Args].FirstChild)
+			Emitter_Str(&Es->Out, ", ");
+		Emitter_Str(&Es->Out, Flags & ANF_BASE ? "..." : "size_t lc_VargCnt, ...");
+	}
+	else if (!Ast->Nodes[Args].FirstChild)
+		Emitter_Str(&Es->Out, "void");
+	
+	Emitter_Char(&Es->Out, ')');
+	return EmitDeclSuffix(Es, Es->Mod, RetType);
+}
+
+static int
+EmitProcHeads(struct EmitState *Es, struct ModuleData const *Mod, unsigned char Vis)
+{
+	// declares procedures of the module, including lambdas hoisted out of
+	// their expressions.
+	
+	EmitSetModule(Es, Mod);
+	struct FlatAst const *Ast = &Mod->Ast;
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+	{
+		if (Ast->Nodes[Child].Type != ANT_PROC || !ModuleData_IsLive(Mod, Child))
+			continue;
+		if (!(Vis & (Ast->Nodes[Child].Flags & ANF_PUBLIC ? EV_PUBLIC : EV_PRIVATE)))
+			continue;
+		
+		if (EmitProcHead(Es, Child, false))
+			return 1;
+		Emitter_Str(&Es->Out, ";\n");
+	}
+	
+	for (uint32_t Node = 0; Node < Ast->NodeCnt && Vis & EV_PRIVATE; ++Node)
+	{
+		if (Ast->Nodes[Node].Type != ANT_EXPR_LAMBDA || !ModuleData_IsLive(Mod, Node))
+			continue;
+		
+		if (EmitProcHead(Es, Node, false))
+			return 1;
+		Emitter_Str(&Es->Out, ";\n");
+	}
+	
+	return 0;
+}
+
+static void
+EmitProcName(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Node)
+{
+	// methods are prefixed by their type, and lambdas named by their node.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	if (Ast->Nodes[Node].Type == ANT_EXPR_LAMBDA)
+	{
+		if (Mod->ImportName)
+			EmitModulePrefix(Es, Mod);
+		Emitter_Str(&Es->Out, "lc_Lambda");
+		Emitter_Uint(&Es->Out, Node);
+	}
+	else if (Ast->Nodes[Node].TokCnt == 2)
+	{
+		EmitDeclName(Es, Mod, Node);
+		Emitter_Char(&Es->Out, '_');
+		Emitter_Str(&Es->Out, FlatAst_TokenText(Ast, Node, 1));
+	}
+	else
+		EmitDeclName(Es, Mod, Node);
+}
+
+static uint32_t *
+EmitProcOrder(struct EmitState *Es, size_t First, size_t Cnt, struct DepGraph *Out)
+{
+	// collects the procedures and lambdas of `Cnt` modules from index `First`
+	// into `Out`, returning the order to define them in. mutually recursive
+	// ones keep declaration order.
+	
+	struct ModuleDataGroup const *Modules = Es->Modules;
+	struct ModuleData *PrevMod = Es->Mod;
+	
+	// register nodes, mapping declarations to them by node index plus one.
+	uint32_t **Ids = calloc(Modules->ModuleCnt, sizeof(uint32_t *));
+	{
+		for (size_t i = First; i < First + Cnt; ++i)
+		{
+			struct ModuleData const *Mod = &Modules->Modules[i];
+			struct FlatAst const *Ast = &Mod->Ast;
+			Ids[i] = calloc(Ast->NodeCnt, sizeof(uint32_t));
+			
+			for (uint32_t Node = 0; Node < Ast->NodeCnt; ++Node)
+			{
+				if (Ast->Nodes[Node].Type != ANT_EXPR_LAMBDA || !ModuleData_IsLive(Mod, Node))
+					continue;
+				
+				struct DepNode DepNode = {.DeclMod = Mod, .DeclNode = Node};
+				Ids[i][Node] = DepGraph_AddNode(Out, &DepNode) + 1;
+			}
+			
+			for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+			{
+				if (Ast->Nodes[Child].Type != ANT_PROC || !ModuleData_IsLive(Mod, Child))
+					continue;
+				
+				struct DepNode DepNode = {.DeclMod = Mod, .DeclNode = Child};
+				Ids[i][Child] = DepGraph_AddNode(Out, &DepNode) + 1;
+			}
+		}
+	}
+	
+	// connect each to what its body refers to.
+	{
+		for (size_t i = 0; i < Out->NodeCnt; ++i)
+		{
+			struct DepNode const *DepNode = &Out->Nodes[i];
+			EmitSetModule(Es, DepNode->DeclMod);
+			
+			struct FlatAst const *Ast = &Es->Mod->Ast;
+			uint32_t Args = Ast->Nodes[DepNode->DeclNode].FirstChild;
+			uint32_t Body = Ast->Nodes[DepNode->DeclNode].Type == ANT_PROC
+				? ModuleData_ProcBody(Es->Mod, DepNode->DeclNode)
+				: Ast->Nodes[Ast->Nodes[Args].NextSibling].NextSibling;
+			if (Body)
+				EmitProcDeps(Es, Out, Ids, i, Body);
+		}
+		
+		DepGraph_Build(Out);
+		EmitSetModule(Es, PrevMod);
+	}
+	
+	// components are found callees first, so a counting sort by component
+	// gives the order.
+	uint32_t *Order = malloc((Out->NodeCnt + 1) * sizeof(uint32_t));
+	{
+		uint32_t *Comps = malloc((Out->NodeCnt + 1) * sizeof(uint32_t));
+		size_t CompCnt = DepGraph_FindComponents(Out, Comps);
+		
+		uint32_t *Begins = calloc(CompCnt + 1, sizeof(uint32_t));
+		for (size_t i = 0; i < Out->NodeCnt; ++i)
+			++Begins[Comps[i] + 1];
+		for (size_t i = 0; i < CompCnt; ++i)
+			Begins[i + 1] += Begins[i];
+		for (size_t i = 0; i < Out->NodeCnt; ++i)
+			Order[Begins[Comps[i]]++] = i;
+		
+		free(Begins);
+		free(Comps);
+	}
+	
+	// free allocated memory.
+	{
+		for (size_t i = First; i < First + Cnt; ++i)
+			free(Ids[i]);
+		free(Ids);
+	}
+	
+	return Order;
+}
+
+static int
+EmitSeparate(struct Symtab const *Symtabs, struct ModuleDataGroup *Modules)
+{
+	// writes a header declaring the public interface of each module, a source
+	// file defining everything else and a make dependency file. files are
+	// only rewritten when their contents change, so that an unchanged
+	// interface does not trigger rebuilds of its importers.
+	
+	struct EmitState Es =
+	{
+		.Out.File = Ctx->Conf.OutDir,
+		.Symtabs = Symtabs,
+		.Modules = Modules
+	};
+	
+	unsigned char **Marks = malloc(Modules->ModuleCnt * sizeof(unsigned char *));
+	for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+		Marks[i] = malloc(Modules->Modules[i].Ast.NodeCnt);
+	
+	bool *Seen = malloc(Modules->ModuleCnt * sizeof(bool));
+	size_t *Stack = malloc(Modules->ModuleCnt * sizeof(size_t));
+	
+	int Rc = 0;
+	for (size_t i = 0; i < Modules->ModuleCnt && !Rc; ++i)
+	{
+		uint64_t Begin = GetTimeNs();
+		struct ModuleData *Mod = &Modules->Modules[i];
+		struct FlatAst const *Ast = &Mod->Ast;
+		char *Stem = EmitStem(Mod);
+		
+		char *Path;
+		size_t PathLen;
+		DynStr_Init(&Path, &PathLen);
+		DynStr_AppendStr(&Path, &PathLen, Ctx->Conf.OutDir);
+		if (Path[PathLen - 1] != '/')
+			DynStr_AppendChar(&Path, &PathLen, '/');
+		DynStr_AppendStr(&Path, &PathLen, Stem);
+		DynStr_AppendStr(&Path, &PathLen, ".h");
+		
+		// find the modules this one depends on, through its imports.
+		size_t StackCnt = 0;
+		memset(Seen, 0, Modules->ModuleCnt * sizeof(bool));
+		Seen[i] = true;
+		Stack[StackCnt++] = i;
+		for (size_t j = 0; j < StackCnt; ++j)
+		{
+			struct FlatAst const *DepAst = &Modules->Modules[Stack[j]].Ast;
+			for (uint32_t Child = DepAst->Nodes[0].FirstChild; Child; Child = DepAst->Nodes[Child].NextSibling)
+			{
+				if (DepAst->Nodes[Child].Type != ANT_IMPORT)
+					continue;
+				
+				char *Name = ImportPath(DepAst, Child);
+				for (size_t k = 1; k < Modules->ModuleCnt; ++k)
+				{
+					if (!Seen[k] && !strcmp(Modules->Modules[k].ImportName, Name))
+					{
+						Seen[k] = true;
+						Stack[StackCnt++] = k;
+					}
+				}
+				free(Name);
+			}
+		}
+		
+		// types of other modules are defined by their own headers.
+		for (size_t j = 0; j < Modules->ModuleCnt; ++j)
+			memset(Marks[j], j != i, Modules->Modules[j].Ast.NodeCnt);
+		
+		// write header, holding public declarations along with the private
+		// types they contain.
+		{
+			Emitter_Str(&Es.Out, "// generated by lithic from ");
+			Emitter_Str(&Es.Out, Mod->File.Name);
+			Emitter_Str(&Es.Out, ".\n\n#ifndef lc_Header_");
+			for (char const *c = Stem; *c; ++c)
+				Emitter_Char(&Es.Out, isalnum(*c) ? *c : '_');
+			Emitter_Str(&Es.Out, "\n#define lc_Header_");
+			for (char const *c = Stem; *c; ++c)
+				Emitter_Char(&Es.Out, isalnum(*c) ? *c : '_');
+			Emitter_Str(&Es.Out, "\n\n");
+			EmitPrelude(&Es);
+			
+			bool Any = false;
+			for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+			{
+				if (Ast->Nodes[Child].Type != ANT_IMPORT)
+					continue;
+				
+				char *Name = ImportPath(Ast, Child);
+				for (size_t j = 1; j < Modules->ModuleCnt; ++j)
+				{
+					if (strcmp(Modules->Modules[j].ImportName, Name))
+						continue;
+					
+					char *ImportStem = EmitStem(&Modules->Modules[j]);
+					Emitter_Str(&Es.Out, Any ? "#include \"" : "\n#include \"");
+					Emitter_Str(&Es.Out, ImportStem);
+					Emitter_Str(&Es.Out, ".h\"\n");
+					Any = true;
+					free(ImportStem);
+				}
+				free(Name);
+			}
+			
+			Any = false;
+			EmitTypeNames(&Es, Mod, &Any);
+			Rc = EmitTypeDecls(&Es, Mod, EV_PUBLIC, Marks);
+			
+			Emitter_Char(&Es.Out, '\n');
+			Rc = Rc || EmitProcHeads(&Es, Mod, EV_PUBLIC);
+			
+			Any = false;
+			Rc = Rc || EmitGlobalVars(&Es, Mod, EV_PUBLIC, false, &Any);
+			
+			Emitter_Str(&Es.Out, "\n#endif\n");
+			Rc = Rc || Emitter_Save(&Es.Out, Path);
+		}
+		
+		// write source, unless the module only has its interface.
+		if (!Rc && !Mod->Interface)
+		{
+			Path[PathLen - 1] = 'c';
+			
+			Emitter_Str(&Es.Out, "// generated by lithic from ");
+			Emitter_Str(&Es.Out, Mod->File.Name);
+			Emitter_Str(&Es.Out, ".\n\n#include \"");
+			Emitter_Str(&Es.Out, Stem);
+			Emitter_Str(&Es.Out, ".h\"\n");
+			
+			Rc = EmitTypeDecls(&Es, Mod, EV_PRIVATE, Marks);
+			
+			Emitter_Char(&Es.Out, '\n');
+			Rc = Rc || EmitProcHeads(&Es, Mod, EV_PRIVATE);
+			
+			bool Any = false;
+			Rc = Rc || EmitGlobalVars(&Es, Mod, EV_ALL, true, &Any);
+			
+			struct DepGraph Graph = {0};
+			uint32_t *Order = EmitProcOrder(&Es, i, 1, &Graph);
+			for (size_t j = 0; j < Graph.NodeCnt && !Rc; ++j)
+			{
+				EmitSetModule(&Es, Mod);
+				Rc = EmitProc(&Es, Graph.Nodes[Order[j]].DeclNode);
+			}
+			free(Order);
+			DepGraph_Destroy(&Graph);
+			
+			if (!Rc && i == 0)
+				Rc = EmitMain(&Es);
+			
+			Rc = Rc || Emitter_Save(&Es.Out, Path);
+		}
+		
+		// write dependency file, naming the sources of the module and those it
+		// depends on.
+		if (!Rc)
+		{
+			PathLen -= 2;
+			Path[PathLen] = 0;
+			for (size_t j = 0; j < 2; ++j)
+			{
+				if (j && Mod->Interface)
+					break;
+				
+				Emitter_Str(&Es.Out, Path);
+				Emitter_Str(&Es.Out, j ? ".c " : ".h ");
+			}
+			Es.Out.Buf[Es.Out.Len - 1] = ':';
+			
+			for (size_t j = 0; j < StackCnt; ++j)
+			{
+				Emitter_Char(&Es.Out, ' ');
+				Emitter_MakePath(&Es.Out, Modules->Modules[Stack[j]].File.Name);
+			}
+			Emitter_Char(&Es.Out, '\n');
+			
+			// sources get empty rules, so that removing one is no error.
+			for (size_t j = 0; j < StackCnt; ++j)
+			{
+				Emitter_Char(&Es.Out, '\n');
+				Emitter_MakePath(&Es.Out, Modules->Modules[Stack[j]].File.Name);
+				Emitter_Str(&Es.Out, ":\n");
+			}
+			
+			DynStr_AppendStr(&Path, &PathLen, ".d");
+			Rc = Emitter_Save(&Es.Out, Path);
+		}
+		
+		TimeData_AddEvent("emit", Mod->File.Name, Begin, GetTimeNs(), 0);
+		
+		free(Path);
+		free(Stem);
+	}
+	
+	// free allocated memory.
+	{
+		for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+			free(Marks[i]);
+		free(Marks);
+		free(Seen);
+		free(Stack);
+		free(Es.Out.Buf);
+		free(Es.Locals);
+		free(Es.Defers);
+		free(Es.Jumps);
+	}
+	
+	return Rc;
+}
+
+static struct ModuleData *
+EmitSetModule(struct EmitState *Es, struct ModuleData const *Mod)
+{
+	// switches to emitting code of `Mod`, returning the previous module.
+	
+	struct ModuleData *Prev = Es->Mod;
+	Es->Mod = (struct ModuleData *)Mod;
+	Es->Symtab = EmitSymtab(Es, Mod);
+	return Prev;
+}
+
+static int
+EmitStatement(struct EmitState *Es, uint32_t Node)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct FlatAstNode const *Flat = &Ast->Nodes[Node];
+	
+	switch (Flat->Type)
+	{
+	case ANT_EXPR:
+		Emitter_Indent(&Es->Out, Es->Indent);
+		if (EmitExpr(Es, Node, NULL, false))
+			return 1;
+		Emitter_Str(&Es->Out, ";\n");
+		return 0;
+	case ANT_VAR:
+		Emitter_Indent(&Es->Out, Es->Indent);
+		if (EmitVar(Es, Node, false))
+			return 1;
+		Emitter_Str(&Es->Out, ";\n");
+		return 0;
+	case ANT_COND_TREE:
+	{
+		Emitter_Indent(&Es->Out, Es->Indent);
+		for (;;)
+		{
+			uint32_t Cond = Ast->Nodes[Node].FirstChild;
+			uint32_t TruePath = Ast->Nodes[Cond].NextSibling;
+			uint32_t FalsePath = Ast->Nodes[TruePath].NextSibling;
+			
+			Emitter_Str(&Es->Out, "if (");
+			if (EmitExpr(Es, Cond, NULL, false))
+				return 1;
+			Emitter_Str(&Es->Out, ")\n");
+			if (EmitStatementList(Es, TruePath, 0))
+				return 1;
+			
+			if (!FalsePath)
+				return 0;
+			
+			Emitter_Indent(&Es->Out, Es->Indent);
+			Emitter_Str(&Es->Out, "else");
+			
+			if (Ast->Nodes[FalsePath].Type != ANT_COND_TREE)
+			{
+				Emitter_Char(&Es->Out, '\n');
+				return EmitStatementList(Es, FalsePath, 0);
+			}
+			
+			Emitter_Char(&Es->Out, ' ');
+			Node = FalsePath;
+		}
+	}
+	case ANT_FOR:
+	{
+		uint32_t First = Flat->FirstChild;
+		char const *Label = Flat->TokCnt == 2 ? FlatAst_TokenText(Ast, Node, 1) : NULL;
+		size_t LocalCnt = Es->LocalCnt;
+		
+		Emitter_Indent(&Es->Out, Es->Indent);
+		uint32_t Body;
+		if (Flat->ChildCnt == 4)
+		{
+			uint32_t Cond = Ast->Nodes[First].NextSibling;
+			uint32_t Inc = Ast->Nodes[Cond].NextSibling;
+			Body = Ast->Nodes[Inc].NextSibling;
+			
+			Emitter_Str(&Es->Out, "for (");
+			if (Ast->Nodes[First].Type == ANT_VAR ? EmitVar(Es, First, false) : EmitExpr(Es, First, NULL, false))
+				return 1;
+			Emitter_Str(&Es->Out, "; ");
+			if (EmitExpr(Es, Cond, NULL, false))
+				return 1;
+			Emitter_Str(&Es->Out, "; ");
+			if (EmitExpr(Es, Inc, NULL, false))
+				return 1;
+			Emitter_Str(&Es->Out, ")\n");
+		}
+		else
+		{
+			Body = Ast->Nodes[First].NextSibling;
+			Emitter_Str(&Es->Out, "while (");
+			if (EmitExpr(Es, First, NULL, false))
+				return 1;
+			Emitter_Str(&Es->Out, ")\n");
+		}
+		
+		EmitJump_Push(Es, Node, Label, true);
+		int Rc = EmitStatementList(Es, Body, Node);
+		EmitJump_Pop(Es);
+		
+		Es->LocalCnt = LocalCnt;
+		return Rc;
+	}
+	case ANT_BREAK:
+	case ANT_CONTINUE:
+		return EmitJump(Es, Node);
+	case ANT_BLOCK:
+	{
+		char const *Label = Flat->TokCnt == 2 ? FlatAst_TokenText(Ast, Node, 1) : NULL;
+		EmitJump_Push(Es, Node, Label, false);
+		int Rc = EmitStatementList(Es, Flat->FirstChild, 0);
+		EmitJump_Pop(Es);
+		return Rc;
+	}
+	case ANT_SWITCH:
+	{
+		if (EmitCaseCheck(Es, Node))
+			return 1;
+		
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "switch (");
+		if (EmitExpr(Es, Flat->FirstChild, NULL, false))
+			return 1;
+		Emitter_Str(&Es->Out, ")\n");
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "{\n");
+		
+		++Es->SwitchDepth;
+		for (uint32_t Case = Ast->Nodes[Flat->FirstChild].NextSibling; Case; Case = Ast->Nodes[Case].NextSibling)
+		{
+			// every case has a list of values, and the base case comes last.
+			uint32_t Body = Case;
+			if (Ast->Nodes[Case].Type == ANT_CASE)
+			{
+				uint32_t Matches = Ast->Nodes[Ast->Nodes[Case].FirstChild].FirstChild;
+				Body = Ast->Nodes[Ast->Nodes[Case].FirstChild].NextSibling;
+				
+				uint32_t Match = Matches;
+				if (Ast->Nodes[Matches].Type == ANT_EXPR_LIST)
+					Match = Ast->Nodes[Matches].FirstChild;
+				
+				for (; Match; Match = Ast->Nodes[Matches].Type == ANT_EXPR_LIST ? Ast->Nodes[Match].NextSibling : 0)
+				{
+					Emitter_Indent(&Es->Out, Es->Indent);
+					Emitter_Str(&Es->Out, "case ");
+					
+					// labels are written folded, though enum members are kept
+					// by name.
+					uint32_t Label = Match;
+					while (Ast->Nodes[Label].Type == ANT_EXPR)
+						Label = Ast->Nodes[Label].FirstChild;
+					
+					bool Folded = false;
+					if (Ast->Nodes[Label].Type != ANT_EXPR_TYPE_ACCESS && EmitConstExpr(Es, Match, &Folded))
+						return 1;
+					if (!Folded && EmitExpr(Es, Match, NULL, false))
+						return 1;
+					Emitter_Str(&Es->Out, ":\n");
+				}
+			}
+			else
+			{
+				Emitter_Indent(&Es->Out, Es->Indent);
+				Emitter_Str(&Es->Out, "default:\n");
+			}
+			
+			++Es->Indent;
+			if (EmitStatementList(Es, Body, 0))
+				return 1;
+			Emitter_Indent(&Es->Out, Es->Indent);
+			Emitter_Str(&Es->Out, "break;\n");
+			--Es->Indent;
+		}
+		--Es->SwitchDepth;
+		
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "}\n");
+		return 0;
+	}
+	case ANT_RETURN:
+	{
+		uint32_t RetType = Ast->Nodes[Ast->Nodes[Es->Proc].FirstChild].NextSibling;
+		bool RetNull = FlatAst_Token(Ast, Ast->Nodes[RetType].FirstChild, 0)->Type == TT_KW_NULL;
+		struct EmitType Expect = {.Mod = Es->Mod, .Node = RetType};
+		
+		// values are computed before deferred statements run.
+		if (Flat->FirstChild && !RetNull && Es->DeferCnt)
+		{
+			Emitter_Indent(&Es->Out, Es->Indent++);
+			Emitter_Str(&Es->Out, "{\n");
+			Emitter_Indent(&Es->Out, Es->Indent);
+			if (EmitDecl(Es, Es->Mod, RetType, "lc_Ret"))
+				return 1;
+			Emitter_Str(&Es->Out, " = ");
+			if (EmitExpr(Es, Flat->FirstChild, &Expect, false))
+				return 1;
+			Emitter_Str(&Es->Out, ";\n");
+			
+			if (EmitDefers(Es, 0))
+				return 1;
+			Emitter_Indent(&Es->Out, Es->Indent--);
+			Emitter_Str(&Es->Out, "return lc_Ret;\n");
+			Emitter_Indent(&Es->Out, Es->Indent);
+			Emitter_Str(&Es->Out, "}\n");
+			return 0;
+		}
+		
+		if (EmitDefers(Es, 0))
+			return 1;
+		Emitter_Indent(&Es->Out, Es->Indent);
+		if (Flat->FirstChild && !RetNull)
+		{
+			Emitter_Str(&Es->Out, "return ");
+			if (EmitExpr(Es, Flat->FirstChild, &Expect, false))
+				return 1;
+			Emitter_Str(&Es->Out, ";\n");
+		}
+		else
+			Emitter_Str(&Es->Out, "return;\n");
+		
+		return 0;
+	}
+	case ANT_RESET_VARGS:
+		if (EmitVariadicCheck(Es, Node))
+			return 1;
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "va_end(lc_Args);\n");
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "va_start(lc_Args, ");
+		EmitVariadicLast(Es);
+		Emitter_Str(&Es->Out, ");\n");
+		return 0;
+	case ANT_DEFER:
+		EmitDefer_Add(Es, Flat->FirstChild);
+		return 0;
+	default:
+		LogAstNodeErr(Es->Mod, Node, "cannot emit statement!");
+		return 1;
+	}
+}
+
+static int
+EmitStatementList(struct EmitState *Es, uint32_t Node, uint32_t Loop)
+{
+	// statements of `Loop`'s body are followed by its continue label if any
+	// jump needs it.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	size_t LocalCnt = Es->LocalCnt, DeferCnt = Es->DeferCnt;
+	
+	Emitter_Indent(&Es->Out, Es->Indent);
+	Emitter_Str(&Es->Out, "{\n");
+	++Es->Indent;
+	
+	uint32_t Last = 0;
+	for (uint32_t Stmt = Ast->Nodes[Node].FirstChild; Stmt; Stmt = Ast->Nodes[Stmt].NextSibling)
+	{
+		if (EmitStatement(Es, Stmt))
+			return 1;
+		Last = Stmt;
+	}
+	
+	// deferred statements are unreachable after a jump.
+	unsigned char LastType = Last ? Ast->Nodes[Last].Type : ANT_STATEMENT_LIST;
+	if (LastType != ANT_RETURN && LastType != ANT_BREAK && LastType != ANT_CONTINUE)
+	{
+		if (EmitDefers(Es, DeferCnt))
+			return 1;
+	}
+	
+	if (Loop && Es->Jumps[Es->JumpCnt - 1].ContinueUsed)
+	{
+		Emitter_Indent(&Es->Out, Es->Indent);
+		Emitter_Str(&Es->Out, "lc_Continue");
+		Emitter_Uint(&Es->Out, Loop);
+		Emitter_Str(&Es->Out, ":;\n");
+	}
+	
+	--Es->Indent;
+	Emitter_Indent(&Es->Out, Es->Indent);
+	Emitter_Str(&Es->Out, "}\n");
+	
+	Es->LocalCnt = LocalCnt;
+	Es->DeferCnt = DeferCnt;
+	
+	return 0;
+}
+
+static char *
+EmitStem(struct ModuleData const *Mod)
+{
+	// names the output files of a module after its import path, or after its
+	// source file for the main module.
+	
+	if (Mod->ImportName)
+	{
+		char *Stem = strdup(Mod->ImportName);
+		for (char *c = Stem; *c; ++c)
+		{
+			if (*c == '/')
+				*c = '.';
+		}
+		return Stem;
+	}
+	
+	char const *Base = strrchr(Mod->File.Name, '/');
+	Base = Base ? Base + 1 : Mod->File.Name;
+	
+	size_t Len = strlen(Base);
+	if (Len > 3 && !strcmp(&Base[Len - 3], ".lc"))
+		Len -= 3;
+	
+	char *Stem = malloc(Len + 1);
+	memcpy(Stem, Base, Len);
+	Stem[Len] = 0;
+	return Stem;
+}
+
+static void
+EmitStrLit(struct EmitState *Es, char const *Str, size_t Len)
+{
+	// octal escapes never run on into following digits, unlike hexadecimal
+	// ones, and escaping question marks rules out trigraphs.
+	Emitter_Reserve(&Es->Out, 4 * Len + 2);
+	char *Out = &Es->Out.Buf[Es->Out.Len];
+	
+	*Out++ = '"';
+	for (size_t i = 0; i < Len; ++i)
+	{
+		unsigned char Ch = Str[i];
+		switch (Ch)
+		{
+		case '"':
+		case '\\':
+		case '?':
+			*Out++ = '\\';
+			*Out++ = Ch;
+			break;
+		case '\n':
+			*Out++ = '\\';
+			*Out++ = 'n';
+			break;
+		case '\t':
+			*Out++ = '\\';
+			*Out++ = 't';
+			break;
+		default:
+			if (Ch >= 0x20 && Ch < 0x7f)
+				*Out++ = Ch;
+			else
+			{
+				*Out++ = '\\';
+				*Out++ = '0' + (Ch >> 6);
+				*Out++ = '0' + (Ch >> 3 & 7);
+				*Out++ = '0' + (Ch & 7);
+			}
+			break;
+		}
+	}
+	*Out++ = '"';
+	
+	Es->Out.Len = Out - Es->Out.Buf;
+}
+
+static struct Symtab const *
+EmitSymtab(struct EmitState const *Es, struct ModuleData const *Mod)
+{
+	return &Es->Symtabs[Mod - Es->Modules->Modules];
+}
+
+static int
+EmitTypeDecl(struct EmitState *Es, struct ModuleData const *Mod, uint32_t Node, unsigned char **Marks)
+{
+	// `Marks` records which types have been defined, by module and node
+	// index. types contained by value are defined first, which terminates as
+	// cycles have already been ruled out.
+	
+	size_t Ind = Mod - Es->Modules->Modules;
+	if (Marks[Ind][Node])
+		return 0;
+	Marks[Ind][Node] = 1;
+	
+	struct ModuleData *PrevMod = EmitSetModule(Es, Mod);
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	int Rc = 0;
+	
+	if (Ast->Nodes[Node].Type == ANT_ENUM)
+	{
+		// members are macros so that they remain usable as case labels, with
+		// their values folded where known.
+		uint32_t Base = Ast->Nodes[Node].FirstChild;
+		uint32_t Prev = 0;
+		
+		Emitter_Char(&Es->Out, '\n');
+		for (uint32_t Memb = Ast->Nodes[Base].NextSibling; Memb && !Rc; Memb = Ast->Nodes[Memb].NextSibling)
+		{
+			Emitter_Str(&Es->Out, "#define ");
+			EmitDeclName(Es, Mod, Node);
+			Emitter_Char(&Es->Out, '_');
+			Emitter_Str(&Es->Out, FlatAst_TokenText(Ast, Memb, 0));
+			Emitter_Str(&Es->Out, " ((");
+			Rc = EmitDecl(Es, Es->Mod, Base, NULL);
+			Emitter_Str(&Es->Out, ")");
+			
+			struct ConstEval Ce = {.Mod = Mod};
+			struct ConstVal Val = {0};
+			if (!Rc)
+				Rc = ConstEval_Member(&Ce, Mod, Node, Memb, &Val);
+			
+			if (Val.Type)
+				EmitConstVal(Es, &Val, true);
+			else if (Ast->Nodes[Memb].ChildCnt)
+				Rc = Rc || EmitExpr(Es, Ast->Nodes[Memb].FirstChild, NULL, true);
+			else if (Prev)
+			{
+				Emitter_Char(&Es->Out, '(');
+				EmitDeclName(Es, Mod, Node);
+				Emitter_Char(&Es->Out, '_');
+				Emitter_Str(&Es->Out, FlatAst_TokenText(Ast, Prev, 0));
+				Emitter_Str(&Es->Out, " + 1)");
+			}
+			else
+				Emitter_Char(&Es->Out, '0');
+			
+			Emitter_Str(&Es->Out, ")\n");
+			Prev = Memb;
+		}
+	}
+	else
+	{
+		for (uint32_t Memb = Ast->Nodes[Node].FirstChild; Memb && !Rc; Memb = Ast->Nodes[Memb].NextSibling)
+		{
+			uint32_t Base = GetSizeBaseType(Ast, Ast->Nodes[Memb].FirstChild);
+			if (!Base || Ast->Nodes[Base].Type != ANT_TYPE_ATOM)
+				continue;
+			
+			char const *BaseName = FlatAst_TokenText(Ast, Base, 0);
+			struct SymtabEntry const *BaseEnt = BaseName ? Symtab_SearchTypes(Es->Symtab, BaseName) : NULL;
+			if (BaseEnt)
+				Rc = EmitTypeDecl(Es, BaseEnt->DeclMod, BaseEnt->DeclNode, Marks);
+		}
+		
+		Emitter_Str(&Es->Out, Ast->Nodes[Node].Type == ANT_STRUCT ? "\nstruct " : "\nunion ");
+		EmitDeclName(Es, Mod, Node);
+		Emitter_Str(&Es->Out, "\n{\n");
+		for (uint32_t Memb = Ast->Nodes[Node].FirstChild; Memb && !Rc; Memb = Ast->Nodes[Memb].NextSibling)
+		{
+			Emitter_Char(&Es->Out, '\t');
+			Rc = EmitDeclPrefix(Es, Es->Mod, Ast->Nodes[Memb].FirstChild);
+			
+			char Last = Es->Out.Buf[Es->Out.Len - 1];
+			if (isalnum(Last) || Last == '_')
+				Emitter_Char(&Es->Out, ' ');
+			EmitIdent(Es, FlatAst_TokenText(Ast, Memb, 0));
+			
+			Rc = Rc || EmitDeclSuffix(Es, Es->Mod, Ast->Nodes[Memb].FirstChild);
+			Emitter_Str(&Es->Out, ";\n");
+		}
+		Emitter_Str(&Es->Out, "};\n");
+	}
+	
+	EmitSetModule(Es, PrevMod);
+	return Rc || Emitter_Flush(&Es->Out, false);
+}
+
+static int
+EmitTypeDecls(
+	struct EmitState *Es,
+	struct ModuleData const *Mod,
+	unsigned char Vis,
+	unsigned char **Marks
+)
+{
+	struct FlatAst const *Ast = &Mod->Ast;
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+	{
+		unsigned char Type = Ast->Nodes[Child].Type;
+		if (Type != ANT_STRUCT && Type != ANT_UNION && Type != ANT_ENUM)
+			continue;
+		if (!ModuleData_IsLive(Mod, Child))
+			continue;
+		if (!(Vis & (Ast->Nodes[Child].Flags & ANF_PUBLIC ? EV_PUBLIC : EV_PRIVATE)))
+			continue;
+		
+		if (EmitTypeDecl(Es, Mod, Child, Marks))
+			return 1;
+	}
+	
+	return 0;
+}
+
+static struct EmitType
+EmitTypeDeref(struct EmitType const *Type)
+{
+	struct EmitType Out = *Type;
+	EmitTypeStrip(&Out);
+	
+	if (Out.Ref)
+		--Out.Ref;
+	else if (Out.Node && Out.Mod->Ast.Nodes[Out.Node].Type == ANT_TYPE_PTR)
+		Out.Node = Out.Mod->Ast.Nodes[Out.Node].FirstChild;
+	else
+		Out.Node = 0;
+	
+	return Out;
+}
+
+static void
+EmitTypeNames(struct EmitState *Es, struct ModuleData const *Mod, bool *Any)
+{
+	// forward declares the module's structs and unions, private ones too as
+	// public declarations may point to them.
+	
+	struct FlatAst const *Ast = &Mod->Ast;
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+	{
+		unsigned char Type = Ast->Nodes[Child].Type;
+		if ((Type != ANT_STRUCT && Type != ANT_UNION) || !ModuleData_IsLive(Mod, Child))
+			continue;
+		
+		if (!*Any)
+			Emitter_Char(&Es->Out, '\n');
+		*Any = true;
+		
+		Emitter_Str(&Es->Out, Type == ANT_STRUCT ? "struct " : "union ");
+		EmitDeclName(Es, Mod, Child);
+		Emitter_Str(&Es->Out, ";\n");
+	}
+}
+
+static struct SymtabEntry const *
+EmitTypeEntry(struct EmitState const *Es, struct EmitType const *Type)
+{
+	// finds the declaration of a named type.
+	
+	struct EmitType Stripped = *Type;
+	EmitTypeStrip(&Stripped);
+	if (!Stripped.Node || Stripped.Ref)
+		return NULL;
+	
+	// names are resolved in the module the type is written in.
+	struct FlatAst const *Ast = &Stripped.Mod->Ast;
+	struct Symtab const *Symtab = EmitSymtab(Es, Stripped.Mod);
+	switch (Ast->Nodes[Stripped.Node].Type)
+	{
+	case ANT_TYPE_ATOM:
+	{
+		struct Token const *Tok = FlatAst_Token(Ast, Stripped.Node, 0);
+		if (Tok->Type == TT_IDENT)
+			return Symtab_SearchTypes(Symtab, LexData_Text(&Ast->Lex, Tok));
+		if (Tok->Type == TT_KW_SELF && Es->SelfName)
+			return Symtab_SearchTypes(Symtab, Es->SelfName);
+		return NULL;
+	}
+	case ANT_EXPR_STRUCT:
+	case ANT_EXPR_UNION:
+		return Symtab_SearchTypes(Symtab, FlatAst_TokenText(Ast, Stripped.Node, 1));
+	default:
+		return NULL;
+	}
+}
+
+static int
+EmitTypeLiteral(struct EmitState *Es, uint32_t Node)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	struct SymtabEntry const *Ent = Symtab_SearchTypes(Es->Symtab, FlatAst_TokenText(Ast, Node, 1));
+	unsigned char Want = Ast->Nodes[Node].Type == ANT_EXPR_STRUCT ? SET_STRUCT : SET_UNION;
+	if (!Ent || Ent->Type != Want)
+	{
+		LogAstNodeErr(Es->Mod, Node, "use of unrecognized type!");
+		return 1;
+	}
+	
+	// compound literals are not constant, so global initializers are plain
+	// brace-enclosed lists, as are the literals nested within them.
+	bool Static = !Es->Proc;
+	if (Static)
+		Emitter_Char(&Es->Out, '{');
+	else
+	{
+		Emitter_Str(&Es->Out, Want == SET_STRUCT ? "((struct " : "((union ");
+		EmitDeclName(Es, Ent->DeclMod, Ent->DeclNode);
+		Emitter_Str(&Es->Out, "){");
+	}
+	
+	for (uint32_t Memb = Ast->Nodes[Node].FirstChild; Memb; Memb = Ast->Nodes[Memb].NextSibling)
+	{
+		// follow the member path to find the type of the value.
+		struct SymtabEntry const *PathEnt = Ent;
+		struct EmitType Expect = {0};
+		for (size_t i = 0; i < Ast->Nodes[Memb].TokCnt; ++i)
+		{
+			char const *Name = FlatAst_TokenText(Ast, Memb, i);
+			uint32_t Found = PathEnt ? EmitFindMember(PathEnt, Name) : 0;
+			if (!Found)
+			{
+				LogAstNodeErr(Es->Mod, Memb, "no such member!");
+				return 1;
+			}
+			
+			Expect = (struct EmitType){.Mod = PathEnt->DeclMod, .Node = PathEnt->DeclMod->Ast.Nodes[Found].FirstChild};
+			PathEnt = EmitTypeEntry(Es, &Expect);
+			
+			Emitter_Char(&Es->Out, '.');
+			EmitIdent(Es, Name);
+		}
+		
+		Emitter_Str(&Es->Out, " = ");
+		if (EmitExpr(Es, Ast->Nodes[Memb].FirstChild, &Expect, false))
+			return 1;
+		if (Ast->Nodes[Memb].NextSibling)
+			Emitter_Str(&Es->Out, ", ");
+	}
+	
+	Emitter_Str(&Es->Out, Static ? "}" : "})");
+	return 0;
+}
+
+static struct EmitType
+EmitTypeOf(struct EmitState const *Es, uint32_t Node)
+{
+	// finds the type of an expression as far as emission depends on it, the
+	// result is unknown where its node is zero.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	uint32_t Lhs = Ast->Nodes[Node].FirstChild;
+	uint32_t Rhs = Lhs ? Ast->Nodes[Lhs].NextSibling : 0;
+	
+	switch (Ast->Nodes[Node].Type)
+	{
+	case ANT_EXPR:
+		return EmitTypeOf(Es, Lhs);
+	case ANT_EXPR_ATOM:
+	{
+		struct Token const *Tok = FlatAst_Token(Ast, Node, 0);
+		if (Tok->Type != TT_IDENT && Tok->Type != TT_KW_SELF)
+			return (struct EmitType){0};
+		
+		char const *Name = LexData_Text(&Ast->Lex, Tok);
+		struct EmitLocal const *Local = EmitFindLocal(Es, Name);
+		if (Local)
+			return (struct EmitType){.Mod = Local->Mod, .Node = Local->Type};
+		
+		struct SymtabEntry const *Ent = Name ? Symtab_SearchValues(Es->Symtab, Name, NULL) : NULL;
+		if (Ent && Ent->Type == SET_VAR)
+			return (struct EmitType){.Mod = Ent->DeclMod, .Node = Ent->DeclMod->Ast.Nodes[Ent->DeclNode].FirstChild};
+		
+		return (struct EmitType){0};
+	}
+	case ANT_EXPR_ACCESS:
+	{
+		struct EmitType LhsType = EmitTypeOf(Es, Lhs);
+		struct SymtabEntry const *Ent = EmitTypeEntry(Es, &LhsType);
+		if (!Ent)
+		{
+			struct EmitType Pointee = EmitTypeDeref(&LhsType);
+			Ent = EmitTypeEntry(Es, &Pointee);
+		}
+		
+		uint32_t Memb = Ent ? EmitFindMember(Ent, FlatAst_TokenText(Ast, Rhs, 0)) : 0;
+		if (!Memb)
+			return (struct EmitType){0};
+		return (struct EmitType){.Mod = Ent->DeclMod, .Node = Ent->DeclMod->Ast.Nodes[Memb].FirstChild};
+	}
+	case ANT_EXPR_DEREF:
+	{
+		struct EmitType Type = EmitTypeOf(Es, Lhs);
+		return EmitTypeDeref(&Type);
+	}
+	case ANT_EXPR_ADDR_OF:
+	{
+		struct EmitType Type = EmitTypeOf(Es, Lhs);
+		if (Type.Node)
+			++Type.Ref;
+		return Type;
+	}
+	case ANT_EXPR_NTH:
+	{
+		struct EmitType Type = EmitTypeOf(Es, Lhs);
+		EmitTypeStrip(&Type);
+		if (!Type.Node || Type.Ref)
+			return (struct EmitType){0};
+		
+		switch (Type.Mod->Ast.Nodes[Type.Node].Type)
+		{
+		case ANT_TYPE_ARRAY:
+		case ANT_TYPE_BUFFER:
+		case ANT_TYPE_PTR:
+			Type.Node = Type.Mod->Ast.Nodes[Type.Node].FirstChild;
+			return Type;
+		default:
+			return (struct EmitType){0};
+		}
+	}
+	case ANT_EXPR_CALL:
+	{
+		// procedures declare their return type after their argument list.
+		struct SymtabEntry const *Proc = NULL;
+		switch (Ast->Nodes[Lhs].Type)
+		{
+		case ANT_EXPR_ATOM:
+		{
+			char const *Name = FlatAst_TokenText(Ast, Lhs, 0);
+			if (Name && !EmitFindLocal(Es, Name))
+				Proc = Symtab_SearchValues(Es->Symtab, Name, NULL);
+			break;
+		}
+		case ANT_EXPR_TYPE_ACCESS:
+		{
+			uint32_t Type = Ast->Nodes[Lhs].FirstChild;
+			uint32_t Method = Ast->Nodes[Type].NextSibling;
+			Proc = Symtab_SearchValues(
+				Es->Symtab,
+				FlatAst_TokenText(Ast, Method, 0),
+				FlatAst_TokenText(Ast, Type, 0)
+			);
+			break;
+		}
+		case ANT_EXPR_ACCESS:
+		{
+			uint32_t Recv = Ast->Nodes[Lhs].FirstChild;
+			char const *Name = FlatAst_TokenText(Ast, Ast->Nodes[Recv].NextSibling, 0);
+			
+			struct EmitType RecvType = EmitTypeOf(Es, Recv);
+			struct SymtabEntry const *Ent = EmitTypeEntry(Es, &RecvType);
+			if (!Ent)
+			{
+				struct EmitType Pointee = EmitTypeDeref(&RecvType);
+				Ent = EmitTypeEntry(Es, &Pointee);
+			}
+			
+			if (Ent && !EmitFindMember(Ent, Name))
+				Proc = Symtab_SearchValues(Es->Symtab, Name, Ent->Name);
+			break;
+		}
+		default:
+			break;
+		}
+		
+		if (Proc && Proc->Type == SET_PROC)
+		{
+			struct FlatAst const *ProcAst = &Proc->DeclMod->Ast;
+			uint32_t Args = ProcAst->Nodes[Proc->DeclNode].FirstChild;
+			return (struct EmitType){.Mod = Proc->DeclMod, .Node = ProcAst->Nodes[Args].NextSibling};
+		}
+		
+		struct EmitType Type = EmitTypeOf(Es, Lhs);
+		EmitTypeStrip(&Type);
+		if (!Type.Node || Type.Ref || Type.Mod->Ast.Nodes[Type.Node].Type != ANT_TYPE_PROC)
+			return (struct EmitType){0};
+		
+		Type.Node = Type.Mod->Ast.Nodes[Type.Node].FirstChild;
+		return Type;
+	}
+	case ANT_EXPR_CAST:
+		return (struct EmitType){.Mod = Es->Mod, .Node = Rhs};
+	case ANT_EXPR_NULL:
+	case ANT_EXPR_NEXTVARG:
+		return (struct EmitType){.Mod = Es->Mod, .Node = Lhs};
+	case ANT_EXPR_STRUCT:
+	case ANT_EXPR_UNION:
+		return (struct EmitType){.Mod = Es->Mod, .Node = Node};
+	case ANT_EXPR_TERNARY:
+		return EmitTypeOf(Es, Rhs);
+	case ANT_EXPR_POST_INC:
+	case ANT_EXPR_POST_DEC:
+	case ANT_EXPR_PRE_INC:
+	case ANT_EXPR_PRE_DEC:
+	case ANT_EXPR_UNARY_MINUS:
+	case ANT_EXPR_BIT_NOT:
+	case ANT_EXPR_MUL:
+	case ANT_EXPR_DIV:
+	case ANT_EXPR_MOD:
+	case ANT_EXPR_ADD:
+	case ANT_EXPR_SUB:
+	case ANT_EXPR_SHR:
+	case ANT_EXPR_SHL:
+	case ANT_EXPR_BIT_AND:
+	case ANT_EXPR_BIT_XOR:
+	case ANT_EXPR_BIT_OR:
+	case ANT_EXPR_ASSIGN:
+	case ANT_EXPR_ADD_ASSIGN:
+	case ANT_EXPR_SUB_ASSIGN:
+	case ANT_EXPR_MUL_ASSIGN:
+	case ANT_EXPR_DIV_ASSIGN:
+	case ANT_EXPR_MOD_ASSIGN:
+	case ANT_EXPR_SHR_ASSIGN:
+	case ANT_EXPR_SHL_ASSIGN:
+	case ANT_EXPR_BIT_AND_ASSIGN:
+	case ANT_EXPR_BIT_XOR_ASSIGN:
+	case ANT_EXPR_BIT_OR_ASSIGN:
+		return EmitTypeOf(Es, Lhs);
+	default:
+		return (struct EmitType){0};
+	}
+}
+
+static void
+EmitTypeStrip(struct EmitType *Type)
+{
+	while (Type->Node && Type->Mod->Ast.Nodes[Type->Node].Type == ANT_TYPE)
+		Type->Node = Type->Mod->Ast.Nodes[Type->Node].FirstChild;
+}
+
+static int
+EmitVar(struct EmitState *Es, uint32_t Node, bool DeclOnly)
+{
+	// writes a variable declaration without its terminator. variables are
+	// only in scope after their initial value.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	uint32_t Type = Ast->Nodes[Node].FirstChild;
+	uint32_t Value = Ast->Nodes[Type].NextSibling;
+	char const *Name = FlatAst_TokenText(Ast, Node, 0);
+	
+	if (EmitDeclPrefix(Es, Es->Mod, Type))
+		return 1;
+	char Last = Es->Out.Buf[Es->Out.Len - 1];
+	if (isalnum(Last) || Last == '_')
+		Emitter_Char(&Es->Out, ' ');
+	if (Es->Proc)
+		EmitIdent(Es, Name);
+	else
+		EmitDeclName(Es, Es->Mod, Node);
+	if (EmitDeclSuffix(Es, Es->Mod, Type))
+		return 1;
+	
+	if (DeclOnly)
+		return 0;
+	
+	// list and string literals initialize arrays and buffers in place, which
+	// also keeps them constant at global scope.
+	struct EmitType Expect = {.Mod = Es->Mod, .Node = Type};
+	EmitTypeStrip(&Expect);
+	unsigned char TypeType = Ast->Nodes[Expect.Node].Type;
+	
+	int Rc = 0;
+	if (Value)
+	{
+		uint32_t Init = Ast->Nodes[Value].FirstChild;
+		unsigned char InitType = Ast->Nodes[Init].Type;
+		bool IsStr = InitType == ANT_EXPR_ATOM && FlatAst_Token(Ast, Init, 0)->Type == TT_LIT_STR;
+		struct EmitType Elem = {.Mod = Es->Mod, .Node = Ast->Nodes[Expect.Node].FirstChild};
+		
+		Emitter_Str(&Es->Out, " = ");
+		if (TypeType == ANT_TYPE_BUFFER && InitType == ANT_EXPR_LIST)
+		{
+			Emitter_Char(&Es->Out, '{');
+			Rc = EmitExprList(Es, Init, &Elem);
+			Emitter_Char(&Es->Out, '}');
+		}
+		else if (TypeType == ANT_TYPE_BUFFER && IsStr)
+		{
+			struct TokenStr const *Str = &Ast->Lex.Strs[FlatAst_Token(Ast, Init, 0)->Payload];
+			EmitStrLit(Es, Str->Text, Str->Len);
+		}
+		else if (TypeType == ANT_TYPE_ARRAY && InitType == ANT_EXPR_LIST)
+		{
+			Emitter_Str(&Es->Out, "{(");
+			Rc = EmitDecl(Es, Es->Mod, Elem.Node, NULL);
+			Emitter_Str(&Es->Out, "[]){");
+			Rc = Rc || EmitExprList(Es, Init, &Elem);
+			Emitter_Str(&Es->Out, "}, ");
+			Emitter_Uint(&Es->Out, Ast->Nodes[Init].ChildCnt);
+			Emitter_Char(&Es->Out, '}');
+		}
+		else
+		{
+			// C only takes other constants in global initializers once
+			// folded.
+			bool Folded = false;
+			if (!Es->Proc)
+				Rc = EmitConstExpr(Es, Value, &Folded);
+			if (!Rc && !Folded)
+				Rc = EmitExpr(Es, Value, &Expect, false);
+		}
+	}
+	else if (Es->Proc)
+	{
+		// locals start out zeroed like globals.
+		struct SymtabEntry const *Ent = EmitTypeEntry(Es, &Expect);
+		bool Aggregate = TypeType == ANT_TYPE_ARRAY || TypeType == ANT_TYPE_BUFFER
+			|| (Ent && (Ent->Type == SET_STRUCT || Ent->Type == SET_UNION));
+		Emitter_Str(&Es->Out, Aggregate ? " = {0}" : " = 0");
+	}
+	
+	if (Es->Proc)
+		EmitLocal_Add(Es, Name, Es->Mod, Type);
+	
+	return Rc;
+}
+
+static int
+EmitVariadicCheck(struct EmitState *Es, uint32_t Node)
+{
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	unsigned char Flags = Es->Proc ? Ast->Nodes[Ast->Nodes[Es->Proc].FirstChild].Flags : 0;
+	if (!(Flags & ANF_VARIADIC))
+	{
+		LogAstNodeErr(Es->Mod, Node, "variadic arguments used outside of variadic procedure!");
+		return 1;
+	}
+	
+	if (Flags & ANF_BASE && Ast->Nodes[Node].Type == ANT_EXPR_VARGCOUNT)
+	{
+		LogAstNodeErr(Es->Mod, Node, "VargCount cannot be used with C-style variadic arguments!");
+		return 1;
+	}
+	
+	return 0;
+}
+
+static void
+EmitVariadicLast(struct EmitState *Es)
+{
+	// names the parameter after which variadic arguments begin.
+	
+	struct FlatAst const *Ast = &Es->Mod->Ast;
+	uint32_t Args = Ast->Nodes[Es->Proc].FirstChild;
+	if (!(Ast->Nodes[Args].Flags & ANF_BASE))
+	{
+		Emitter_Str(&Es->Out, "lc_VargCnt");
+		return;
+	}
+	
+	uint32_t Last = Ast->Nodes[Args].FirstChild;
+	while (Last && Ast->Nodes[Last].NextSibling)
+		Last = Ast->Nodes[Last].NextSibling;
+	
+	char const *Name = Last ? FlatAst_TokenText(Ast, Last, 0) : NULL;
+	if (Name)
+		EmitIdent(Es, Name);
+	else
+		Emitter_Str(&Es->Out, "Self");
+}
+
+static void
+Emitter_Buf(struct Emitter *Out, char const *Buf, size_t Len)
+{
+	Emitter_Reserve(Out, Len);
+	memcpy(&Out->Buf[Out->Len], Buf, Len);
+	Out->Len += Len;
+}
+
+static void
+Emitter_Char(struct Emitter *Out, char Ch)
+{
+	Emitter_Reserve(Out, 1);
+	Out->Buf[Out->Len++] = Ch;
+}
+
+static int
+Emitter_Flush(struct Emitter *Out, bool Force)
+{
+	// output is written out in large blocks, only ever between top-level
+	// declarations so that emission can inspect what it has just written.
+	// output without a file is kept whole for `Emitter_Save`.
+	if (!Out->Fp || !Out->Len || (!Force && Out->Len < EMIT_BLOCK_SIZE))
+		return 0;
+	
+	if (fwrite(Out->Buf, 1, Out->Len, Out->Fp) != Out->Len
+		|| (Force && fflush(Out->Fp)))
+	{
+		LogErr("failed to write output - '%s'!", Out->File);
+		return 1;
+	}
+	
+	Out->Len = 0;
+	return 0;
+}
+
+static void
+Emitter_Indent(struct Emitter *Out, unsigned Depth)
+{
+	Emitter_Reserve(Out, Depth);
+	memset(&Out->Buf[Out->Len], '\t', Depth);
+	Out->Len += Depth;
+}
+
+static void
+Emitter_MakePath(struct Emitter *Out, char const *Path)
+{
+	// writes a path escaped for use in make rules.
+	for (char const *c = Path; *c; ++c)
+	{
+		if (*c == ' ' || *c == '#' || *c == ':')
+			Emitter_Char(Out, '\\');
+		else if (*c == '$')
+			Emitter_Char(Out, '$');
+		Emitter_Char(Out, *c);
+	}
+}
+
+static void
+Emitter_Reserve(struct Emitter *Out, size_t Len)
+{
+	if (Out->Len + Len <= Out->Cap)
+		return;
+	
+	Out->Cap = Out->Cap ? 2 * Out->Cap : 2 * EMIT_BLOCK_SIZE;
+	while (Out->Len + Len > Out->Cap)
+		Out->Cap *= 2;
+	Out->Buf = realloc(Out->Buf, Out->Cap);
+}
+
+static int
+Emitter_Save(struct Emitter *Out, char const *Path)
+{
+	// writes pending output to `Path` and empties it. a file which already
+	// holds the same contents is left untouched, keeping its modification
+	// time for build tools.
+	
+	bool Same = false;
+	int Fd = open(Path, O_RDONLY);
+	if (Fd != -1)
+	{
+		struct stat Stat;
+		if (!fstat(Fd, &Stat) && (uint64_t)Stat.st_size == Out->Len)
+		{
+			char *Old = malloc(Out->Len + 1);
+			Same = !ReadFull(Fd, Old, Out->Len) && !memcmp(Old, Out->Buf, Out->Len);
+			free(Old);
+		}
+		close(Fd);
+	}
+	
+	// replace the file by renaming, so that concurrent builds never see
+	// partial output.
+	int Rc = 0;
+	if (!Same)
+	{
+		size_t TmpLen = strlen(Path) + 8;
+		char *TmpPath = malloc(TmpLen);
+		snprintf(TmpPath, TmpLen, "%s.XXXXXX", Path);
+		
+		Fd = mkstemp(TmpPath);
+		if (Fd == -1)
+			Rc = 1;
+		else
+		{
+			Rc = fchmod(Fd, 0644) || WriteFull(Fd, Out->Buf, Out->Len);
+			Rc = close(Fd) || Rc;
+			Rc = Rc || rename(TmpPath, Path);
+			if (Rc)
+				unlink(TmpPath);
+		}
+		
+		if (Rc)
+			LogErr("failed to write output - '%s'!", Path);
+		free(TmpPath);
+	}
+	
+	Out->Len = 0;
+	return Rc;
+}
+
+static void
+Emitter_Str(struct Emitter *Out, char const *Str)
+{
+	Emitter_Buf(Out, Str, strlen(Str));
+}
+
+static void
+Emitter_Uint(struct Emitter *Out, uint64_t Val)
+{
+	char Buf[20];
+	size_t Len = 0;
+	do
+	{
+		Buf[sizeof(Buf) - ++Len] = '0' + Val % 10;
+		Val /= 10;
+	} while (Val);
+	
+	Emitter_Buf(Out, &Buf[sizeof(Buf) - Len], Len);
+}
+
+static struct Token const *
+ExpectToken(struct ParseState *Ps, enum TokenType Type)
+{
+	struct Token const *Tok = NextToken(Ps);
+	if (!Tok)
+	{
+		LogProgErr(Ps->File, Ps->File->Len, 1, "expected %s at end of file, found nothing!", TokenTypeNames[Type]);
+		return NULL;
+	}
+	
+	if (Tok->Type != Type)
+	{
+		LogTokErr(Ps->File, Tok, "expected %s, found %s!", TokenTypeNames[Type], TokenTypeNames[Tok->Type]);
+		return NULL;
+	}
+	
+	return Tok;
+}
+
+static int
+ExtractImports(struct ModuleDataGroup *Group)
+{
+	// it is the caller's responsibility to clean up `Group`.
+	
+	// the main module is seeded as already loaded, only needing its imports
+	// discovered.
+	struct ModuleLoader Loader =
+	{
+		.Ctx = Ctx,
+		.Lock = PTHREAD_MUTEX_INITIALIZER,
+		.Cond = PTHREAD_COND_INITIALIZER,
+		.Loads = calloc(8, sizeof(struct ModuleLoad)),
+		.LoadCnt = 1,
+		.LoadCap = 8,
+		.Owner = pthread_self()
+	};
+	Loader.Loads[0].Data = Group->Modules[0];
+	
+	// load modules transitively on worker threads, with the calling thread
+	// also taking part.
+	{
+		pthread_t *Workers = calloc(Ctx->Conf.JobCnt, sizeof(pthread_t));
+		size_t WorkerCnt = 0;
+		while (WorkerCnt + 1 < Ctx->Conf.JobCnt)
+		{
+			if (pthread_create(&Workers[WorkerCnt], NULL, ModuleLoader_Work, &Loader))
+				break;
+			++WorkerCnt;
+		}
+		
+		ModuleLoader_Work(&Loader);
+		
+		for (size_t i = 0; i < WorkerCnt; ++i)
+			pthread_join(Workers[i], NULL);
+		free(Workers);
+	}
+	
+	// merge modules in breadth-first import order so that the result does not
+	// depend on thread scheduling.
+	if (!Loader.Failed)
+	{
+		size_t *Order = malloc(Loader.LoadCnt * sizeof(size_t));
+		bool *Seen = calloc(Loader.LoadCnt, sizeof(bool));
+		
+		size_t OrderCnt = 1;
+		Order[0] = 0;
+		Seen[0] = true;
+		for (size_t i = 0; i < OrderCnt; ++i)
+		{
+			struct ModuleLoad const *Load = &Loader.Loads[Order[i]];
+			for (size_t j = 0; j < Load->ImportCnt; ++j)
+			{
+				if (!Seen[Load->Imports[j]])
+				{
+					Seen[Load->Imports[j]] = true;
+					Order[OrderCnt++] = Load->Imports[j];
+				}
+			}
+		}
+		
+		for (size_t i = 1; i < OrderCnt; ++i)
+			ModuleDataGroup_Append(Group, &Loader.Loads[Order[i]].Data);
+		
+		free(Seen);
+		free(Order);
+	}
+	
+	// free loader memory, and module data too if nothing was merged.
+	{
+		for (size_t i = 0; i < Loader.LoadCnt; ++i)
+		{
+			struct ModuleLoad *Load = &Loader.Loads[i];
+			if (Loader.Failed && i > 0)
+			{
+				if (Load->Fp)
+					fclose(Load->Fp);
+				free(Load->Src);
+				free(Load->Path);
+				ModuleData_Destroy(&Load->Data);
+			}
+			free(Load->Imports);
+		}
+		
+		free(Loader.Loads);
+		pthread_mutex_destroy(&Loader.Lock);
+		pthread_cond_destroy(&Loader.Cond);
+	}
+	
+	return Loader.Failed;
+}
+
+static void
+FileData_Destroy(struct FileData *Data)
+{
+	// free allocated memory.
+	{
+		free(Data->Name);
+		free(Data->Lines);
+		if (Data->MapLen)
+			munmap(Data->Data, Data->MapLen);
+		else
+			free(Data->Data);
+	}
+}
+
+static size_t
+FileData_FindLine(struct FileData const *Data, size_t Pos)
+{
+	// binary search for the last line beginning at or before `Pos`.
+	size_t Lo = 0, Hi = Data->LineCnt;
+	while (Hi - Lo > 1)
+	{
+		size_t Mid = Lo + (Hi - Lo) / 2;
+		if (Data->Lines[Mid] <= Pos)
+			Lo = Mid;
+		else
+			Hi = Mid;
+	}
+	
+	return Lo;
+}
+
+static void
+FileData_FromBuf(struct FileData *Out, char const *Name, char *Data, size_t Len)
+{
+	// takes ownership of `Data`, which must be allocated by `malloc`.
+	Out->Name = strdup(Name);
+	Out->Data = realloc(Data, Len + 1);
+	Out->Data[Len] = 0;
+	Out->Len = Len;
+	Out->MapLen = 0;
+	
+	FileData_IndexLines(Out);
+}
+
+static void
+FileData_IndexLines(struct FileData *Data)
+{
+	size_t Cap = 256;
+	Data->Lines = malloc(Cap * sizeof(size_t));
+	Data->Lines[0] = 0;
+	Data->LineCnt = 1;
+	
+	for (size_t i = Scan(Data->Data, Data->Len, 0, SC_NEWLINE); i < Data->Len; i = Scan(Data->Data, Data->Len, i + 1, SC_NEWLINE))
+	{
+		if (Data->LineCnt >= Cap)
+		{
+			Cap *= 2;
+			Data->Lines = realloc(Data->Lines, Cap * sizeof(size_t));
+		}
+		Data->Lines[Data->LineCnt++] = i + 1;
+	}
+}
+
+static int
+FileData_Read(struct FileData *Out, FILE *Fp, char const *File)
+{
+	int Fd = fileno(Fp);
+	
+	struct stat Stat;
+	if (fstat(Fd, &Stat))
+	{
+		LogErr("failed to get size of input file - '%s'!", File);
+		return 1;
+	}
+	
+	Out->Name = strdup(File);
+	
+	// map regular files directly.
+	if (S_ISREG(Stat.st_mode) && Stat.st_size > 0)
+	{
+		// the lexer relies on a null terminator past the end of data, so an
+		// extra zero page is reserved when the file fills its last page.
+		size_t PageSize = sysconf(_SC_PAGESIZE);
+		size_t Len = Stat.st_size;
+		size_t MapLen = (Len + PageSize) / PageSize * PageSize;
+		
+		char *Base = mmap(NULL, MapLen, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (Base == MAP_FAILED)
+		{
+			LogErr("failed to map input file - '%s'!", File);
+			free(Out->Name);
+			Out->Name = NULL;
+			return 1;
+		}
+		
+		if (mmap(Base, Len, PROT_READ, MAP_PRIVATE | MAP_FIXED, Fd, 0) == MAP_FAILED)
+		{
+			LogErr("failed to map input file - '%s'!", File);
+			munmap(Base, MapLen);
+			free(Out->Name);
+			Out->Name = NULL;
+			return 1;
+		}
+		
+		Out->Data = Base;
+		Out->Len = Len;
+		Out->MapLen = MapLen;
+		
+		FileData_IndexLines(Out);
+		return 0;
+	}
+	
+	// fall back to reading pipes and special files in full.
+	{
+		size_t Cap = 4096;
+		Out->Data = malloc(Cap);
+		Out->Len = 0;
+		
+		for (;;)
+		{
+			if (Out->Len + 1 >= Cap)
+			{
+				Cap *= 2;
+				Out->Data = realloc(Out->Data, Cap);
+			}
+			
+			ssize_t Rc = read(Fd, &Out->Data[Out->Len], Cap - Out->Len - 1);
+			if (Rc == 0)
+				break;
+			else if (Rc == -1)
+			{
+				LogErr("failed to read input file - '%s'!", File);
+				free(Out->Data);
+				free(Out->Name);
+				Out->Data = NULL;
+				Out->Name = NULL;
+				return 1;
+			}
+			
+			Out->Len += Rc;
+		}
+		
+		Out->Data[Out->Len] = 0;
+	}
+	
+	FileData_IndexLines(Out);
+	return 0;
+}
+
+static int
+FindReachable(struct Symtab const *Symtabs, struct ModuleDataGroup *Modules)
+{
+	// marks the declarations of imported modules which the main module refers
+	// to, directly or not. the main module's own declarations are all kept, so
+	// that all of its code is still checked.
+	
+	struct Reach Reach =
 	{
-		if (*i + 10 >= SrcLen)
+		.Symtabs = Symtabs,
+		.Modules = Modules
+	};
+	
+	for (size_t i = 1; i < Modules->ModuleCnt; ++i)
+	{
+		struct ModuleData *Mod = &Modules->Modules[i];
+		Mod->LiveCnt = Mod->Ast.NodeCnt;
+		Mod->Live = calloc(Mod->LiveCnt, 1);
+	}
+	
+	// chain the methods of imported modules to their types, to be queued once
+	// the type is reached. those of the main module are all roots anyway.
+	Reach.MethodHeads = calloc(Modules->ModuleCnt, sizeof(uint32_t *));
+	for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+		Reach.MethodHeads[i] = calloc(Modules->Modules[i].Ast.NodeCnt, sizeof(uint32_t));
+	
+	for (size_t i = 1; i < Modules->ModuleCnt; ++i)
+	{
+		struct FlatAst const *Ast = &Modules->Modules[i].Ast;
+		for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+		{
+			if (Ast->Nodes[Child].Type != ANT_PROC || Ast->Nodes[Child].TokCnt != 2)
+				continue;
+			
+			char const *TypeName = FlatAst_TokenText(Ast, Child, 0);
+			struct SymtabEntry const *Type = Symtab_SearchTypes(&Symtabs[i], TypeName);
+			struct SymtabEntry const *Method = Symtab_SearchValues(&Symtabs[i], FlatAst_TokenText(Ast, Child, 1), TypeName);
+			if (!Type || !Method)
+				continue;
+			
+			if (Reach.MethodCnt >= Reach.MethodCap)
+			{
+				Reach.MethodCap = Reach.MethodCap ? 2 * Reach.MethodCap : 64;
+				Reach.Methods = reallocarray(Reach.Methods, Reach.MethodCap, sizeof(struct ReachMethod));
+			}
+			
+			uint32_t *Head = &Reach.MethodHeads[Type->DeclMod - Modules->Modules][Type->DeclNode];
+			Reach.Methods[Reach.MethodCnt++] = (struct ReachMethod){.Ent = Method, .Next = *Head};
+			*Head = Reach.MethodCnt;
+		}
+	}
+	
+	// every declaration of the main module is a root, whether in its own
+	// symtab or the shared public one.
+	struct ModuleData *Main = &Modules->Modules[0];
+	for (struct Symtab const *Symtab = &Symtabs[0]; Symtab; Symtab = Symtab->Base)
+	{
+		for (size_t i = 0; i < Symtab->TypeCnt; ++i)
+		{
+			if (Symtab->Types[i].DeclMod == Main)
+				Reach_Push(&Reach, &Symtab->Types[i]);
+		}
+		for (size_t i = 0; i < Symtab->ValueCnt; ++i)
+		{
+			if (Symtab->Values[i].DeclMod == Main)
+				Reach_Push(&Reach, &Symtab->Values[i]);
+		}
+	}
+	
+	int Rc = 0;
+	while (Reach.WorkCnt && !Rc)
+		Rc = Reach_Decl(&Reach, Reach.Work[--Reach.WorkCnt]);
+	
+	for (size_t i = 0; i < Modules->ModuleCnt; ++i)
+		free(Reach.MethodHeads[i]);
+	free(Reach.MethodHeads);
+	free(Reach.Methods);
+	free(Reach.Work);
+	return Rc;
+}
+
+static uint32_t
+FlatAst_AddNode(struct FlatAst *Ast, struct AstNode const *Node)
+{
+	uint32_t Ind = Ast->NodeCnt;
+	
+	// copy node and its token indices.
+	{
+		if (Ast->NodeCnt >= Ast->NodeCap)
+		{
+			Ast->NodeCap = Ast->NodeCap ? 2 * Ast->NodeCap : 256;
+			Ast->Nodes = reallocarray(Ast->Nodes, Ast->NodeCap, sizeof(struct FlatAstNode));
+		}
+		
+		while (Ast->TokCnt + Node->TokCnt > Ast->TokCap)
+		{
+			Ast->TokCap = Ast->TokCap ? 2 * Ast->TokCap : 256;
+			Ast->Toks = reallocarray(Ast->Toks, Ast->TokCap, sizeof(uint32_t));
+		}
+		
+		Ast->Nodes[Ast->NodeCnt++] = (struct FlatAstNode)
+		{
+			.FirstTok = Ast->TokCnt,
+			.ChildCnt = Node->ChildCnt,
+			.TokCnt = Node->TokCnt,
+			.Flags = Node->Flags,
+			.Type = Node->Type
+		};
+		
+		for (size_t i = 0; i < Node->TokCnt; ++i)
+			Ast->Toks[Ast->TokCnt++] = Node->Toks[i] - Ast->Lex.Toks;
+	}
+	
+	// copy children directly after their parent and link them up.
+	{
+		uint32_t Prev = 0;
+		for (size_t i = 0; i < Node->ChildCnt; ++i)
+		{
+			uint32_t Child = FlatAst_AddNode(Ast, &Node->Children[i]);
+			if (Prev)
+				Ast->Nodes[Prev].NextSibling = Child;
+			else
+				Ast->Nodes[Ind].FirstChild = Child;
+			Prev = Child;
+		}
+	}
+	
+	return Ind;
+}
+
+static void
+FlatAst_Destroy(struct FlatAst *Ast)
+{
+	// token data is owned by the module's lex data.
+	free(Ast->Nodes);
+	free(Ast->Toks);
+}
+
+static struct Token const *
+FlatAst_Token(struct FlatAst const *Ast, uint32_t Node, size_t Ind)
+{
+	return &Ast->Lex.Toks[Ast->Toks[Ast->Nodes[Node].FirstTok + Ind]];
+}
+
+static char const *
+FlatAst_TokenText(struct FlatAst const *Ast, uint32_t Node, size_t Ind)
+{
+	return LexData_Text(&Ast->Lex, FlatAst_Token(Ast, Node, Ind));
+}
+
+static char *
+FullPathname(char const *Path)
+{
+	char PathBuf[PATH_MAX + 1] = {0};
+	realpath(Path, PathBuf);
+	return strdup(PathBuf);
+}
+
+static uint32_t
+GetSizeBaseType(struct FlatAst const *Ast, uint32_t Type)
+{
+	switch (Ast->Nodes[Type].Type)
+	{
+	case ANT_TYPE:
+	case ANT_TYPE_BUFFER:
+		return GetSizeBaseType(Ast, Ast->Nodes[Type].FirstChild);
+	case ANT_TYPE_ATOM:
+	case ANT_TYPE_PTR:
+	case ANT_TYPE_PROC:
+	case ANT_TYPE_ARRAY:
+		return Type;
+	default:
+		return 0;
+	}
+}
+
+static uint64_t
+GetTimeNs(void)
+{
+	struct timespec Ts;
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (uint64_t)Ts.tv_sec * 1000000000 + (uint64_t)Ts.tv_nsec;
+}
+
+static uint64_t
+HashStr(char const *Str, size_t Len)
+{
+	// FNV-1a.
+	uint64_t Hash = 0xcbf29ce484222325;
+	for (size_t i = 0; i < Len; ++i)
+	{
+		Hash ^= (unsigned char)Str[i];
+		Hash *= 0x100000001b3;
+	}
+	return Hash;
+}
+
+static uint64_t
+Image_Fingerprint(void)
+{
+	// images store token and node types as well as raw structures, so any
+	// change to those invalidates them. as do changes to what the parser
+	// produces, which only the build identity catches.
+	uint64_t Hash = HashStr((char const *)&(size_t[]){sizeof(struct Token), sizeof(struct FlatAstNode)}, 2 * sizeof(size_t));
+	Hash = Hash * 31 + HashStr(LITHIC_BUILD_ID, strlen(LITHIC_BUILD_ID));
+	
+	for (size_t i = 0; i < sizeof(TokenTypeNames) / sizeof(TokenTypeNames[0]); ++i)
+		Hash = Hash * 31 + HashStr(TokenTypeNames[i], strlen(TokenTypeNames[i]));
+	
+	for (size_t i = 0; i < sizeof(AstNodeTypeNames) / sizeof(AstNodeTypeNames[0]); ++i)
+		Hash = Hash * 31 + HashStr(AstNodeTypeNames[i], strlen(AstNodeTypeNames[i]));
+	
+	return Hash;
+}
+
+static int
+Image_Read(
+	struct LexData *OutLex,
+	struct FlatAst *OutAst,
+	struct FileData *OutFile,
+	int Fd,
+	struct FileData const *CacheFile,
+	uint64_t SrcHash
+)
+{
+	// reads an interface file if `OutFile` is set, filling in its data from
+	// the embedded source, or the cache entry of `CacheFile` otherwise.
+	// returns nonzero without logging anything if the image is invalid.
+	
+	struct stat Stat;
+	if (fstat(Fd, &Stat) || (size_t)Stat.st_size < sizeof(struct ImageHeader))
+		return 1;
+	
+	size_t Size = Stat.st_size;
+	unsigned char const *Base = mmap(NULL, Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+	if (Base == MAP_FAILED)
+		return 1;
+	
+	struct ImageHeader Hdr;
+	memcpy(&Hdr, Base, sizeof(Hdr));
+	
+	// validate header, and locate arrays while checking that they fit.
+	union TokenNum const *Nums;
+	struct ImageStr const *Strs;
+	struct Token const *Toks;
+	struct FlatAstNode const *Nodes;
+	uint32_t const *AstToks;
+	char const *Text, *Src;
+	{
+		if (memcmp(Hdr.Magic, OutFile ? "LCIF" : "LCCH", 4)
+			|| Hdr.Version != IMAGE_VERSION
+			|| Hdr.Fingerprint != Image_Fingerprint()
+			|| (!OutFile && (Hdr.SrcHash != SrcHash || Hdr.SrcLen != CacheFile->Len))
+			|| Hdr.NodeCnt == 0)
+		{
+			munmap((void *)Base, Size);
 			return 1;
+		}
 		
-		uint8_t Val = 0;
-		for (size_t j = *i + 2; j < *i + 10; ++j)
+		struct
 		{
-			if (!strchr("01", Src[j]))
+			void const **Out;
+			uint64_t Cnt;
+			size_t ElemSize;
+		} Arrays[] =
+		{
+			{(void const **)&Nums, Hdr.NumCnt, sizeof(union TokenNum)},
+			{(void const **)&Strs, Hdr.StrCnt, sizeof(struct ImageStr)},
+			{(void const **)&Toks, Hdr.TokCnt, sizeof(struct Token)},
+			{(void const **)&Nodes, Hdr.NodeCnt, sizeof(struct FlatAstNode)},
+			{(void const **)&AstToks, Hdr.AstTokCnt, sizeof(uint32_t)},
+			{(void const **)&Text, Hdr.TextLen, 1},
+			{(void const **)&Src, Hdr.SrcLen, 1}
+		};
+		
+		size_t Off = sizeof(struct ImageHeader);
+		for (size_t i = 0; i < sizeof(Arrays) / sizeof(Arrays[0]); ++i)
+		{
+			if (Arrays[i].Cnt > (Size - Off) / Arrays[i].ElemSize)
+			{
+				munmap((void *)Base, Size);
 				return 1;
+			}
 			
-			Val <<= 1;
-			Val += Src[j] - '0';
+			*Arrays[i].Out = Base + Off;
+			Off += Arrays[i].Cnt * Arrays[i].ElemSize;
 		}
 		
-		DynStr_AppendChar(Str, Len, Val);
-		*i += 10;
+		bool SrcOk = OutFile ? HashStr(Src, Hdr.SrcLen) == Hdr.SrcHash : !memcmp(Src, CacheFile->Data, Hdr.SrcLen);
+		if (Off != Size || !SrcOk)
+		{
+			munmap((void *)Base, Size);
+			return 1;
+		}
+	}
+	
+	// validate contents, so that a corrupt image cannot cause out of bounds
+	// accesses later on. children and siblings must come later in pre-order,
+	// which also rules out cycles.
+	bool Valid = true;
+	{
+		for (size_t i = 0; i < Hdr.StrCnt && Valid; ++i)
+			Valid = Strs[i].Off <= Hdr.TextLen && Strs[i].Len <= Hdr.TextLen - Strs[i].Off;
+		
+		for (size_t i = 0; i < Hdr.TokCnt && Valid; ++i)
+		{
+			struct Token const *Tok = &Toks[i];
+			Valid = (uint64_t)Tok->Pos + Tok->Len <= Hdr.SrcLen
+				&& Tok->Type < sizeof(TokenTypeNames) / sizeof(TokenTypeNames[0])
+				&& Tok->SizeMod <= SM_SIZE;
+			
+			if (Tok->Type == TT_IDENT || Tok->Type == TT_LIT_STR)
+				Valid = Valid && Tok->Payload < Hdr.StrCnt;
+			else if (Tok->Type == TT_LIT_INT || Tok->Type == TT_LIT_FLOAT)
+				Valid = Valid && Tok->Payload < Hdr.NumCnt;
+		}
+		
+		for (size_t i = 0; i < Hdr.NodeCnt && Valid; ++i)
+		{
+			struct FlatAstNode const *Node = &Nodes[i];
+			Valid = (!Node->FirstChild || (Node->FirstChild > i && Node->FirstChild < Hdr.NodeCnt))
+				&& (!Node->NextSibling || (Node->NextSibling > i && Node->NextSibling < Hdr.NodeCnt))
+				&& (uint64_t)Node->FirstTok + Node->TokCnt <= Hdr.AstTokCnt
+				&& Node->Type < sizeof(AstNodeTypeNames) / sizeof(AstNodeTypeNames[0]);
+		}
+		
+		for (size_t i = 0; i < Hdr.AstTokCnt && Valid; ++i)
+			Valid = AstToks[i] < Hdr.TokCnt;
+	}
+	
+	if (!Valid)
+	{
+		munmap((void *)Base, Size);
+		return 1;
+	}
+	
+	// copy data out of the mapping, interning strings anew.
+	{
+		struct LexData Lex =
+		{
+			.Toks = malloc((Hdr.TokCnt ? Hdr.TokCnt : 1) * sizeof(struct Token)),
+			.TokCnt = Hdr.TokCnt,
+			.TokCap = Hdr.TokCnt,
+			.Strs = malloc((Hdr.StrCnt ? Hdr.StrCnt : 1) * sizeof(struct TokenStr)),
+			.StrCnt = Hdr.StrCnt,
+			.StrCap = Hdr.StrCnt,
+			.Nums = malloc((Hdr.NumCnt ? Hdr.NumCnt : 1) * sizeof(union TokenNum)),
+			.NumCnt = Hdr.NumCnt,
+			.NumCap = Hdr.NumCnt
+		};
+		
+		memcpy(Lex.Toks, Toks, Hdr.TokCnt * sizeof(struct Token));
+		memcpy(Lex.Nums, Nums, Hdr.NumCnt * sizeof(union TokenNum));
+		for (size_t i = 0; i < Hdr.StrCnt; ++i)
+		{
+			Lex.Strs[i] = (struct TokenStr)
+			{
+				.Text = Interner_Add(&Text[Strs[i].Off], Strs[i].Len),
+				.Len = Strs[i].Len
+			};
+		}
+		
+		struct FlatAst Ast =
+		{
+			.Nodes = malloc(Hdr.NodeCnt * sizeof(struct FlatAstNode)),
+			.NodeCnt = Hdr.NodeCnt,
+			.NodeCap = Hdr.NodeCnt,
+			.Toks = malloc((Hdr.AstTokCnt ? Hdr.AstTokCnt : 1) * sizeof(uint32_t)),
+			.TokCnt = Hdr.AstTokCnt,
+			.TokCap = Hdr.AstTokCnt,
+			.Lex = Lex
+		};
+		
+		memcpy(Ast.Nodes, Nodes, Hdr.NodeCnt * sizeof(struct FlatAstNode));
+		memcpy(Ast.Toks, AstToks, Hdr.AstTokCnt * sizeof(uint32_t));
+		
+		if (OutFile)
+		{
+			OutFile->Data = malloc(Hdr.SrcLen + 1);
+			memcpy(OutFile->Data, Src, Hdr.SrcLen);
+			OutFile->Data[Hdr.SrcLen] = 0;
+			OutFile->Len = Hdr.SrcLen;
+			OutFile->MapLen = 0;
+			FileData_IndexLines(OutFile);
+		}
+		
+		*OutLex = Lex;
+		*OutAst = Ast;
+	}
+	
+	munmap((void *)Base, Size);
+	
+	return 0;
+}
+
+static int
+Image_Write(
+	FILE *Fp,
+	struct LexData const *Lex,
+	struct FlatAst const *Ast,
+	bool Interface,
+	char const *Src,
+	uint64_t SrcHash,
+	size_t SrcLen
+)
+{
+	// writes an interface file or a cache entry, either embedding `Src`.
+	
+	struct ImageStr *Strs = malloc((Lex->StrCnt ? Lex->StrCnt : 1) * sizeof(struct ImageStr));
+	uint64_t TextLen = 0;
+	for (size_t i = 0; i < Lex->StrCnt; ++i)
+	{
+		Strs[i] = (struct ImageStr){.Off = TextLen, .Len = Lex->Strs[i].Len};
+		TextLen += Lex->Strs[i].Len;
+	}
+	
+	struct ImageHeader Hdr =
+	{
+		.Version = IMAGE_VERSION,
+		.Fingerprint = Image_Fingerprint(),
+		.SrcHash = SrcHash,
+		.SrcLen = SrcLen,
+		.TokCnt = Lex->TokCnt,
+		.StrCnt = Lex->StrCnt,
+		.NumCnt = Lex->NumCnt,
+		.NodeCnt = Ast->NodeCnt,
+		.AstTokCnt = Ast->TokCnt,
+		.TextLen = TextLen
+	};
+	memcpy(Hdr.Magic, Interface ? "LCIF" : "LCCH", 4);
+	
+	bool Ok = fwrite(&Hdr, sizeof(Hdr), 1, Fp) == 1
+		&& fwrite(Lex->Nums, sizeof(union TokenNum), Lex->NumCnt, Fp) == Lex->NumCnt
+		&& fwrite(Strs, sizeof(struct ImageStr), Lex->StrCnt, Fp) == Lex->StrCnt
+		&& fwrite(Lex->Toks, sizeof(struct Token), Lex->TokCnt, Fp) == Lex->TokCnt
+		&& fwrite(Ast->Nodes, sizeof(struct FlatAstNode), Ast->NodeCnt, Fp) == Ast->NodeCnt
+		&& fwrite(Ast->Toks, sizeof(uint32_t), Ast->TokCnt, Fp) == Ast->TokCnt;
+	
+	for (size_t i = 0; i < Lex->StrCnt && Ok; ++i)
+		Ok = fwrite(Lex->Strs[i].Text, 1, Lex->Strs[i].Len, Fp) == Lex->Strs[i].Len;
+	
+	if (Ok)
+		Ok = fwrite(Src, 1, SrcLen, Fp) == SrcLen;
+	
+	free(Strs);
+	
+	return !Ok;
+}
+
+static char *
+ImportPath(struct FlatAst const *Ast, uint32_t Import)
+{
+	// components of the import path joined by slashes, without extension.
+	char *Path;
+	size_t PathLen;
+	DynStr_Init(&Path, &PathLen);
+	
+	for (size_t i = 0; i < Ast->Nodes[Import].TokCnt; ++i)
+	{
+		DynStr_AppendStr(&Path, &PathLen, FlatAst_TokenText(Ast, Import, i));
+		if (i + 1 < Ast->Nodes[Import].TokCnt)
+			DynStr_AppendChar(&Path, &PathLen, '/');
+	}
+	
+	return Path;
+}
+
+static uint32_t
+Interface_CopyNode(
+	struct FlatAst *Out,
+	struct LexData *OutLex,
+	struct FlatAst const *Ast,
+	uint32_t Node
+)
+{
+	struct FlatAstNode const *In = &Ast->Nodes[Node];
+	uint32_t Ind = Out->NodeCnt;
+	
+	// copy node and its tokens, keeping token positions for the caller to
+	// rebase.
+	{
+		if (Out->NodeCnt >= Out->NodeCap)
+		{
+			Out->NodeCap = Out->NodeCap ? 2 * Out->NodeCap : 256;
+			Out->Nodes = reallocarray(Out->Nodes, Out->NodeCap, sizeof(struct FlatAstNode));
+		}
+		
+		while (Out->TokCnt + In->TokCnt > Out->TokCap)
+		{
+			Out->TokCap = Out->TokCap ? 2 * Out->TokCap : 256;
+			Out->Toks = reallocarray(Out->Toks, Out->TokCap, sizeof(uint32_t));
+		}
+		
+		Out->Nodes[Out->NodeCnt++] = (struct FlatAstNode)
+		{
+			.FirstTok = Out->TokCnt,
+			.ChildCnt = In->ChildCnt,
+			.TokCnt = In->TokCnt,
+			.Flags = In->Flags,
+			.Type = In->Type
+		};
+		
+		for (size_t i = 0; i < In->TokCnt; ++i)
+		{
+			struct Token Tok = *FlatAst_Token(Ast, Node, i);
+			switch (Tok.Type)
+			{
+			case TT_IDENT:
+			case TT_LIT_STR:
+				Tok.Payload = LexData_AddStr(OutLex, Ast->Lex.Strs[Tok.Payload].Text, Ast->Lex.Strs[Tok.Payload].Len);
+				break;
+			case TT_LIT_INT:
+			case TT_LIT_FLOAT:
+				Tok.Payload = LexData_AddNum(OutLex, Ast->Lex.Nums[Tok.Payload]);
+				break;
+			default:
+				break;
+			}
+			
+			Out->Toks[Out->TokCnt++] = OutLex->TokCnt;
+			LexData_AddToken(OutLex, &Tok);
+		}
+	}
+	
+	// copy children, replacing procedure bodies with empty statement lists.
+	{
+		uint32_t Prev = 0;
+		for (uint32_t Child = In->FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+		{
+			uint32_t New;
+			if (In->Type == ANT_PROC && Ast->Nodes[Child].Type == ANT_STATEMENT_LIST)
+			{
+				if (Out->NodeCnt >= Out->NodeCap)
+				{
+					Out->NodeCap = 2 * Out->NodeCap;
+					Out->Nodes = reallocarray(Out->Nodes, Out->NodeCap, sizeof(struct FlatAstNode));
+				}
+				
+				New = Out->NodeCnt++;
+				Out->Nodes[New] = (struct FlatAstNode)
+				{
+					.FirstTok = Out->TokCnt,
+					.Type = ANT_STATEMENT_LIST
+				};
+			}
+			else
+				New = Interface_CopyNode(Out, OutLex, Ast, Child);
+			
+			if (Prev)
+				Out->Nodes[Prev].NextSibling = New;
+			else
+				Out->Nodes[Ind].FirstChild = New;
+			Prev = New;
+		}
+	}
+	
+	return Ind;
+}
+
+static int
+Interface_Load(struct ModuleData *Out, FILE *Fp, char const *Path)
+{
+	struct FileData File = {.Name = strdup(Path)};
+	struct LexData Lex;
+	struct FlatAst Ast;
+	if (Image_Read(&Lex, &Ast, &File, fileno(Fp), NULL, 0))
+	{
+		LogErr("invalid or outdated module interface file - '%s'!", Path);
+		free(File.Name);
+		return 1;
 	}
-	else if (!strncmp(&Src[*i], "\\x", 2))
+	
+	Out->File = File;
+	Out->Lex = Lex;
+	Out->Ast = Ast;
+	Out->Interface = true;
+	
+	return 0;
+}
+
+static void
+Interface_MarkRefs(
+	struct FlatAst const *Ast,
+	uint32_t Node,
+	uint32_t const *Slots,
+	size_t SlotCnt,
+	unsigned char *Keep
+)
+{
+	// marks the private declarations in `Slots` named within `Node`, and in
+	// turn those named within them. procedure bodies are not kept, so their
+	// references do not count.
+	
+	struct FlatAstNode const *Flat = &Ast->Nodes[Node];
+	for (size_t i = 0; i < Flat->TokCnt; ++i)
 	{
-		if (*i + 4 >= SrcLen)
-			return 1;
+		struct Token const *Tok = FlatAst_Token(Ast, Node, i);
+		if (Tok->Type != TT_IDENT)
+			continue;
 		
-		uint8_t Val = 0;
-		for (size_t j = *i + 2; j < *i + 4; ++j)
+		// types and values may share a name, so every match is kept.
+		char const *Name = LexData_Text(&Ast->Lex, Tok);
+		for (size_t j = Symtab_Hash(Name, NULL) & (SlotCnt - 1); Slots[j]; j = (j + 1) & (SlotCnt - 1))
 		{
-			if (!isxdigit(Src[j]))
-				return 1;
+			if (Keep[Slots[j]] || FlatAst_TokenText(Ast, Slots[j], 0) != Name)
+				continue;
 			
-			Val <<= 4;
-			Val += HexDigitValue[(size_t)Src[j]];
+			Keep[Slots[j]] = 1;
+			Interface_MarkRefs(Ast, Slots[j], Slots, SlotCnt, Keep);
 		}
-		
-		DynStr_AppendChar(Str, Len, Val);
-		*i += 4;
 	}
-	else
-		return 1;
 	
-	return 0;
+	for (uint32_t Child = Flat->FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+	{
+		if (Flat->Type != ANT_PROC || Ast->Nodes[Child].Type != ANT_STATEMENT_LIST)
+			Interface_MarkRefs(Ast, Child, Slots, SlotCnt, Keep);
+	}
 }
 
-static struct DepNode const *
-DepGraph_AddNode(struct DepGraph *Graph, struct DepNode const *Node)
+static int
+Interface_Write(FILE *Fp, struct FileData const *File, struct FlatAst const *Ast)
 {
-	// copy node.
-	{
-		++Graph->NodeCnt;
-		Graph->Nodes = reallocarray(
-			Graph->Nodes,
-			Graph->NodeCnt,
-			sizeof(struct DepNode)
-		);
-		Graph->Nodes[Graph->NodeCnt - 1] = *Node;
-	}
+	// interfaces keep imports and public declarations without procedure
+	// bodies, along with the source lines of each for diagnostics. skipped
+	// lines are kept as empty ones, so line numbers stay the same.
 	
-	// if adjacency matrix not allocated yet, just create it and stop.
+	// private types and variables named by kept declarations are kept too,
+	// still unexported, so that interfaces analyze on their own.
+	unsigned char *Keep = calloc(Ast->NodeCnt, 1);
 	{
-		if (Graph->NodeCnt == 1)
+		size_t PrivCnt = 0;
+		for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+		{
+			unsigned char Type = Ast->Nodes[Child].Type;
+			PrivCnt += !(Ast->Nodes[Child].Flags & ANF_PUBLIC)
+				&& (Type == ANT_STRUCT || Type == ANT_ENUM || Type == ANT_UNION || Type == ANT_VAR);
+		}
+		
+		size_t SlotCnt = 1;
+		while (SlotCnt < 2 * PrivCnt)
+			SlotCnt *= 2;
+		uint32_t *Slots = calloc(SlotCnt, sizeof(uint32_t));
+		
+		for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
 		{
-			Graph->Adjacency = malloc(1);
-			Graph->Adjacency[0] = false;
-			return &Graph->Nodes[Graph->NodeCnt - 1];
+			unsigned char Type = Ast->Nodes[Child].Type;
+			if (Ast->Nodes[Child].Flags & ANF_PUBLIC
+				|| (Type != ANT_STRUCT && Type != ANT_ENUM && Type != ANT_UNION && Type != ANT_VAR))
+			{
+				continue;
+			}
+			
+			size_t i = Symtab_Hash(FlatAst_TokenText(Ast, Child, 0), NULL) & (SlotCnt - 1);
+			while (Slots[i])
+				i = (i + 1) & (SlotCnt - 1);
+			Slots[i] = Child;
+		}
+		
+		for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+		{
+			if (Ast->Nodes[Child].Type == ANT_IMPORT || Ast->Nodes[Child].Flags & ANF_PUBLIC)
+			{
+				Keep[Child] = 1;
+				Interface_MarkRefs(Ast, Child, Slots, SlotCnt, Keep);
+			}
 		}
+		
+		free(Slots);
 	}
 	
-	// allocate / move new memory in adjacency matrix if needed.
+	struct LexData Lex = {0};
+	struct FlatAst Iface =
+	{
+		.Nodes = calloc(256, sizeof(struct FlatAstNode)),
+		.NodeCnt = 1,
+		.NodeCap = 256
+	};
+	Iface.Nodes[0].Type = ANT_PROGRAM;
+	
+	char *Src;
+	size_t SrcLen, SrcLineCnt = 0;
+	DynStr_Init(&Src, &SrcLen);
+	
+	uint32_t Prev = 0;
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
 	{
-		size_t OldRowSize = Graph->NodeCnt - 1;
-		size_t NewRowSize = Graph->NodeCnt;
-		size_t MvRegionSize = OldRowSize * NewRowSize;
+		if (!Keep[Child])
+			continue;
 		
-		Graph->Adjacency = realloc(
-			Graph->Adjacency,
-			NewRowSize * NewRowSize
-		);
+		size_t FirstTok = Lex.TokCnt;
+		uint32_t New = Interface_CopyNode(&Iface, &Lex, Ast, Child);
+		if (Prev)
+			Iface.Nodes[Prev].NextSibling = New;
+		else
+			Iface.Nodes[0].FirstChild = New;
+		Prev = New;
+		++Iface.Nodes[0].ChildCnt;
 		
-		for (size_t i = 0; i < MvRegionSize; i += NewRowSize)
+		// excerpt whole lines spanned by the copied tokens.
+		size_t Begin = File->Len, End = 0;
+		for (size_t i = FirstTok; i < Lex.TokCnt; ++i)
 		{
-			memmove(
-				&Graph->Adjacency[i + 1],
-				&Graph->Adjacency[i],
-				MvRegionSize - i
-			);
-			Graph->Adjacency[i] = false;
+			Begin = Lex.Toks[i].Pos < Begin ? Lex.Toks[i].Pos : Begin;
+			End = Lex.Toks[i].Pos + Lex.Toks[i].Len > End ? Lex.Toks[i].Pos + Lex.Toks[i].Len : End;
 		}
 		
-		memset(
-			&Graph->Adjacency[NewRowSize * OldRowSize],
-			false,
-			NewRowSize
-		);
+		if (Begin >= End)
+			continue;
+		
+		size_t Line = FileData_FindLine(File, Begin);
+		Begin = File->Lines[Line];
+		for (; SrcLineCnt < Line; ++SrcLineCnt)
+			DynStr_AppendChar(&Src, &SrcLen, '\n');
+		
+		for (size_t i = FirstTok; i < Lex.TokCnt; ++i)
+			Lex.Toks[i].Pos = Lex.Toks[i].Pos - Begin + SrcLen;
+		
+		DynStr_AppendBuf(&Src, &SrcLen, &File->Data[Begin], End - Begin);
+		for (size_t i = Begin; i < End; ++i)
+			SrcLineCnt += File->Data[i] == '\n';
 	}
+	Iface.Lex = Lex;
 	
-	return &Graph->Nodes[Graph->NodeCnt - 1];
+	int Rc = Image_Write(Fp, &Lex, &Iface, true, Src, HashStr(Src, SrcLen), SrcLen);
+	if (Rc)
+		LogErr("failed to write module interface - '%s'!", Ctx->Conf.OutFile);
+	
+	// free allocated memory.
+	{
+		free(Keep);
+		free(Src);
+		FlatAst_Destroy(&Iface);
+		LexData_Destroy(&Lex);
+	}
+	
+	return Rc;
 }
 
-static void
-DepGraph_Connect(
-	struct DepGraph *Graph,
-	struct DepNode const *From,
-	struct DepNode const *To
-)
+static char const *
+Interner_Add(char const *Str, size_t Len)
 {
-	size_t FromInd = ((uintptr_t)From - (uintptr_t)Graph->Nodes) / sizeof(struct DepNode);
-	size_t ToInd = ((uintptr_t)To - (uintptr_t)Graph->Nodes) / sizeof(struct DepNode);
-	Graph->Adjacency[FromInd * Graph->NodeCnt + ToInd] = true;
+	if (LocalInterner)
+		return Interner_Insert(LocalInterner, Str, Len);
+	
+	pthread_mutex_lock(&Ctx->Interner.Lock);
+	char const *Interned = Interner_Insert(&Ctx->Interner, Str, Len);
+	pthread_mutex_unlock(&Ctx->Interner.Lock);
+	
+	return Interned;
 }
 
 static void
-DepGraph_Destroy(struct DepGraph *Graph)
+Interner_Destroy(struct Interner *Interner)
 {
-	// node-specific resource release.
-	{
-		for (size_t i = 0; i < Graph->NodeCnt; ++i)
-			free(Graph->Nodes[i].Name);
-	}
-	
-	// graph-whole resource release.
-	{
-		free(Graph->Nodes);
-		free(Graph->Adjacency);
-	}
+	// the lock is left to the owner, as it may outlive the table.
+	Arena_Destroy(&Interner->Strs);
+	free(Interner->Entries);
+	Interner->Entries = NULL;
+	Interner->EntryCnt = Interner->EntryCap = 0;
 }
 
-static struct DepNode const *
-DepGraph_FindCycle(
-	struct DepGraph *Graph,
-	struct DepNode const *Src,
-	struct DepNode *Cur
-)
+static char const *
+Interner_Insert(struct Interner *Interner, char const *Str, size_t Len)
 {
-	if (DepGraph_SearchEdge(Graph, Cur, Src))
-		return Cur;
+	uint64_t Hash = HashStr(Str, Len);
 	
-	Cur->Visited = true;
-	for (size_t i = 0; i < Graph->NodeCnt; ++i)
+	// grow table to keep load factor at or below one half.
+	if (2 * (Interner->EntryCnt + 1) > Interner->EntryCap)
 	{
-		struct DepNode *Node = &Graph->Nodes[i];
-		if (!Node->Visited && DepGraph_SearchEdge(Graph, Cur, Node))
+		size_t NewCap = Interner->EntryCap ? 2 * Interner->EntryCap : 256;
+		struct InternEntry *NewEntries = calloc(NewCap, sizeof(struct InternEntry));
+		
+		for (size_t i = 0; i < Interner->EntryCap; ++i)
 		{
-			struct DepNode const *Cycle = DepGraph_FindCycle(Graph, Src, Node);
-			if (Cycle)
-				return Cycle;
+			struct InternEntry const *Ent = &Interner->Entries[i];
+			if (!Ent->Str)
+				continue;
+			
+			size_t j = Ent->Hash & (NewCap - 1);
+			while (NewEntries[j].Str)
+				j = (j + 1) & (NewCap - 1);
+			NewEntries[j] = *Ent;
 		}
+		
+		free(Interner->Entries);
+		Interner->Entries = NewEntries;
+		Interner->EntryCap = NewCap;
 	}
 	
-	return NULL;
-}
-
-static void
-DepGraph_ResetVisited(struct DepGraph *Graph)
-{
-	for (size_t i = 0; i < Graph->NodeCnt; ++i)
-		Graph->Nodes[i].Visited = false;
-}
-
-static bool
-DepGraph_SearchEdge(
-	struct DepGraph const *Graph,
-	struct DepNode const *From,
-	struct DepNode const *To
-)
-{
-	size_t FromInd = ((uintptr_t)From - (uintptr_t)Graph->Nodes) / sizeof(struct DepNode);
-	size_t ToInd = ((uintptr_t)To - (uintptr_t)Graph->Nodes) / sizeof(struct DepNode);
-	return Graph->Adjacency[FromInd * Graph->NodeCnt + ToInd];
-}
-
-static struct DepNode const *
-DepGraph_SearchNode(struct DepGraph const *Graph, char const *Name)
-{
-	for (size_t i = 0; i < Graph->NodeCnt; ++i)
+	size_t i = Hash & (Interner->EntryCap - 1);
+	
+	// find existing string.
+	for (; Interner->Entries[i].Str; i = (i + 1) & (Interner->EntryCap - 1))
 	{
-		if (!strcmp(Graph->Nodes[i].Name, Name))
-			return &Graph->Nodes[i];
+		struct InternEntry const *Ent = &Interner->Entries[i];
+		if (Ent->Hash == Hash && Ent->Len == Len && !memcmp(Ent->Str, Str, Len))
+			return Ent->Str;
 	}
-	return NULL;
-}
-
-static void
-DynStr_AppendChar(char **Str, size_t *Len, char Ch)
-{
-	++*Len;
-	*Str = realloc(*Str, *Len + 1);
-	(*Str)[*Len - 1] = Ch;
-	(*Str)[*Len] = 0;
+	
+	// insert new string.
+	char *Copy = Arena_Alloc(&Interner->Strs, Len + 1);
+	memcpy(Copy, Str, Len);
+	Copy[Len] = 0;
+	
+	Interner->Entries[i] = (struct InternEntry)
+	{
+		.Str = Copy,
+		.Len = Len,
+		.Hash = Hash
+	};
+	++Interner->EntryCnt;
+	
+	return Copy;
 }
 
+#ifndef LITHIC_LIB
 static void
-DynStr_AppendStr(char **Str, size_t *Len, char const *Append)
+Interner_Quit(void)
 {
-	size_t AppendLen = strlen(Append);
-	*Str = realloc(*Str, *Len + AppendLen + 1);
-	strcpy(*Str + *Len, Append);
-	*Len += AppendLen;
+	Interner_Destroy(&Ctx->Interner);
 }
+#endif
 
-static void
-DynStr_Init(char **Str, size_t *Len)
+static bool
+IsIdentInit(char ch)
 {
-	*Str = malloc(1);
-	(*Str)[0] = 0;
-	*Len = 0;
+	return isalpha(ch) || ch == '_';
 }
 
-static struct Token const *
-ExpectToken(struct ParseState *Ps, enum TokenType Type)
+static int
+Lex(struct LexData *Out, struct FileData const *Data)
 {
-	struct Token const *Tok = NextToken(Ps);
-	if (!Tok)
+	// token positions and lengths are stored in 32 bits.
+	if (Data->Len > UINT32_MAX)
 	{
-		LogProgErr(Ps->File, Ps->File->Len, 1, "expected %s at end of file, found nothing!", TokenTypeNames[Type]);
-		return NULL;
+		LogErr("file too large to lex - '%s'!", Data->Name);
+		return 1;
 	}
 	
-	if (Tok->Type != Type)
+	size_t ChunkCnt = Data->Len / LEX_CHUNK_MIN;
+	if (ChunkCnt > Ctx->Conf.JobCnt)
+		ChunkCnt = Ctx->Conf.JobCnt;
+	
+	if (ChunkCnt <= 1)
 	{
-		LogTokErr(Ps->File, Tok, "expected %s, found %s!", TokenTypeNames[Type], TokenTypeNames[Tok->Type]);
-		return NULL;
+		size_t Stop;
+		return LexRange(Out, Data, 0, Data->Len, &Stop);
 	}
 	
-	return Tok;
-}
-
-static int
-ExtractImports(
-	struct FileData const *File,
-	struct ModuleDataGroup *Append,
-	struct AstNode const *Ast,
-	unsigned Depth
-)
-{
-	// it is the caller's responsibility to clean up `Append`.
+	// split data into chunks at line breaks.
+	struct LexChunk *Chunks = calloc(ChunkCnt, sizeof(struct LexChunk));
+	{
+		size_t Begin = 0, Cnt = 0;
+		for (size_t i = 0; i < ChunkCnt && Begin < Data->Len; ++i)
+		{
+			size_t End = Data->Len;
+			if (i + 1 < ChunkCnt)
+			{
+				size_t Split = (i + 1) * Data->Len / ChunkCnt;
+				End = Scan(Data->Data, Data->Len, Split < Begin ? Begin : Split, SC_NEWLINE);
+				End += End < Data->Len;
+			}
+			
+			Chunks[Cnt++] = (struct LexChunk)
+			{
+				.Ctx = Ctx,
+				.File = Data,
+				.Begin = Begin,
+				.End = End
+			};
+			Begin = End;
+		}
+		ChunkCnt = Cnt;
+	}
 	
-	for (size_t i = 0; i < Ast->ChildCnt; ++i)
+	// lex all chunks speculatively, assuming that none of them begin inside a
+	// token. the calling thread takes the first chunk, and any chunk for which
+	// a thread cannot be created.
 	{
-		struct AstNode const *Child = &Ast->Children[i];
-		if (Child->Type != ANT_IMPORT)
-			continue;
+		pthread_t *Workers = calloc(ChunkCnt, sizeof(pthread_t));
+		bool *Threaded = calloc(ChunkCnt, sizeof(bool));
 		
-		char *Path = ResolveImport(Child);
-		if (!Path)
+		for (size_t i = 1; i < ChunkCnt; ++i)
+			Threaded[i] = !pthread_create(&Workers[i], NULL, LexChunk_Work, &Chunks[i]);
+		
+		for (size_t i = 0; i < ChunkCnt; ++i)
 		{
-			LogAstNodeErr(File, Child, "import path was unresolved!");
-			return 1;
+			if (!Threaded[i])
+				LexChunk_Work(&Chunks[i]);
 		}
 		
-		FILE *Fp = OpenFile(Path, "rb");
-		if (!Fp)
+		for (size_t i = 0; i < ChunkCnt; ++i)
 		{
-			LogAstNodeErr(File, Child, "failed to open module file for reading - '%s'!", Path);
-			free(Path);
-			return 1;
+			if (Threaded[i])
+				pthread_join(Workers[i], NULL);
 		}
 		
-		char *FullPath = FullPathname(Path);
-		
-		// ignore modules with duplicate paths.
-		for (size_t Mod = 0; Mod < Append->ModuleCnt; ++Mod)
+		free(Workers);
+		free(Threaded);
+	}
+	
+	// stitch chunks together in order. a chunk is redone on the calling thread
+	// if its predecessor's last token ran past the boundary, invalidating the
+	// speculation, or if it failed, so that errors get reported as they would
+	// be by a sequential lex.
+	int Rc = 0;
+	{
+		size_t Pos = 0;
+		for (size_t i = 0; i < ChunkCnt; ++i)
 		{
-			if (!strcmp(FullPath, Append->Modules[Mod].FullPath))
+			struct LexChunk *Chunk = &Chunks[i];
+			
+			if (Pos != Chunk->Begin || Chunk->Failed)
 			{
-				free(FullPath);
-				fclose(Fp);
-				free(Path);
-				continue;
+				if (!Chunk->Failed)
+					LexData_Destroy(&Chunk->Lex);
+				Chunk->Lex = (struct LexData){0};
+				
+				// the redone chunk interns directly into the shared table.
+				Interner_Destroy(&Chunk->Interner);
+				
+				// a token from an earlier chunk may swallow this one whole.
+				if (Pos >= Chunk->End)
+					continue;
+				
+				Chunk->Failed = LexRange(&Chunk->Lex, Data, Pos, Chunk->End, &Chunk->Stop);
+				if (Chunk->Failed)
+				{
+					Rc = 1;
+					break;
+				}
+			}
+			
+			// move strings from the chunk's own interner to the shared one,
+			// taking the lock once for the whole chunk.
+			if (Chunk->Interner.EntryCnt)
+			{
+				pthread_mutex_lock(&Ctx->Interner.Lock);
+				for (size_t j = 0; j < Chunk->Lex.StrCnt; ++j)
+				{
+					struct TokenStr *Str = &Chunk->Lex.Strs[j];
+					Str->Text = Interner_Insert(&Ctx->Interner, Str->Text, Str->Len);
+				}
+				pthread_mutex_unlock(&Ctx->Interner.Lock);
 			}
+			
+			LexData_Append(Out, &Chunk->Lex);
+			Pos = Chunk->Stop;
+		}
+	}
+	
+	// free allocated memory.
+	{
+		for (size_t i = 0; i < ChunkCnt; ++i)
+		{
+			if (!Chunks[i].Failed)
+				LexData_Destroy(&Chunks[i].Lex);
+			Interner_Destroy(&Chunks[i].Interner);
 		}
+		free(Chunks);
 		
-		struct FileData FileData = {0};
-		if (FileData_Read(&FileData, Fp, Path))
+		if (Rc)
+			LexData_Destroy(Out);
+	}
+	
+	return Rc;
+}
+
+static int
+LexChar(struct LexData *Out, struct FileData const *Data, size_t *i)
+{
+	size_t Lb = *i;
+	
+	char *ChData;
+	size_t ChDataLen;
+	DynStr_Init(&ChData, &ChDataLen);
+	
+	// get character data.
+	{
+		++*i;
+		if (Data->Data[*i] == '\'')
 		{
-			fclose(Fp);
-			free(Path);
-			free(FullPath);
+			LogProgErr(Data, Lb, 1, "cannot have empty character literals!");
+			free(ChData);
 			return 1;
 		}
+		else if (Data->Data[*i] == '\\')
+		{
+			if (ConvEscSequence(Data->Data, Data->Len, i, &ChData, &ChDataLen))
+			{
+				LogProgErr(Data, Lb, 1, "invalid escape in character - '%c'!", Data->Data[*i + 1]);
+				free(ChData);
+				return 1;
+			}
+		}
+		else
+			DynStr_AppendChar(&ChData, &ChDataLen, Data->Data[*i]);
 		
-		fclose(Fp);
-		free(Path);
-		
-		struct LexData LexData = {0};
-		if (Lex(&LexData, &FileData))
+		if (Data->Data[*i] != '\'')
 		{
-			FileData_Destroy(&FileData);
-			free(FullPath);
+			LogProgErr(Data, Lb, 1, "cannot have unterminated character literals!");
+			free(ChData);
 			return 1;
 		}
+		++*i;
+	}
+	
+	// get size modifier if present.
+	enum SizeMod SizeMod = SM_8;
+	if (Data->Data[*i] == '\'')
+	{
+		++*i;
+		size_t ModLb = *i;
+		
+		while (isalnum(Data->Data[*i]) || Data->Data[*i] == '_')
+			++*i;
 		
-		struct AstNode Ast = {0};
-		if (Parse(&Ast, &FileData, &LexData))
+		if (*i - ModLb == 2 && !strncmp(&Data->Data[ModLb], "32", 2))
+			SizeMod = SM_32;
+		else if (*i - ModLb == 2 && !strncmp(&Data->Data[ModLb], "16", 2))
+			SizeMod = SM_16;
+		else if (*i - ModLb == 1 && !strncmp(&Data->Data[ModLb], "8", 1))
+			SizeMod = SM_8;
+		else
 		{
-			LexData_Destroy(&LexData);
-			FileData_Destroy(&FileData);
-			free(FullPath);
+			LogProgErr(Data, Lb, 1, "character literal has invalid size modifier!");
+			free(ChData);
 			return 1;
 		}
-		
-		struct ModuleData ModuleData =
-		{
-			.File = FileData,
-			.Lex = LexData,
-			.Ast = Ast,
-			.FullPath = FullPath
-		};
-		
-		ModuleDataGroup_Append(Append, &ModuleData);
 	}
 	
+	struct Token Tok =
+	{
+		.Pos = Lb,
+		.Len = *i - Lb,
+		.Payload = LexData_AddNum(Out, (union TokenNum){.Int = ChData[0]}),
+		.SizeMod = SizeMod,
+		.Type = TT_LIT_INT
+	};
+	LexData_AddToken(Out, &Tok);
+	free(ChData);
+	
 	return 0;
 }
 
+static void *
+LexChunk_Work(void *Arg)
+{
+	struct LexChunk *Chunk = Arg;
+	Ctx = Chunk->Ctx;
+	
+	// a chunk may have been split mid-token, in which case it gets redone and
+	// its errors are meaningless.
+	bool WasMuted = LogMuted;
+	LogMuted = true;
+	LocalInterner = &Chunk->Interner;
+	Chunk->Failed = LexRange(&Chunk->Lex, Chunk->File, Chunk->Begin, Chunk->End, &Chunk->Stop);
+	LocalInterner = NULL;
+	LogMuted = WasMuted;
+	
+	return NULL;
+}
+
+static uint32_t
+LexData_AddNum(struct LexData *Out, union TokenNum Num)
+{
+	if (Out->NumCnt >= Out->NumCap)
+	{
+		Out->NumCap = Out->NumCap ? 2 * Out->NumCap : 256;
+		Out->Nums = reallocarray(Out->Nums, Out->NumCap, sizeof(union TokenNum));
+	}
+	Out->Nums[Out->NumCnt] = Num;
+	return Out->NumCnt++;
+}
+
 static void
-FileData_Destroy(struct FileData *Data)
+LexData_AddSpecialChar(
+	struct LexData *Out,
+	size_t Pos,
+	size_t Len,
+	enum TokenType Type
+)
 {
-	// free allocated memory.
+	struct Token Tok =
 	{
-		free(Data->Name);
-		free(Data->Data);
+		.Pos = Pos,
+		.Len = Len,
+		.Type = Type
+	};
+	LexData_AddToken(Out, &Tok);
+}
+
+static uint32_t
+LexData_AddStr(struct LexData *Out, char const *Text, size_t Len)
+{
+	if (Out->StrCnt >= Out->StrCap)
+	{
+		Out->StrCap = Out->StrCap ? 2 * Out->StrCap : 256;
+		Out->Strs = reallocarray(Out->Strs, Out->StrCap, sizeof(struct TokenStr));
 	}
+	Out->Strs[Out->StrCnt] = (struct TokenStr){.Text = Text, .Len = Len};
+	return Out->StrCnt++;
 }
 
-static int
-FileData_Read(struct FileData *Out, FILE *Fp, char const *File)
+static void
+LexData_AddToken(struct LexData *Out, struct Token const *Tok)
 {
-	// read input file.
+	if (Out->TokCnt >= Out->TokCap)
+	{
+		Out->TokCap = Out->TokCap ? 2 * Out->TokCap : 1024;
+		Out->Toks = reallocarray(Out->Toks, Out->TokCap, sizeof(struct Token));
+	}
+	Out->Toks[Out->TokCnt++] = *Tok;
+}
+
+static void
+LexData_Append(struct LexData *Out, struct LexData const *Chunk)
+{
+	// grow arrays to fit all of `Chunk` at once.
 	{
-		fseek(Fp, 0, SEEK_END);
+		if (Out->TokCnt + Chunk->TokCnt > Out->TokCap)
+		{
+			Out->TokCap = 2 * Out->TokCap > Out->TokCnt + Chunk->TokCnt ? 2 * Out->TokCap : Out->TokCnt + Chunk->TokCnt;
+			Out->Toks = reallocarray(Out->Toks, Out->TokCap, sizeof(struct Token));
+		}
 		
-		long Len = ftell(Fp);
-		if (Len == -1)
+		if (Out->StrCnt + Chunk->StrCnt > Out->StrCap)
 		{
-			LogErr("failed to get size of input file - '%s'!", File);
-			return 1;
+			Out->StrCap = 2 * Out->StrCap > Out->StrCnt + Chunk->StrCnt ? 2 * Out->StrCap : Out->StrCnt + Chunk->StrCnt;
+			Out->Strs = reallocarray(Out->Strs, Out->StrCap, sizeof(struct TokenStr));
 		}
-		fseek(Fp, 0, SEEK_SET);
 		
-		Out->Name = strdup(File);
-		Out->Len = Len;
-		Out->Data = malloc(Len + 1);
-		if (fread(Out->Data, sizeof(char), Len, Fp) != Len)
+		if (Out->NumCnt + Chunk->NumCnt > Out->NumCap)
 		{
-			LogErr("failed to read input file - '%s'!", File);
-			return 1;
+			Out->NumCap = 2 * Out->NumCap > Out->NumCnt + Chunk->NumCnt ? 2 * Out->NumCap : Out->NumCnt + Chunk->NumCnt;
+			Out->Nums = reallocarray(Out->Nums, Out->NumCap, sizeof(union TokenNum));
 		}
-		Out->Data[Len] = 0;
 	}
 	
-	return 0;
-}
-
-static char *
-FullPathname(char const *Path)
-{
-	char PathBuf[PATH_MAX + 1] = {0};
-	realpath(Path, PathBuf);
-	return strdup(PathBuf);
-}
-
-static struct AstNode const *
-GetSizeBaseType(struct AstNode const *Type)
-{
-	switch (Type->Type)
+	// copy tokens, rebasing side table indices.
+	for (size_t i = 0; i < Chunk->TokCnt; ++i)
 	{
-	case ANT_TYPE:
-	case ANT_TYPE_BUFFER:
-		return GetSizeBaseType(&Type->Children[0]);
-	case ANT_TYPE_ATOM:
-	case ANT_TYPE_PTR:
-	case ANT_TYPE_PROC:
-	case ANT_TYPE_ARRAY:
-		return Type;
-	default:
-		return NULL;
+		struct Token Tok = Chunk->Toks[i];
+		switch (Tok.Type)
+		{
+		case TT_IDENT:
+		case TT_LIT_STR:
+			Tok.Payload += Out->StrCnt;
+			break;
+		case TT_LIT_INT:
+		case TT_LIT_FLOAT:
+			Tok.Payload += Out->NumCnt;
+			break;
+		default:
+			break;
+		}
+		Out->Toks[Out->TokCnt++] = Tok;
 	}
+	
+	if (Chunk->StrCnt)
+		memcpy(&Out->Strs[Out->StrCnt], Chunk->Strs, Chunk->StrCnt * sizeof(struct TokenStr));
+	Out->StrCnt += Chunk->StrCnt;
+	
+	if (Chunk->NumCnt)
+		memcpy(&Out->Nums[Out->NumCnt], Chunk->Nums, Chunk->NumCnt * sizeof(union TokenNum));
+	Out->NumCnt += Chunk->NumCnt;
 }
 
-static uint64_t
-GetUnixTimeMs(void)
+static void
+LexData_Destroy(struct LexData *Data)
 {
-	struct timeval Tv;
-	gettimeofday(&Tv, NULL);
-	return (uint64_t)Tv.tv_sec * 1000 + (uint64_t)Tv.tv_usec / 1000;
+	// token text is owned by the interner.
+	free(Data->Toks);
+	free(Data->Strs);
+	free(Data->Nums);
 }
 
-static bool
-IsIdentInit(char ch)
+static char const *
+LexData_Text(struct LexData const *Lex, struct Token const *Tok)
 {
-	return isalpha(ch) || ch == '_';
+	if (Tok->Type != TT_IDENT && Tok->Type != TT_LIT_STR)
+		return NULL;
+	return Lex->Strs[Tok->Payload].Text;
 }
 
 static int
-Lex(struct LexData *Out, struct FileData const *Data)
+LexRange(
+	struct LexData *Out,
+	struct FileData const *Data,
+	size_t Begin,
+	size_t End,
+	size_t *OutStop
+)
 {
-	bool InComment = false;
+	// tokens may extend beyond `End`, which is why `OutStop` is provided.
+	
 	bool NoNewline = false;
 	
-	for (size_t i = 0; i < Data->Len; ++i)
+	size_t i = Begin;
+	for (; i < End; ++i)
 	{
 		// handle comments and whitespace.
 		{
 			if (Data->Data[i] == '\n')
 			{
-				InComment = false;
 				if (!NoNewline)
 					LexData_AddSpecialChar(Out, i, 1, TT_NEWLINE);
 				NoNewline = false;
 				continue;
 			}
 			
+			// comments run until the newline, which is handled normally.
 			if (Data->Data[i] == ';')
 			{
-				InComment = true;
+				i = Scan(Data->Data, Data->Len, i, SC_NEWLINE) - 1;
 				continue;
 			}
 			
-			if (InComment || isspace(Data->Data[i]))
+			if (isspace(Data->Data[i]))
+			{
+				i = Scan(Data->Data, Data->Len, i, SC_NON_BLANK) - 1;
 				continue;
+			}
 			else if (Data->Data[i] == '\\')
 			{
 				NoNewline = true;
@@ -2115,49 +8905,41 @@ Lex(struct LexData *Out, struct FileData const *Data)
 			if (IsIdentInit(Data->Data[i])
 				|| (Data->Data[i] == '@' && IsIdentInit(Data->Data[i + 1])))
 			{
-				struct Token Tok;
-				if (LexWord(Data, &Tok, &i))
+				if (LexWord(Out, Data, &i))
 				{
 					LexData_Destroy(Out);
 					return 1;
 				}
-				LexData_AddToken(Out, &Tok);
 				--i;
 				continue;
 			}
 			else if (isdigit(Data->Data[i]))
 			{
-				struct Token Tok;
-				if (LexNum(Data, &Tok, &i))
+				if (LexNum(Out, Data, &i))
 				{
 					LexData_Destroy(Out);
 					return 1;
 				}
-				LexData_AddToken(Out, &Tok);
 				--i;
 				continue;
 			}
 			else if (Data->Data[i] == '\'')
 			{
-				struct Token Tok;
-				if (LexChar(Data, &Tok, &i))
+				if (LexChar(Out, Data, &i))
 				{
 					LexData_Destroy(Out);
 					return 1;
 				}
-				LexData_AddToken(Out, &Tok);
 				--i;
 				continue;
 			}
 			else if (Data->Data[i] == '"')
 			{
-				struct Token Tok;
-				if (LexString(Data, &Tok, &i))
+				if (LexString(Out, Data, &i))
 				{
 					LexData_Destroy(Out);
 					return 1;
 				}
-				LexData_AddToken(Out, &Tok);
 				--i;
 				continue;
 			}
@@ -2390,120 +9172,12 @@ Lex(struct LexData *Out, struct FileData const *Data)
 		}
 	}
 	
+	*OutStop = i;
 	return 0;
 }
 
 static int
-LexChar(struct FileData const *Data, struct Token *Out, size_t *i)
-{
-	size_t Lb = *i;
-	
-	char *ChData;
-	size_t ChDataLen;
-	DynStr_Init(&ChData, &ChDataLen);
-	
-	// get character data.
-	{
-		++*i;
-		if (Data->Data[*i] == '\'')
-		{
-			LogProgErr(Data, Lb, 1, "cannot have empty character literals!");
-			free(ChData);
-			return 1;
-		}
-		else if (Data->Data[*i] == '\\')
-		{
-			if (ConvEscSequence(Data->Data, Data->Len, i, &ChData, &ChDataLen))
-			{
-				LogProgErr(Data, Lb, 1, "invalid escape in character - '%c'!", Data->Data[*i + 1]);
-				free(ChData);
-				return 1;
-			}
-		}
-		else
-			DynStr_AppendChar(&ChData, &ChDataLen, Data->Data[*i]);
-		
-		if (Data->Data[*i] != '\'')
-		{
-			LogProgErr(Data, Lb, 1, "cannot have unterminated character literals!");
-			free(ChData);
-			return 1;
-		}
-		++*i;
-	}
-	
-	// get size modifier if present.
-	enum SizeMod SizeMod = SM_8;
-	if (Data->Data[*i] == '\'')
-	{
-		++*i;
-		size_t ModLb = *i;
-		
-		while (isalnum(Data->Data[*i]) || Data->Data[*i] == '_')
-			++*i;
-		
-		if (*i - ModLb == 2 && !strncmp(&Data->Data[ModLb], "32", 2))
-			SizeMod = SM_32;
-		else if (*i - ModLb == 2 && !strncmp(&Data->Data[ModLb], "16", 2))
-			SizeMod = SM_16;
-		else if (*i - ModLb == 1 && !strncmp(&Data->Data[ModLb], "8", 1))
-			SizeMod = SM_8;
-		else
-		{
-			LogProgErr(Data, Lb, 1, "character literal has invalid size modifier!");
-			free(ChData);
-			return 1;
-		}
-	}
-	
-	*Out = (struct Token)
-	{
-		.Data.Int = ChData[0],
-		.Pos = Lb,
-		.Len = *i - Lb,
-		.SizeMod = SizeMod,
-		.Type = TT_LIT_INT
-	};
-	free(ChData);
-	
-	return 0;
-}
-
-static void
-LexData_AddSpecialChar(
-	struct LexData *Out,
-	size_t Pos,
-	size_t Len,
-	enum TokenType Type
-)
-{
-	struct Token Tok =
-	{
-		.Pos = Pos,
-		.Len = Len,
-		.Type = Type
-	};
-	LexData_AddToken(Out, &Tok);
-}
-
-static void
-LexData_AddToken(struct LexData *Out, struct Token const *Tok)
-{
-	++Out->TokCnt;
-	Out->Toks = reallocarray(Out->Toks, Out->TokCnt, sizeof(struct Token));
-	Out->Toks[Out->TokCnt - 1] = *Tok;
-}
-
-static void
-LexData_Destroy(struct LexData *Data)
-{
-	for (size_t i = 0; i < Data->TokCnt; ++i)
-		Token_Destroy(&Data->Toks[i]);
-	free(Data->Toks);
-}
-
-static int
-LexString(struct FileData const *Data, struct Token *Out, size_t *i)
+LexString(struct LexData *Out, struct FileData const *Data, size_t *i)
 {
 	size_t Lb = *i;
 	
@@ -2511,9 +9185,16 @@ LexString(struct FileData const *Data, struct Token *Out, size_t *i)
 	size_t StrDataLen;
 	DynStr_Init(&StrData, &StrDataLen);
 	
-	// get string data and length.
+	// get string data and length, copying over runs of plain characters at
+	// once.
 	for (++*i; *i < Data->Len; ++*i)
 	{
+		size_t RunEnd = Scan(Data->Data, Data->Len, *i, SC_STR_SPECIAL);
+		DynStr_AppendBuf(&StrData, &StrDataLen, &Data->Data[*i], RunEnd - *i);
+		*i = RunEnd;
+		if (*i >= Data->Len)
+			break;
+		
 		if (Data->Data[*i] == '"')
 		{
 			++*i;
@@ -2529,8 +9210,6 @@ LexString(struct FileData const *Data, struct Token *Out, size_t *i)
 			}
 			--*i;
 		}
-		else
-			DynStr_AppendChar(&StrData, &StrDataLen, Data->Data[*i]);
 	}
 	
 	// get size modifier if present.
@@ -2557,21 +9236,22 @@ LexString(struct FileData const *Data, struct Token *Out, size_t *i)
 		}
 	}
 	
-	*Out = (struct Token)
+	struct Token Tok =
 	{
-		.Data.Str.Text = StrData,
-		.Data.Str.Len = StrDataLen,
 		.Pos = Lb,
 		.Len = *i - Lb,
+		.Payload = LexData_AddStr(Out, Interner_Add(StrData, StrDataLen), StrDataLen),
 		.SizeMod = SizeMod,
 		.Type = TT_LIT_STR
 	};
+	LexData_AddToken(Out, &Tok);
+	free(StrData);
 	
 	return 0;
 }
 
 static int
-LexNum(struct FileData const *Data, struct Token *Out, size_t *i)
+LexNum(struct LexData *Out, struct FileData const *Data, size_t *i)
 {
 	size_t Lb = *i;
 	
@@ -2713,27 +9393,29 @@ LexNum(struct FileData const *Data, struct Token *Out, size_t *i)
 	
 	// yield successful token and write data based on literal type.
 	{
-		*Out = (struct Token)
+		// conversion stops at the size modifier or first non-digit.
+		union TokenNum Num;
+		if (DpCnt > 0)
+			Num.Float = strtod(&Data->Data[NumLb], NULL);
+		else
+			Num.Int = strtoull(&Data->Data[NumLb], NULL, NumBase);
+		
+		struct Token Tok =
 		{
 			.Pos = Lb,
 			.Len = Ub - Lb,
+			.Payload = LexData_AddNum(Out, Num),
 			.SizeMod = SizeMod,
 			.Type = DpCnt ? TT_LIT_FLOAT : TT_LIT_INT
 		};
-		
-		char *Str = Substr(Data->Data, NumLb, NumUb);
-		if (DpCnt > 0)
-			Out->Data.Float = atof(Str);
-		else
-			Out->Data.Int = strtoul(Str, NULL, NumBase);
-		free(Str);
+		LexData_AddToken(Out, &Tok);
 	}
 	
 	return 0;
 }
 
 static int
-LexWord(struct FileData const *Data, struct Token *Out, size_t *i)
+LexWord(struct LexData *Out, struct FileData const *Data, size_t *i)
 {
 	bool IsRaw = Data->Data[*i] == '@';
 	*i += IsRaw;
@@ -2747,132 +9429,265 @@ LexWord(struct FileData const *Data, struct Token *Out, size_t *i)
 			return 1;
 		}
 		
-		while (isalnum(Data->Data[*i]) || Data->Data[*i] == '_')
-			++*i;
+		*i = Scan(Data->Data, Data->Len, *i, SC_NON_IDENT);
+	}
+	
+	// determine word contents and token type.
+	char const *Word = &Data->Data[Lb];
+	size_t WordLen = *i - Lb;
+	enum TokenType Type = TT_IDENT;
+	if (!IsRaw && isupper(Word[0]))
+	{
+		// `Word[1]` is always readable due to null termination of data.
+		enum TokenType Kw = KeywordTable[KEYWORD_HASH(Word[0], Word[1], Word[WordLen - 1], WordLen)];
+		if (Kw != TT_IDENT)
+		{
+			char const *KwStr = Keywords[Kw - TT_KW_FIRST__];
+			if (!strncmp(Word, KwStr, WordLen) && !KwStr[WordLen])
+				Type = Kw;
+		}
+	}
+	
+	// output token, accounting for keyword literals.
+	{
+		struct Token Tok =
+		{
+			.Pos = Lb,
+			.Len = *i - Lb,
+			.Type = Type
+		};
+		
+		if (Type == TT_KW_TRUE || Type == TT_KW_FALSE)
+		{
+			Tok.Payload = Type == TT_KW_TRUE;
+			Tok.Type = TT_LIT_BOOL;
+		}
+		else if (Type == TT_IDENT)
+			Tok.Payload = LexData_AddStr(Out, Interner_Add(Word, WordLen), WordLen);
+		
+		LexData_AddToken(Out, &Tok);
 	}
 	
-	// determine word contents and token type.
-	char *Word = Substr(Data->Data, Lb, *i);
-	enum TokenType Type = TT_IDENT;
-	if (!IsRaw)
-	{
-		for (size_t Kw = TT_KW_FIRST__; Kw <= TT_KW_LAST__; ++Kw)
-		{
-			if (!strcmp(Word, Keywords[Kw - TT_KW_FIRST__]))
-			{
-				Type = Kw;
-				break;
-			}
-		}
-	}
+	return 0;
+}
+
+int
+Lithic_AddModulePath(struct Lithic *Lithic, char const *Dir)
+{
+	if (Lithic->Conf.ModulePathCnt >= MAX_MODULE_PATHS)
+		return 1;
+	
+	Lithic->Conf.ModulePaths[Lithic->Conf.ModulePathCnt++] = strdup(Dir);
+	return 0;
+}
+
+int
+Lithic_Compile(struct Lithic *Lithic, char const *Name, char const *Data, size_t Len)
+{
+	// contexts may be driven from within a hook of another.
+	struct Lithic *PrevCtx = Ctx;
+	Ctx = Lithic;
+	
+	char *Copy = malloc(Len + 1);
+	memcpy(Copy, Data, Len);
+	
+	struct FileData FileData = {0};
+	FileData_FromBuf(&FileData, Name, Copy, Len);
+	int Rc = CompileModule(&FileData);
+	
+	Ctx = PrevCtx;
+	return Rc;
+}
+
+struct Lithic *
+Lithic_Create(void)
+{
+	pthread_once(&ScanOnce, Scan_Init);
 	
-	// output token, accounting for keyword literals.
+	struct Lithic *Lithic = calloc(1, sizeof(struct Lithic));
+	pthread_mutex_init(&Lithic->TimeData.Lock, NULL);
+	pthread_mutex_init(&Lithic->Interner.Lock, NULL);
+	pthread_mutex_init(&Lithic->HookLock, NULL);
+	
+	long CpuCnt = sysconf(_SC_NPROCESSORS_ONLN);
+	Lithic->Conf.JobCnt = CpuCnt > 0 ? CpuCnt : 1;
+	Lithic->Conf.OutFile = "stdout";
+	Lithic->Conf.OutFp = stdout;
+	
+	return Lithic;
+}
+
+void
+Lithic_Destroy(struct Lithic *Lithic)
+{
+	// free allocated memory.
 	{
-		if (Type == TT_KW_TRUE || Type == TT_KW_FALSE)
-		{
-			free(Word);
-			*Out = (struct Token)
-			{
-				.Data.Bool = Type == TT_KW_TRUE,
-				.Pos = Lb,
-				.Len = *i - Lb,
-				.Type = TT_LIT_BOOL
-			};
-		}
-		else if (Type >= TT_KW_FIRST__ && Type <= TT_KW_LAST__)
-		{
-			free(Word);
-			*Out = (struct Token)
-			{
-				.Pos = Lb,
-				.Len = *i - Lb,
-				.Type = Type,
-			};
-		}
-		else
-		{
-			*Out = (struct Token)
-			{
-				.Data.Str.Text = Word,
-				.Data.Str.Len = *i - Lb,
-				.Pos = Lb,
-				.Len = *i - Lb,
-				.Type = Type
-			};
-		}
+		for (size_t i = 0; i < Lithic->Conf.ModulePathCnt; ++i)
+			free((char *)Lithic->Conf.ModulePaths[i]);
+		free(Lithic->TimeData.Events);
+		Interner_Destroy(&Lithic->Interner);
+		pthread_mutex_destroy(&Lithic->TimeData.Lock);
+		pthread_mutex_destroy(&Lithic->Interner.Lock);
+		pthread_mutex_destroy(&Lithic->HookLock);
+		free(Lithic);
 	}
+}
+
+int
+Lithic_SetConfFlag(struct Lithic *Lithic, char const *Flag)
+{
+	if (!strcmp(Flag, "no-float"))
+		Lithic->Conf.Flags |= CF_NO_FLOAT;
+	else if (!strcmp(Flag, "unity"))
+		Lithic->Conf.Flags |= CF_UNITY;
+	else
+		return 1;
 	
 	return 0;
 }
 
-static size_t
-LineNumber(char const *Str, size_t Pos)
+void
+Lithic_SetDiagSink(struct Lithic *Lithic, LithicDiagSink Sink, void *User)
+{
+	Lithic->Sink = Sink;
+	Lithic->SinkUser = User;
+}
+
+void
+Lithic_SetJobs(struct Lithic *Lithic, unsigned JobCnt)
+{
+	Lithic->Conf.JobCnt = JobCnt ? JobCnt : 1;
+}
+
+void
+Lithic_SetOutput(struct Lithic *Lithic, FILE *Fp)
+{
+	Lithic->Conf.OutFile = "output";
+	Lithic->Conf.OutFp = Fp;
+}
+
+void
+Lithic_SetResolver(struct Lithic *Lithic, LithicResolver Resolver, void *User)
 {
-	size_t Line = 1;
-	for (size_t i = 0; i < Pos; ++i)
-		Line += Str[i] == '\n';
-	return Line;
+	Lithic->Resolver = Resolver;
+	Lithic->ResolverUser = User;
 }
 
 static void
 LogAstNodeContext(
-	struct FileData const *Data,
-	struct AstNode const *Node,
+	struct ModuleData const *Mod,
+	uint32_t Node,
 	char const *Fmt,
 	...
 )
 {
+	if (LogMuted)
+		return;
+	
+	char *Msg;
+	size_t MsgLen;
+	FILE *Fp = LogOpen(&Msg, &MsgLen);
+	
 	// write out context message.
 	{
 		va_list Args;
 		va_start(Args, Fmt);
 		
-		fprintf(stderr, "%s \x1b[1;36mcontext\x1b[0m: ", Data->Name);
-		vfprintf(stderr, Fmt, Args);
-		fprintf(stderr, "\n");
+		fprintf(Fp, "%s \x1b[1;36mcontext\x1b[0m: ", Mod->File.Name);
+		vfprintf(Fp, Fmt, Args);
+		fprintf(Fp, "\n");
 		
 		va_end(Args);
 	}
 	
-	struct Token const *FirstTok = Node->Toks[0];
-	LogProgPosition(Data, FirstTok->Pos, FirstTok->Len, "1;36");
+	struct Token const *FirstTok = FlatAst_Token(&Mod->Ast, Node, 0);
+	LogProgPosition(Fp, &Mod->File, FirstTok->Pos, FirstTok->Len, "1;36");
+	
+	LogClose(Fp, &Msg, &MsgLen);
 }
 
 static void
 LogAstNodeErr(
-	struct FileData const *Data,
-	struct AstNode const *Node,
+	struct ModuleData const *Mod,
+	uint32_t Node,
 	char const *Fmt,
 	...
 )
 {
+	if (LogMuted)
+		return;
+	
+	char *Msg;
+	size_t MsgLen;
+	FILE *Fp = LogOpen(&Msg, &MsgLen);
+	
 	// write out error message.
 	{
 		va_list Args;
 		va_start(Args, Fmt);
 		
-		fprintf(stderr, "%s \x1b[1;31merr\x1b[0m: ", Data->Name);
-		vfprintf(stderr, Fmt, Args);
-		fprintf(stderr, "\n");
+		fprintf(Fp, "%s \x1b[1;31merr\x1b[0m: ", Mod->File.Name);
+		vfprintf(Fp, Fmt, Args);
+		fprintf(Fp, "\n");
 		
 		va_end(Args);
 	}
 	
-	struct Token const *FirstTok = Node->Toks[0];
-	LogProgPosition(Data, FirstTok->Pos, FirstTok->Len, "1;31");
+	struct Token const *FirstTok = FlatAst_Token(&Mod->Ast, Node, 0);
+	LogProgPosition(Fp, &Mod->File, FirstTok->Pos, FirstTok->Len, "1;31");
+	
+	LogClose(Fp, &Msg, &MsgLen);
+}
+
+static void
+LogClose(FILE *Fp, char **Msg, size_t *MsgLen)
+{
+	if (Fp == stderr)
+		return;
+	
+	fclose(Fp);
+	if (Ctx && Ctx->Sink)
+	{
+		pthread_mutex_lock(&Ctx->HookLock);
+		Ctx->Sink(Ctx->SinkUser, *Msg, *MsgLen);
+		pthread_mutex_unlock(&Ctx->HookLock);
+	}
+	else
+		fwrite(*Msg, 1, *MsgLen, stderr);
+	free(*Msg);
 }
 
 static void
 LogErr(char const *Fmt, ...)
 {
+	if (LogMuted)
+		return;
+	
+	char *Msg;
+	size_t MsgLen;
+	FILE *Fp = LogOpen(&Msg, &MsgLen);
+	
 	va_list Args;
 	va_start(Args, Fmt);
 	
-	fprintf(stderr, "\x1b[1;31merr\x1b[0m: ");
-	vfprintf(stderr, Fmt, Args);
-	fprintf(stderr, "\n");
+	fprintf(Fp, "\x1b[1;31merr\x1b[0m: ");
+	vfprintf(Fp, Fmt, Args);
+	fprintf(Fp, "\n");
 	
 	va_end(Args);
+	
+	LogClose(Fp, &Msg, &MsgLen);
+}
+
+static FILE *
+LogOpen(char **Msg, size_t *MsgLen)
+{
+	// messages are built up in memory and written out by `LogClose` at once,
+	// so that messages from concurrently loaded modules do not interleave
+	// and each one costs a single write. should that fail, fall back to
+	// writing directly.
+	FILE *Fp = open_memstream(Msg, MsgLen);
+	return Fp ? Fp : stderr;
 }
 
 static void
@@ -2884,68 +9699,75 @@ LogProgErr(
 	...
 )
 {
+	if (LogMuted)
+		return;
+	
+	char *Msg;
+	size_t MsgLen;
+	FILE *Fp = LogOpen(&Msg, &MsgLen);
+	
 	// write out error message.
 	{
 		va_list Args;
 		va_start(Args, Fmt);
 		
-		fprintf(stderr, "%s \x1b[1;31merr\x1b[0m: ", Data->Name);
-		vfprintf(stderr, Fmt, Args);
-		fprintf(stderr, "\n");
+		fprintf(Fp, "%s \x1b[1;31merr\x1b[0m: ", Data->Name);
+		vfprintf(Fp, Fmt, Args);
+		fprintf(Fp, "\n");
 		
 		va_end(Args);
 	}
 	
-	LogProgPosition(Data, Pos, Len, "1;31");
+	LogProgPosition(Fp, Data, Pos, Len, "1;31");
+	
+	LogClose(Fp, &Msg, &MsgLen);
 }
 
 static void
 LogProgPosition(
+	FILE *Fp,
 	struct FileData const *Data,
 	size_t Pos,
 	size_t Len,
 	char const *HlStyle
 )
 {
-	size_t Begin = Pos;
-	while (Begin > 0 && Data->Data[Begin - 1] != '\n')
-		--Begin;
+	size_t Line = FileData_FindLine(Data, Pos);
+	size_t Begin = Data->Lines[Line];
+	size_t End = Line + 1 < Data->LineCnt ? Data->Lines[Line + 1] - 1 : Data->Len;
 	
-	// write out line contents.
+	// write out line contents, with tabs shown as single spaces to keep the
+	// highlight aligned.
 	{
-		size_t End = Pos;
-		while (End < Data->Len && Data->Data[End] != '\n')
-			++End;
-		
 		fprintf(
-			stderr,
+			Fp,
 			"\x1b[2m[line %zu (byte %zu)]\n"
 			"|\x1b[0m ",
-			LineNumber(Data->Data, Pos),
+			Line + 1,
 			Pos
 		);
 		
+		size_t RunBegin = Begin;
 		for (size_t i = Begin; i < End; ++i)
 		{
-			fprintf(
-				stderr,
-				"%c",
-				Data->Data[i] == '\t' ? ' ' : Data->Data[i]
-			);
+			if (Data->Data[i] == '\t')
+			{
+				fwrite(&Data->Data[RunBegin], 1, i - RunBegin, Fp);
+				fputc(' ', Fp);
+				RunBegin = i + 1;
+			}
 		}
+		fwrite(&Data->Data[RunBegin], 1, End - RunBegin, Fp);
 		
-		fprintf(stderr, "\n\x1b[2m|\x1b[0m ");
+		fprintf(Fp, "\n\x1b[2m|\x1b[0m ");
 	}
 	
 	// write out highlight indicator.
 	{
-		for (size_t i = Begin; i < Pos; ++i)
-			fprintf(stderr, " ");
-		
-		fprintf(stderr, "\x1b[%sm^", HlStyle);
+		fprintf(Fp, "%*s\x1b[%sm^", (int)(Pos - Begin), "", HlStyle);
 		for (size_t i = 1; i < Len; ++i)
-			fprintf(stderr, "~");
-		fprintf(stderr, "\x1b[0m\n");
+			fputc('~', Fp);
+		fprintf(Fp, "\x1b[0m\n");
 	}
 }
 
@@ -2957,78 +9779,460 @@ LogTokErr(
 	...
 )
 {
+	if (LogMuted)
+		return;
+	
+	char *Msg;
+	size_t MsgLen;
+	FILE *Fp = LogOpen(&Msg, &MsgLen);
+	
 	// write out error message.
 	{
 		va_list Args;
 		va_start(Args, Fmt);
 		
-		fprintf(stderr, "%s \x1b[1;31merr\x1b[0m: ", Data->Name);
-		vfprintf(stderr, Fmt, Args);
-		fprintf(stderr, "\n");
+		fprintf(Fp, "%s \x1b[1;31merr\x1b[0m: ", Data->Name);
+		vfprintf(Fp, Fmt, Args);
+		fprintf(Fp, "\n");
 		
 		va_end(Args);
 	}
 	
-	LogProgPosition(Data, Tok->Pos, Tok->Len, "1;31");
+	LogProgPosition(Fp, Data, Tok->Pos, Tok->Len, "1;31");
+	
+	LogClose(Fp, &Msg, &MsgLen);
 }
 
 static void
 ModuleData_Destroy(struct ModuleData *Data)
 {
+	// resident modules are handed back to the server, along with any
+	// procedure bodies parsed since.
+	if (Data->Resident)
+	{
+		Server_Release(Data);
+		free(Data->FullPath);
+		free(Data->ImportName);
+		free(Data->Live);
+		return;
+	}
+	
 	// free resources.
 	{
-		AstNode_Destroy(&Data->Ast);
+		FlatAst_Destroy(&Data->Ast);
 		LexData_Destroy(&Data->Lex);
 		FileData_Destroy(&Data->File);
 		free(Data->FullPath);
+		free(Data->ImportName);
+		free(Data->Live);
+	}
+}
+
+static bool
+ModuleData_IsLive(struct ModuleData const *Mod, uint32_t Node)
+{
+	return !Mod->Live || (Node < Mod->LiveCnt && Mod->Live[Node]);
+}
+
+static uint32_t
+ModuleData_ProcBody(struct ModuleData *Mod, uint32_t Proc)
+{
+	// returns zero on failure.
+	
+	struct FlatAst *Ast = &Mod->Ast;
+	uint32_t Args = Ast->Nodes[Proc].FirstChild;
+	uint32_t ReturnType = Ast->Nodes[Args].NextSibling;
+	uint32_t Body = Ast->Nodes[ReturnType].NextSibling;
+	if (!(Ast->Nodes[Body].Flags & ANF_LAZY))
+		return Body;
+	
+	size_t Begin = Ast->Toks[Ast->Nodes[Body].FirstTok];
+	size_t End = Ast->Toks[Ast->Nodes[Body].FirstTok + 1];
+	
+	struct Arena Arena = {0};
+	struct ParseState Ps =
+	{
+		.File = &Mod->File,
+		.Lex = &Mod->Lex,
+		.Arena = &Arena,
+		.i = Begin - 1,
+		.End = End + 1
+	};
+	
+	struct AstNode StmtList = {0};
+	unsigned char Term[] = {TT_KW_END};
+	if (ParseStatementList(&StmtList, &Ps, Term, 1))
+	{
+		Arena_Destroy(&Arena);
+		return 0;
+	}
+	
+	// an eager parse would have ended the procedure at an earlier `End` and
+	// then rejected what follows.
+	if (Ps.i != End)
+	{
+		LogTokErr(&Mod->File, &Mod->Lex.Toks[Ps.i + 1], "expected global scope element!");
+		Arena_Destroy(&Arena);
+		return 0;
+	}
+	
+	// the parsed body is appended, taking the place of the lazy node.
+	Body = FlatAst_AddNode(Ast, &StmtList);
+	Ast->Nodes[ReturnType].NextSibling = Body;
+	Arena_Destroy(&Arena);
+	
+	return Body;
+}
+
+static void
+ModuleDataGroup_Append(
+	struct ModuleDataGroup *Group,
+	struct ModuleData const *Data
+)
+{
+	if (Group->ModuleCnt >= Group->ModuleCap)
+	{
+		Group->ModuleCap = Group->ModuleCap ? 2 * Group->ModuleCap : 8;
+		Group->Modules = reallocarray(
+			Group->Modules,
+			Group->ModuleCap,
+			sizeof(struct ModuleData)
+		);
+	}
+	Group->Modules[Group->ModuleCnt++] = *Data;
+}
+
+static void
+ModuleDataGroup_Destroy(struct ModuleDataGroup *Group)
+{
+	for (size_t i = 0; i < Group->ModuleCnt; ++i)
+		ModuleData_Destroy(&Group->Modules[i]);
+	free(Group->Modules);
+}
+
+static int
+ModuleLoad_Process(
+	struct ModuleLoad *Load,
+	unsigned Thread,
+	struct ModuleLoad **OutImports,
+	size_t *OutImportCnt
+)
+{
+	*OutImports = NULL;
+	*OutImportCnt = 0;
+	
+	// reuse modules kept resident by the server if they are unchanged.
+	uint64_t FindBegin = GetTimeNs();
+	if (Load->Fp && Server.Active && !Server_Find(&Load->Data, Load->Fp))
+	{
+		TimeData_AddEvent("read", Load->Data.File.Name, FindBegin, GetTimeNs(), Thread);
+		
+		fclose(Load->Fp);
+		free(Load->Path);
+		Load->Fp = NULL;
+		Load->Path = NULL;
+	}
+	
+	// read interface file in place of source if that is what was resolved.
+	size_t PathLen = Load->Path ? strlen(Load->Path) : 0;
+	if (Load->Fp && PathLen > 4 && !strcmp(&Load->Path[PathLen - 4], ".lci"))
+	{
+		uint64_t ReadBegin = GetTimeNs();
+		int Rc = Interface_Load(&Load->Data, Load->Fp, Load->Path);
+		
+		fclose(Load->Fp);
+		free(Load->Path);
+		Load->Fp = NULL;
+		Load->Path = NULL;
+		
+		if (Rc)
+			return 1;
+		
+		TimeData_AddEvent("read", Load->Data.File.Name, ReadBegin, GetTimeNs(), Thread);
+	}
+	
+	// read, lex and parse module if not already done.
+	if (Load->Path)
+	{
+		uint64_t ReadBegin = GetTimeNs();
+		struct stat Stat = {0};
+		struct FileData FileData = {0};
+		int Rc;
+		if (Load->Fp)
+		{
+			Rc = fstat(fileno(Load->Fp), &Stat) || FileData_Read(&FileData, Load->Fp, Load->Path);
+			fclose(Load->Fp);
+		}
+		else
+		{
+			FileData_FromBuf(&FileData, Load->Path, Load->Src, Load->SrcLen);
+			Rc = 0;
+		}
+		
+		bool FromFile = Load->Fp;
+		free(Load->Path);
+		Load->Fp = NULL;
+		Load->Src = NULL;
+		Load->Path = NULL;
+		
+		if (Rc)
+			return 1;
+		
+		// reuse the cached token stream and AST of identical source if there
+		// is one, and cache them otherwise.
+		uint64_t CacheBegin = GetTimeNs();
+		uint64_t SrcHash = Ctx->Conf.CacheDir || Server.Active ? HashStr(FileData.Data, FileData.Len) : 0;
+		
+		struct LexData LexData = {0};
+		struct FlatAst Ast = {0};
+		if (Ctx->Conf.CacheDir && !Cache_Load(&LexData, &Ast, &FileData, SrcHash))
+		{
+			TimeData_AddEvent("read", FileData.Name, ReadBegin, CacheBegin, Thread);
+			TimeData_AddEvent("cache", FileData.Name, CacheBegin, GetTimeNs(), Thread);
+		}
+		else
+		{
+			uint64_t LexBegin = GetTimeNs();
+			if (Lex(&LexData, &FileData))
+			{
+				FileData_Destroy(&FileData);
+				return 1;
+			}
+			
+			uint64_t ParseBegin = GetTimeNs();
+			if (Parse(&Ast, &FileData, &LexData, true))
+			{
+				LexData_Destroy(&LexData);
+				FileData_Destroy(&FileData);
+				return 1;
+			}
+			
+			uint64_t ParseEnd = GetTimeNs();
+			if (Ctx->Conf.CacheDir)
+				Cache_Store(&LexData, &Ast, &FileData, SrcHash);
+			
+			TimeData_AddEvent("read", FileData.Name, ReadBegin, CacheBegin, Thread);
+			TimeData_AddEvent("cache", FileData.Name, CacheBegin, LexBegin, Thread);
+			TimeData_AddEvent("lex", FileData.Name, LexBegin, ParseBegin, Thread);
+			TimeData_AddEvent("parse", FileData.Name, ParseBegin, ParseEnd, Thread);
+			TimeData_AddEvent("cache", FileData.Name, ParseEnd, GetTimeNs(), Thread);
+		}
+		
+		Load->Data.File = FileData;
+		Load->Data.Lex = LexData;
+		Load->Data.Ast = Ast;
+		
+		if (Server.Active && FromFile)
+			Server_Keep(&Load->Data, &Stat, SrcHash);
+	}
+	
+	// resolve and open every import of the module.
+	struct ModuleData const *Mod = &Load->Data;
+	struct FlatAst const *Ast = &Mod->Ast;
+	
+	size_t ImportCap = 0;
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+		ImportCap += Ast->Nodes[Child].Type == ANT_IMPORT;
+	
+	struct ModuleLoad *Imports = calloc(ImportCap, sizeof(struct ModuleLoad));
+	size_t ImportCnt = 0;
+	
+	for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+	{
+		if (Ast->Nodes[Child].Type != ANT_IMPORT)
+			continue;
+		
+		// a resolver supplies module source directly.
+		if (Ctx->Resolver)
+		{
+			char *Path = ImportPath(Ast, Child);
+			char *Src;
+			size_t SrcLen;
+			
+			pthread_mutex_lock(&Ctx->HookLock);
+			int Rc = Ctx->Resolver(Ctx->ResolverUser, Path, &Src, &SrcLen);
+			pthread_mutex_unlock(&Ctx->HookLock);
+			
+			if (Rc)
+			{
+				LogAstNodeErr(Mod, Child, "import path was unresolved!");
+				free(Path);
+				break;
+			}
+			
+			Imports[ImportCnt++] = (struct ModuleLoad)
+			{
+				.Src = Src,
+				.SrcLen = SrcLen,
+				.Path = Path,
+				.Data.FullPath = strdup(Path),
+				.Data.ImportName = strdup(Path)
+			};
+			continue;
+		}
+		
+		char *Path = ResolveImport(Ast, Child);
+		if (!Path)
+		{
+			LogAstNodeErr(Mod, Child, "import path was unresolved!");
+			break;
+		}
+		
+		FILE *Fp = OpenFile(Path, "rb");
+		if (!Fp)
+		{
+			LogAstNodeErr(Mod, Child, "failed to open module file for reading - '%s'!", Path);
+			free(Path);
+			break;
+		}
+		
+		Imports[ImportCnt++] = (struct ModuleLoad)
+		{
+			.Fp = Fp,
+			.Path = Path,
+			.Data.FullPath = FullPathname(Path),
+			.Data.ImportName = ImportPath(Ast, Child)
+		};
+	}
+	
+	// close already opened imports on failure.
+	if (ImportCnt != ImportCap)
+	{
+		for (size_t i = 0; i < ImportCnt; ++i)
+		{
+			if (Imports[i].Fp)
+				fclose(Imports[i].Fp);
+			free(Imports[i].Src);
+			free(Imports[i].Path);
+			free(Imports[i].Data.FullPath);
+			free(Imports[i].Data.ImportName);
+		}
+		free(Imports);
+		return 1;
+	}
+	
+	*OutImports = Imports;
+	*OutImportCnt = ImportCnt;
+	return 0;
+}
+
+static void *
+ModuleLoader_Work(void *Arg)
+{
+	struct ModuleLoader *Loader = Arg;
+	Ctx = Loader->Ctx;
+	
+	pthread_mutex_lock(&Loader->Lock);
+	
+	// the calling thread is always reported as thread 0.
+	unsigned Thread = pthread_equal(pthread_self(), Loader->Owner) ? 0 : ++Loader->ThreadCnt;
+	for (;;)
+	{
+		// wait until there is a module to load or until all are loaded.
+		while (!Loader->Failed
+			&& Loader->NextLoad >= Loader->LoadCnt
+			&& Loader->BusyCnt > 0)
+		{
+			pthread_cond_wait(&Loader->Cond, &Loader->Lock);
+		}
+		
+		if (Loader->Failed || Loader->NextLoad >= Loader->LoadCnt)
+			break;
+		
+		size_t Ind = Loader->NextLoad++;
+		++Loader->BusyCnt;
+		struct ModuleLoad Load = Loader->Loads[Ind];
+		pthread_mutex_unlock(&Loader->Lock);
+		
+		struct ModuleLoad *Imports;
+		size_t ImportCnt;
+		int Rc = ModuleLoad_Process(&Load, Thread, &Imports, &ImportCnt);
+		
+		pthread_mutex_lock(&Loader->Lock);
+		
+		// `Loads` may have been moved while processing.
+		Load.Imports = calloc(ImportCnt, sizeof(size_t));
+		Load.ImportCnt = ImportCnt;
+		Loader->Loads[Ind] = Load;
+		Loader->Failed |= Rc;
+		
+		// queue newly discovered modules, ignoring those with duplicate paths.
+		for (size_t i = 0; i < ImportCnt; ++i)
+		{
+			size_t Dup = 0;
+			while (Dup < Loader->LoadCnt
+				&& strcmp(Imports[i].Data.FullPath, Loader->Loads[Dup].Data.FullPath))
+			{
+				++Dup;
+			}
+			
+			if (Dup < Loader->LoadCnt)
+			{
+				if (Imports[i].Fp)
+					fclose(Imports[i].Fp);
+				free(Imports[i].Src);
+				free(Imports[i].Path);
+				free(Imports[i].Data.FullPath);
+				free(Imports[i].Data.ImportName);
+			}
+			else
+			{
+				if (Loader->LoadCnt >= Loader->LoadCap)
+				{
+					Loader->LoadCap *= 2;
+					Loader->Loads = reallocarray(
+						Loader->Loads,
+						Loader->LoadCap,
+						sizeof(struct ModuleLoad)
+					);
+				}
+				Loader->Loads[Loader->LoadCnt++] = Imports[i];
+			}
+			
+			Loader->Loads[Ind].Imports[i] = Dup;
+		}
+		free(Imports);
+		
+		--Loader->BusyCnt;
+		pthread_cond_broadcast(&Loader->Cond);
 	}
-}
-
-static void
-ModuleDataGroup_Append(
-	struct ModuleDataGroup *Group,
-	struct ModuleData const *Data
-)
-{
-	++Group->ModuleCnt;
-	Group->Modules = reallocarray(
-		Group->Modules,
-		Group->ModuleCnt,
-		sizeof(struct ModuleData)
-	);
-	Group->Modules[Group->ModuleCnt - 1] = *Data;
-}
-
-static void
-ModuleDataGroup_Destroy(struct ModuleDataGroup *Group)
-{
-	for (size_t i = 0; i < Group->ModuleCnt; ++i)
-		ModuleData_Destroy(&Group->Modules[i]);
-	free(Group->Modules);
+	
+	pthread_mutex_unlock(&Loader->Lock);
+	return NULL;
 }
 
 static struct Token const *
 NextToken(struct ParseState *Ps)
 {
 	++Ps->i;
-	struct Token const *Tok = Ps->i >= Ps->Lex->TokCnt ? NULL : &Ps->Lex->Toks[Ps->i];
+	struct Token const *Tok = Ps->i >= Ps->End ? NULL : &Ps->Lex->Toks[Ps->i];
 	return Tok;
 }
 
 static FILE *
 OpenFile(char const *File, char const *Mode)
 {
+	FILE *Fp = fopen(File, Mode);
+	if (!Fp)
+		return NULL;
+	
+	// directories can be opened for reading but have no data to lex.
 	struct stat Stat;
-	if (stat(File, &Stat) || !S_ISREG(Stat.st_mode))
+	if (fstat(fileno(Fp), &Stat) || S_ISDIR(Stat.st_mode))
+	{
+		fclose(Fp);
 		return NULL;
-	return fopen(File, Mode);
+	}
+	
+	return Fp;
 }
 
 static int
 Parse(
-	struct AstNode *Out,
+	struct FlatAst *Out,
 	struct FileData const *File,
-	struct LexData const *Lex
+	struct LexData const *Lex,
+	bool Lazy
 )
 {
 	if (Lex->TokCnt == 0)
@@ -3037,15 +10241,36 @@ Parse(
 		return 1;
 	}
 	
+	// parallel and lazy parses of large or imported programs are only
+	// attempted, with errors reported by the sequential eager parse.
+	size_t ChunkCnt = Lex->TokCnt / PARSE_CHUNK_MIN;
+	if (ChunkCnt > Ctx->Conf.JobCnt)
+		ChunkCnt = Ctx->Conf.JobCnt;
+	if (ChunkCnt == 0)
+		ChunkCnt = 1;
+	if ((ChunkCnt > 1 || Lazy) && !ParseChunked(Out, File, Lex, ChunkCnt, Lazy))
+		return 0;
+	
+	struct Arena Arena = {0};
 	struct ParseState Ps =
 	{
 		.File = File,
 		.Lex = Lex,
+		.Arena = &Arena,
 		.i = -1,
+		.End = Lex->TokCnt
 	};
 	
-	if (ParseProgram(Out, &Ps))
+	struct FlatAst Ast;
+	if (ParseProgram(&Ast, &Ps))
+	{
+		FlatAst_Destroy(&Ast);
+		Arena_Destroy(&Arena);
 		return 1;
+	}
+	
+	*Out = Ast;
+	Arena_Destroy(&Arena);
 	
 	return 0;
 }
@@ -3066,32 +10291,20 @@ ParseArgList(struct AstNode *Out, struct ParseState *Ps)
 	{
 		struct Token const *Next = RequireToken(Ps);
 		if (!Next)
-		{
-			AstNode_Destroy(&ArgList);
 			return 1;
-		}
 		
 		switch (Next->Type)
 		{
 		case TT_TRIPLE_PERIOD:
 			if (!ExpectToken(Ps, TT_PEND))
-			{
-				AstNode_Destroy(&ArgList);
 				return 1;
-			}
 			ArgList.Flags |= ANF_VARIADIC;
 			goto Done;
 		case TT_KW_BASE:
 			if (!ExpectToken(Ps, TT_TRIPLE_PERIOD))
-			{
-				AstNode_Destroy(&ArgList);
 				return 1;
-			}
 			if (!ExpectToken(Ps, TT_PEND))
-			{
-				AstNode_Destroy(&ArgList);
 				return 1;
-			}
 			ArgList.Flags |= ANF_BASE;
 			ArgList.Flags |= ANF_VARIADIC;
 			goto Done;
@@ -3102,19 +10315,16 @@ ParseArgList(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode ArgType = {0};
 			unsigned char Term[] = {TT_COMMA, TT_PEND};
 			if (ParseWrappedType(&ArgType, Ps, Term, 2))
-			{
-				AstNode_Destroy(&ArgList);
 				return 1;
-			}
 			
 			struct AstNode Arg =
 			{
 				.Type = ANT_ARG
 			};
-			AstNode_AddChild(&Arg, &ArgType);
-			AstNode_AddToken(&Arg, Next);
+			AstNode_AddChild(&Arg, &ArgType, Ps->Arena);
+			AstNode_AddToken(&Arg, Next, Ps->Arena);
 			
-			AstNode_AddChild(&ArgList, &Arg);
+			AstNode_AddChild(&ArgList, &Arg, Ps->Arena);
 			
 			if (Ps->Lex->Toks[Ps->i].Type == TT_PEND)
 				goto Done;
@@ -3125,7 +10335,6 @@ ParseArgList(struct AstNode *Out, struct ParseState *Ps)
 			if (PeekPrevToken(Ps)->Type == TT_COMMA)
 			{
 				LogTokErr(Ps->File, Next, "expected another argument, found TT_PEND!");
-				AstNode_Destroy(&ArgList);
 				return 1;
 			}
 			goto Done;
@@ -3134,19 +10343,16 @@ ParseArgList(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode ArgType = {0};
 			unsigned char Term[] = {TT_COMMA, TT_PEND};
 			if (ParseWrappedType(&ArgType, Ps, Term, 2))
-			{
-				AstNode_Destroy(&ArgList);
 				return 1;
-			}
 			
 			struct AstNode Arg =
 			{
 				.Type = ANT_ARG
 			};
-			AstNode_AddChild(&Arg, &ArgType);
-			AstNode_AddToken(&Arg, Next);
+			AstNode_AddChild(&Arg, &ArgType, Ps->Arena);
+			AstNode_AddToken(&Arg, Next, Ps->Arena);
 			
-			AstNode_AddChild(&ArgList, &Arg);
+			AstNode_AddChild(&ArgList, &Arg, Ps->Arena);
 			
 			if (Ps->Lex->Toks[Ps->i].Type == TT_PEND)
 				goto Done;
@@ -3155,12 +10361,11 @@ ParseArgList(struct AstNode *Out, struct ParseState *Ps)
 		}
 		default:
 			LogTokErr(Ps->File, Next, "expected TT_TRIPLE_PERIOD, TT_KW_BASE, or TT_IDENT!");
-			AstNode_Destroy(&ArgList);
 			return 1;
 		}
 	}
 Done:
-	AstNode_AddToken(&ArgList, FirstTok);
+	AstNode_AddToken(&ArgList, FirstTok, Ps->Arena);
 	*Out = ArgList;
 	
 	return 0;
@@ -3199,10 +10404,10 @@ ParseBlock(struct AstNode *Out, struct ParseState *Ps)
 			return 1;
 	}
 	
-	AstNode_AddChild(&Block, &StmtList);
-	AstNode_AddToken(&Block, FirstTok);
+	AstNode_AddChild(&Block, &StmtList, Ps->Arena);
+	AstNode_AddToken(&Block, FirstTok, Ps->Arena);
 	if (Name)
-		AstNode_AddToken(&Block, Name);
+		AstNode_AddToken(&Block, Name, Ps->Arena);
 	
 	*Out = Block;
 	
@@ -3231,13 +10436,202 @@ ParseBreak(struct AstNode *Out, struct ParseState *Ps)
 		return 1;
 	
 	Out->Type = ANT_BREAK;
-	AstNode_AddToken(Out, FirstTok);
+	AstNode_AddToken(Out, FirstTok, Ps->Arena);
 	if (Name)
-		AstNode_AddToken(Out, Name);
+		AstNode_AddToken(Out, Name, Ps->Arena);
 	
 	return 0;
 }
 
+static void *
+ParseChunk_Work(void *Arg)
+{
+	struct ParseChunk *Chunk = Arg;
+	Ctx = Chunk->Ctx;
+	
+	// a failed chunk is reparsed sequentially, so its errors are not reported
+	// here.
+	bool WasMuted = LogMuted;
+	LogMuted = true;
+	
+	struct ParseState Ps =
+	{
+		.File = Chunk->File,
+		.Lex = Chunk->Lex,
+		.Arena = &Chunk->Arena,
+		.i = Chunk->Begin - 1,
+		.End = Chunk->End,
+		.Lazy = Chunk->Lazy
+	};
+	Chunk->Failed = ParseProgram(&Chunk->Ast, &Ps);
+	
+	LogMuted = WasMuted;
+	
+	return NULL;
+}
+
+static int
+ParseChunked(
+	struct FlatAst *Out,
+	struct FileData const *File,
+	struct LexData const *Lex,
+	size_t ChunkCnt,
+	bool Lazy
+)
+{
+	// split tokens into up to `ChunkCnt` evenly sized chunks before top-level
+	// declaration keywords in the first column. declarations are assumed to
+	// indent their contents; where they do not, a split lands inside one and
+	// the chunk on either side fails to parse, so nothing is lost except time.
+	struct ParseChunk *Chunks = calloc(ChunkCnt, sizeof(struct ParseChunk));
+	size_t Cnt = 0;
+	{
+		size_t Begin = 0;
+		for (size_t i = 1; i < Lex->TokCnt && Cnt + 1 < ChunkCnt; ++i)
+		{
+			if (i < (Cnt + 1) * Lex->TokCnt / ChunkCnt)
+				continue;
+			
+			struct Token const *Tok = &Lex->Toks[i];
+			switch (Tok->Type)
+			{
+			case TT_KW_IMPORT:
+			case TT_KW_PROC:
+			case TT_KW_EXTERNPROC:
+			case TT_KW_VAR:
+			case TT_KW_EXTERNVAR:
+			case TT_KW_STRUCT:
+			case TT_KW_ENUM:
+			case TT_KW_UNION:
+				break;
+			default:
+				continue;
+			}
+			
+			if (Lex->Toks[i - 1].Type != TT_NEWLINE || File->Data[Tok->Pos - 1] != '\n')
+				continue;
+			
+			Chunks[Cnt++] = (struct ParseChunk)
+			{
+				.Ctx = Ctx,
+				.File = File,
+				.Lex = Lex,
+				.Begin = Begin,
+				.End = i,
+				.Lazy = Lazy
+			};
+			Begin = i;
+		}
+		
+		Chunks[Cnt++] = (struct ParseChunk)
+		{
+			.Ctx = Ctx,
+			.File = File,
+			.Lex = Lex,
+			.Begin = Begin,
+			.End = Lex->TokCnt,
+			.Lazy = Lazy
+		};
+	}
+	
+	// parse chunks on worker threads, with the calling thread taking the first
+	// chunk and any for which a thread cannot be created.
+	{
+		pthread_t *Workers = calloc(Cnt, sizeof(pthread_t));
+		bool *Threaded = calloc(Cnt, sizeof(bool));
+		
+		for (size_t i = 1; i < Cnt; ++i)
+			Threaded[i] = !pthread_create(&Workers[i], NULL, ParseChunk_Work, &Chunks[i]);
+		
+		for (size_t i = 0; i < Cnt; ++i)
+		{
+			if (!Threaded[i])
+				ParseChunk_Work(&Chunks[i]);
+		}
+		
+		for (size_t i = 0; i < Cnt; ++i)
+		{
+			if (Threaded[i])
+				pthread_join(Workers[i], NULL);
+		}
+		
+		free(Workers);
+		free(Threaded);
+	}
+	
+	bool Failed = false;
+	for (size_t i = 0; i < Cnt; ++i)
+		Failed = Failed || Chunks[i].Failed;
+	
+	// splice declarations into one program in source order, rebasing node and
+	// token indices of each chunk past those of its predecessors.
+	if (!Failed)
+	{
+		uint32_t NodeCnt = 1, TokCnt = 0;
+		for (size_t i = 0; i < Cnt; ++i)
+		{
+			NodeCnt += Chunks[i].Ast.NodeCnt - 1;
+			TokCnt += Chunks[i].Ast.TokCnt;
+		}
+		
+		*Out = (struct FlatAst)
+		{
+			.Nodes = calloc(NodeCnt, sizeof(struct FlatAstNode)),
+			.NodeCnt = 1,
+			.NodeCap = NodeCnt,
+			.Toks = calloc(TokCnt ? TokCnt : 1, sizeof(uint32_t)),
+			.TokCap = TokCnt,
+			.Lex = *Lex
+		};
+		Out->Nodes[0].Type = ANT_PROGRAM;
+		
+		uint32_t Prev = 0;
+		for (size_t i = 0; i < Cnt; ++i)
+		{
+			struct FlatAst *Ast = &Chunks[i].Ast;
+			uint32_t NodeBase = Out->NodeCnt - 1, TokBase = Out->TokCnt;
+			
+			for (uint32_t j = 1; j < Ast->NodeCnt; ++j)
+			{
+				struct FlatAstNode Node = Ast->Nodes[j];
+				Node.FirstChild += Node.FirstChild ? NodeBase : 0;
+				Node.NextSibling += Node.NextSibling ? NodeBase : 0;
+				Node.FirstTok += TokBase;
+				Out->Nodes[Out->NodeCnt++] = Node;
+			}
+			
+			if (Ast->TokCnt)
+				memcpy(&Out->Toks[TokBase], Ast->Toks, Ast->TokCnt * sizeof(uint32_t));
+			Out->TokCnt += Ast->TokCnt;
+			
+			for (uint32_t Child = Ast->Nodes[0].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+			{
+				if (Prev)
+					Out->Nodes[Prev].NextSibling = NodeBase + Child;
+				else
+					Out->Nodes[0].FirstChild = NodeBase + Child;
+				Prev = NodeBase + Child;
+			}
+			Out->Nodes[0].ChildCnt += Ast->Nodes[0].ChildCnt;
+			
+			FlatAst_Destroy(Ast);
+			*Ast = (struct FlatAst){0};
+		}
+	}
+	
+	// free allocated memory.
+	{
+		for (size_t i = 0; i < Cnt; ++i)
+		{
+			FlatAst_Destroy(&Chunks[i].Ast);
+			Arena_Destroy(&Chunks[i].Arena);
+		}
+		free(Chunks);
+	}
+	
+	return Failed;
+}
+
 static int
 ParseCondTree(struct AstNode *Out, struct ParseState *Ps)
 {
@@ -3267,7 +10661,7 @@ ParseCondTree(struct AstNode *Out, struct ParseState *Ps)
 		if (ParseWrappedExpr(&Cond, Ps, Term, 1))
 			return 1;
 		
-		AstNode_AddChild(&CondTree, &Cond);
+		AstNode_AddChild(&CondTree, &Cond, Ps->Arena);
 	}
 	
 	// condition tree body and children.
@@ -3275,12 +10669,9 @@ ParseCondTree(struct AstNode *Out, struct ParseState *Ps)
 		struct AstNode TruePath = {0};
 		unsigned char Term[] = {TT_KW_END, TT_KW_ELIF, TT_KW_ELSE};
 		if (ParseStatementList(&TruePath, Ps, Term, 3))
-		{
-			AstNode_Destroy(&CondTree);
 			return 1;
-		}
 		
-		AstNode_AddChild(&CondTree, &TruePath);
+		AstNode_AddChild(&CondTree, &TruePath, Ps->Arena);
 		
 		switch (Ps->Lex->Toks[Ps->i].Type)
 		{
@@ -3292,12 +10683,9 @@ ParseCondTree(struct AstNode *Out, struct ParseState *Ps)
 			
 			struct AstNode FalsePath = {0};
 			if (ParseCondTree(&FalsePath, Ps))
-			{
-				AstNode_Destroy(&CondTree);
 				return 1;
-			}
 			
-			AstNode_AddChild(&CondTree, &FalsePath);
+			AstNode_AddChild(&CondTree, &FalsePath, Ps->Arena);
 			
 			break;
 		}
@@ -3306,12 +10694,9 @@ ParseCondTree(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode FalsePath = {0};
 			unsigned char Term[] = {TT_KW_END};
 			if (ParseStatementList(&FalsePath, Ps, Term, 1))
-			{
-				AstNode_Destroy(&CondTree);
 				return 1;
-			}
 			
-			AstNode_AddChild(&CondTree, &FalsePath);
+			AstNode_AddChild(&CondTree, &FalsePath, Ps->Arena);
 			
 			break;
 		}
@@ -3347,9 +10732,9 @@ ParseContinue(struct AstNode *Out, struct ParseState *Ps)
 		return 1;
 	
 	Out->Type = ANT_CONTINUE;
-	AstNode_AddToken(Out, FirstTok);
+	AstNode_AddToken(Out, FirstTok, Ps->Arena);
 	if (Name)
-		AstNode_AddToken(Out, Name);
+		AstNode_AddToken(Out, Name, Ps->Arena);
 	
 	return 0;
 }
@@ -3366,8 +10751,8 @@ ParseDefer(struct AstNode *Out, struct ParseState *Ps)
 		return 1;
 	
 	Out->Type = ANT_DEFER;
-	AstNode_AddChild(Out, &Stmt);
-	AstNode_AddToken(Out, FirstTok);
+	AstNode_AddChild(Out, &Stmt, Ps->Arena);
+	AstNode_AddToken(Out, FirstTok, Ps->Arena);
 	
 	return 0;
 }
@@ -3401,8 +10786,8 @@ ParseEnum(struct AstNode *Out, struct ParseState *Ps)
 		if (ParseWrappedType(&Type, Ps, Term, 1))
 			return 1;
 		
-		AstNode_AddChild(&Enum, &Type);
-		AstNode_AddToken(&Enum, Name);
+		AstNode_AddChild(&Enum, &Type, Ps->Arena);
+		AstNode_AddToken(&Enum, Name, Ps->Arena);
 	}
 	
 	// get enum member information.
@@ -3411,17 +10796,11 @@ ParseEnum(struct AstNode *Out, struct ParseState *Ps)
 		SkipParseNewlines(Ps);
 		struct Token const *MembName = ExpectToken(Ps, TT_IDENT);
 		if (!MembName)
-		{
-			AstNode_Destroy(&Enum);
 			return 1;
-		}
 		
 		struct Token const *Next = RequireToken(Ps);
 		if (!Next)
-		{
-			AstNode_Destroy(&Enum);
 			return 1;
-		}
 		
 		struct AstNode Memb =
 		{
@@ -3435,34 +10814,27 @@ ParseEnum(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode Value = {0};
 			unsigned char Term[] = {TT_NEWLINE};
 			if (ParseWrappedExpr(&Value, Ps, Term, 1))
-			{
-				AstNode_Destroy(&Enum);
 				return 1;
-			}
 			
-			AstNode_AddChild(&Memb, &Value);
-			AstNode_AddToken(&Memb, MembName);
+			AstNode_AddChild(&Memb, &Value, Ps->Arena);
+			AstNode_AddToken(&Memb, MembName, Ps->Arena);
 			
-			AstNode_AddChild(&Enum, &Memb);
+			AstNode_AddChild(&Enum, &Memb, Ps->Arena);
 			
 			break;
 		}
 		case TT_NEWLINE:
-			AstNode_AddToken(&Memb, MembName);
-			AstNode_AddChild(&Enum, &Memb);
+			AstNode_AddToken(&Memb, MembName, Ps->Arena);
+			AstNode_AddChild(&Enum, &Memb, Ps->Arena);
 			break;
 		default:
-			AstNode_Destroy(&Enum);
 			LogTokErr(Ps->File, Next, "expected either TT_COLON_EQUAL or TT_NEWLINE!");
-			break;
+			return 1;
 		}
 		
 		Next = RequireToken(Ps);
 		if (!Next)
-		{
-			AstNode_Destroy(&Enum);
 			return 1;
-		}
 		
 		if (Next->Type == TT_KW_END)
 			break;
@@ -3501,7 +10873,7 @@ ParseExpr(
 	case TT_KW_VARGCOUNT:
 	case TT_KW_VARGS:
 		Lhs.Type = ANT_EXPR_ATOM;
-		AstNode_AddToken(&Lhs, Tok);
+		AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		break;
 	case TT_KW_BASE:
 	{
@@ -3515,7 +10887,7 @@ ParseExpr(
 		case TT_KW_VARGS:
 			Lhs.Type = ANT_EXPR_ATOM;
 			Lhs.Flags |= ANF_BASE;
-			AstNode_AddToken(&Lhs, Tok);
+			AstNode_AddToken(&Lhs, Modified, Ps->Arena);
 			break;
 		case TT_BKBEGIN:
 			--Ps->i;
@@ -3565,10 +10937,7 @@ ParseExpr(
 	{
 		Tok = RequireToken(Ps);
 		if (!Tok)
-		{
-			AstNode_Destroy(&Lhs);
 			return 1;
-		}
 		--Ps->i;
 		
 		for (size_t i = 0; i < TermCnt; ++i)
@@ -3586,17 +10955,13 @@ ParseExpr(
 			
 			struct AstNode NewLhs = {0};
 			if (ParseExprLed(&NewLhs, Ps, &Lhs, Term, TermCnt))
-			{
-				AstNode_Destroy(&Lhs);
 				return 1;
-			}
 			
 			Lhs = NewLhs;
 		}
 		else
 		{
 			LogTokErr(Ps->File, Tok, "expected left denotation!");
-			AstNode_Destroy(&Lhs);
 			return 1;
 		}
 	}
@@ -3627,14 +10992,11 @@ ParseExprLed(
 	{
 	case ANT_EXPR_CALL:
 	{
-		AstNode_AddChild(&NewLhs, Lhs);
+		AstNode_AddChild(&NewLhs, Lhs, Ps->Arena);
 		
 		struct Token const *Next = RequireToken(Ps);
 		if (!Next)
-		{
-			AstNode_Destroy(&NewLhs);
 			return 1;
-		}
 		
 		if (Next->Type != TT_PEND)
 		{
@@ -3645,20 +11007,17 @@ ParseExprLed(
 				struct AstNode Arg = {0};
 				unsigned char Term[] = {TT_COMMA, TT_PEND};
 				if (ParseExpr(&Arg, Ps, Term, 2, 0))
-				{
-					AstNode_Destroy(&NewLhs);
 					return 1;
-				}
 				++Ps->i;
 				
-				AstNode_AddChild(&NewLhs, &Arg);
+				AstNode_AddChild(&NewLhs, &Arg, Ps->Arena);
 				
 				if (Ps->Lex->Toks[Ps->i].Type == TT_PEND)
 					break;
 			}
 		}
 		
-		AstNode_AddToken(&NewLhs, Tok);
+		AstNode_AddToken(&NewLhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3672,9 +11031,9 @@ ParseExprLed(
 		if (ParseWrappedType(&Rhs, Ps, Term, 1))
 			return 1;
 		
-		AstNode_AddChild(&NewLhs, Lhs);
-		AstNode_AddChild(&NewLhs, &Rhs);
-		AstNode_AddToken(&NewLhs, Tok);
+		AstNode_AddChild(&NewLhs, Lhs, Ps->Arena);
+		AstNode_AddChild(&NewLhs, &Rhs, Ps->Arena);
+		AstNode_AddToken(&NewLhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3689,15 +11048,12 @@ ParseExprLed(
 		struct BindPower Bp = ExprBindPower[Type - ANT_EXPR];
 		struct AstNode Rhs = {0};
 		if (ParseExpr(&Rhs, Ps, Term, TermCnt, Bp.Right))
-		{
-			AstNode_Destroy(&Mhs);
 			return 1;
-		}
 		
-		AstNode_AddChild(&NewLhs, Lhs);
-		AstNode_AddChild(&NewLhs, &Mhs);
-		AstNode_AddChild(&NewLhs, &Rhs);
-		AstNode_AddToken(&NewLhs, Tok);
+		AstNode_AddChild(&NewLhs, Lhs, Ps->Arena);
+		AstNode_AddChild(&NewLhs, &Mhs, Ps->Arena);
+		AstNode_AddChild(&NewLhs, &Rhs, Ps->Arena);
+		AstNode_AddToken(&NewLhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3740,9 +11096,9 @@ ParseExprLed(
 		if (ParseExpr(&Rhs, Ps, Term, TermCnt, Bp.Right))
 			return 1;
 		
-		AstNode_AddChild(&NewLhs, Lhs);
-		AstNode_AddChild(&NewLhs, &Rhs);
-		AstNode_AddToken(&NewLhs, Tok);
+		AstNode_AddChild(&NewLhs, Lhs, Ps->Arena);
+		AstNode_AddChild(&NewLhs, &Rhs, Ps->Arena);
+		AstNode_AddToken(&NewLhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3750,8 +11106,8 @@ ParseExprLed(
 	case ANT_EXPR_POST_DEC:
 	case ANT_EXPR_ADDR_OF:
 	case ANT_EXPR_DEREF:
-		AstNode_AddChild(&NewLhs, Lhs);
-		AstNode_AddToken(&NewLhs, Tok);
+		AstNode_AddChild(&NewLhs, Lhs, Ps->Arena);
+		AstNode_AddToken(&NewLhs, Tok, Ps->Arena);
 		break;
 	default:
 		break;
@@ -3779,19 +11135,16 @@ ParseExprList(struct AstNode *Out, struct ParseState *Ps)
 		struct AstNode Item = {0};
 		unsigned char Term[] = {TT_COMMA, TT_BKEND};
 		if (ParseExpr(&Item, Ps, Term, 2, 0))
-		{
-			AstNode_Destroy(&List);
 			return 1;
-		}
 		++Ps->i;
 		
-		AstNode_AddChild(&List, &Item);
+		AstNode_AddChild(&List, &Item, Ps->Arena);
 		
 		if (Ps->Lex->Toks[Ps->i].Type == TT_BKEND)
 			break;
 	}
 	
-	AstNode_AddToken(&List, FirstTok);
+	AstNode_AddToken(&List, FirstTok, Ps->Arena);
 	*Out = List;
 	
 	return 0;
@@ -3820,27 +11173,21 @@ ParseExprNud(
 		struct AstNode ArgList = {0};
 		if (ParseArgList(&ArgList, Ps))
 			return 1;
-		AstNode_AddChild(&Lhs, &ArgList);
+		AstNode_AddChild(&Lhs, &ArgList, Ps->Arena);
 		
 		struct AstNode ReturnType = {0};
 		unsigned char ReturnTypeTerm[] = {TT_NEWLINE};
 		if (ParseWrappedType(&ReturnType, Ps, ReturnTypeTerm, 1))
-		{
-			AstNode_Destroy(&Lhs);
 			return 1;
-		}
-		AstNode_AddChild(&Lhs, &ReturnType);
+		AstNode_AddChild(&Lhs, &ReturnType, Ps->Arena);
 		
 		struct AstNode StmtList = {0};
 		unsigned char LambdaTerm[] = {TT_KW_END};
 		if (ParseStatementList(&StmtList, Ps, LambdaTerm, 1))
-		{
-			AstNode_Destroy(&Lhs);
 			return 1;
-		}
-		AstNode_AddChild(&Lhs, &StmtList);
+		AstNode_AddChild(&Lhs, &StmtList, Ps->Arena);
 		
-		AstNode_AddToken(&Lhs, Tok);
+		AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3865,7 +11212,7 @@ ParseExprNud(
 				return 1;
 			++Ps->i;
 			
-			AstNode_AddChild(&Lhs, &Rhs);
+			AstNode_AddChild(&Lhs, &Rhs, Ps->Arena);
 			
 			break;
 		}
@@ -3876,7 +11223,7 @@ ParseExprNud(
 			if (ParseWrappedType(&Rhs, Ps, Term, 1))
 				return 1;
 			
-			AstNode_AddChild(&Lhs, &Rhs);
+			AstNode_AddChild(&Lhs, &Rhs, Ps->Arena);
 			
 			break;
 		}
@@ -3885,7 +11232,7 @@ ParseExprNud(
 			return 1;
 		}
 		
-		AstNode_AddToken(&Lhs, Tok);
+		AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3900,8 +11247,8 @@ ParseExprNud(
 			return 1;
 		++Ps->i;
 		
-		AstNode_AddChild(&Lhs, &Rhs);
-		AstNode_AddToken(&Lhs, Tok);
+		AstNode_AddChild(&Lhs, &Rhs, Ps->Arena);
+		AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3915,8 +11262,8 @@ ParseExprNud(
 		if (ParseWrappedType(&Rhs, Ps, Term, 1))
 			return 1;
 		
-		AstNode_AddChild(&Lhs, &Rhs);
-		AstNode_AddToken(&Lhs, Tok);
+		AstNode_AddChild(&Lhs, &Rhs, Ps->Arena);
+		AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3932,13 +11279,13 @@ ParseExprNud(
 			if (ParseWrappedType(&Rhs, Ps, Term, 1))
 				return 1;
 			
-			AstNode_AddChild(&Lhs, &Rhs);
-			AstNode_AddToken(&Lhs, Tok);
+			AstNode_AddChild(&Lhs, &Rhs, Ps->Arena);
+			AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		}
 		else
 		{
 			Lhs.Type = ANT_EXPR_ATOM;
-			AstNode_AddToken(&Lhs, Tok);
+			AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		}
 		
 		break;
@@ -3955,8 +11302,8 @@ ParseExprNud(
 		if (ParseExpr(&Rhs, Ps, Term, TermCnt, Bp.Right))
 			return 1;
 		
-		AstNode_AddChild(&Lhs, &Rhs);
-		AstNode_AddToken(&Lhs, Tok);
+		AstNode_AddChild(&Lhs, &Rhs, Ps->Arena);
+		AstNode_AddToken(&Lhs, Tok, Ps->Arena);
 		
 		break;
 	}
@@ -3980,7 +11327,7 @@ ParseFor(struct AstNode *Out, struct ParseState *Ps)
 	{
 		.Type = ANT_FOR
 	};
-	AstNode_AddToken(&For, FirstTok);
+	AstNode_AddToken(&For, FirstTok, Ps->Arena);
 	
 	// get label data.
 	{
@@ -3990,11 +11337,8 @@ ParseFor(struct AstNode *Out, struct ParseState *Ps)
 			++Ps->i;
 			struct Token const *Name = ExpectToken(Ps, TT_IDENT);
 			if (!Name)
-			{
-				AstNode_Destroy(&For);
 				return 1;
-			}
-			AstNode_AddToken(&For, Name);
+			AstNode_AddToken(&For, Name, Ps->Arena);
 		}
 	}
 	
@@ -4006,60 +11350,42 @@ ParseFor(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode Init = {0};
 			unsigned char InitTerm[] = {TT_COMMA};
 			if (ParseVar(&Init, Ps, InitTerm, 1))
-			{
-				AstNode_Destroy(&For);
 				return 1;
-			}
-			AstNode_AddChild(&For, &Init);
+			AstNode_AddChild(&For, &Init, Ps->Arena);
 			
 			struct AstNode Cond = {0};
 			unsigned char CondTerm[] = {TT_COMMA};
 			if (ParseWrappedExpr(&Cond, Ps, CondTerm, 1))
-			{
-				AstNode_Destroy(&For);
 				return 1;
-			}
-			AstNode_AddChild(&For, &Cond);
+			AstNode_AddChild(&For, &Cond, Ps->Arena);
 			
 			struct AstNode Inc = {0};
 			unsigned char IncTerm[] = {TT_NEWLINE};
 			if (ParseWrappedExpr(&Inc, Ps, IncTerm, 1))
-			{
-				AstNode_Destroy(&For);
 				return 1;
-			}
-			AstNode_AddChild(&For, &Inc);
+			AstNode_AddChild(&For, &Inc, Ps->Arena);
 		}
 		else
 		{
 			struct AstNode FirstValue = {0};
 			unsigned char Term[] = {TT_NEWLINE, TT_COMMA};
 			if (ParseWrappedExpr(&FirstValue, Ps, Term, 2))
-			{
-				AstNode_Destroy(&For);
 				return 1;
-			}
-			AstNode_AddChild(&For, &FirstValue);
+			AstNode_AddChild(&For, &FirstValue, Ps->Arena);
 			
 			if (Ps->Lex->Toks[Ps->i].Type == TT_COMMA)
 			{
 				struct AstNode Cond = {0};
 				unsigned char CondTerm[] = {TT_COMMA};
 				if (ParseWrappedExpr(&Cond, Ps, CondTerm, 1))
-				{
-					AstNode_Destroy(&For);
 					return 1;
-				}
-				AstNode_AddChild(&For, &Cond);
+				AstNode_AddChild(&For, &Cond, Ps->Arena);
 				
 				struct AstNode Inc = {0};
 				unsigned char IncTerm[] = {TT_NEWLINE};
 				if (ParseWrappedExpr(&Inc, Ps, IncTerm, 1))
-				{
-					AstNode_Destroy(&For);
 					return 1;
-				}
-				AstNode_AddChild(&For, &Inc);
+				AstNode_AddChild(&For, &Inc, Ps->Arena);
 			}
 		}
 	}
@@ -4069,12 +11395,9 @@ ParseFor(struct AstNode *Out, struct ParseState *Ps)
 		struct AstNode StmtList = {0};
 		unsigned char Term[] = {TT_KW_END};
 		if (ParseStatementList(&StmtList, Ps, Term, 1))
-		{
-			AstNode_Destroy(&For);
 			return 1;
-		}
 		
-		AstNode_AddChild(&For, &StmtList);
+		AstNode_AddChild(&For, &StmtList, Ps->Arena);
 	}
 	
 	*Out = For;
@@ -4099,30 +11422,25 @@ ParseImport(struct AstNode *Out, struct ParseState *Ps)
 	{
 		struct Token const *Target = ExpectToken(Ps, TT_IDENT);
 		if (!Target)
-		{
-			AstNode_Destroy(Out);
 			return 1;
-		}
 		
 		struct Token const *Tok = NextToken(Ps);
 		if (!Tok)
 		{
 			LogTokErr(Ps->File, Target, "expected TT_PERIOD or TT_NEWLINE after target!");
-			AstNode_Destroy(Out);
 			return 1;
 		}
 		
 		switch (Tok->Type)
 		{
 		case TT_PERIOD:
-			AstNode_AddToken(Out, Target);
+			AstNode_AddToken(Out, Target, Ps->Arena);
 			break;
 		case TT_NEWLINE:
-			AstNode_AddToken(Out, Target);
+			AstNode_AddToken(Out, Target, Ps->Arena);
 			goto Done;
 		default:
 			LogTokErr(Ps->File, Tok, "expected TT_PERIOD or TT_NEWLINE!");
-			AstNode_Destroy(Out);
 			return 1;
 		}
 	}
@@ -4133,6 +11451,61 @@ Done:
 	return 0;
 }
 
+static int
+ParseLazyBody(struct AstNode *Out, struct ParseState *Ps)
+{
+	// the body ends at the first `End` in the first column, which must also
+	// balance out the keywords opening blocks within. should the two
+	// disagree, the lazy parse is given up on.
+	size_t Begin = Ps->i + 1, Depth = 0;
+	for (size_t i = Begin; i < Ps->End; ++i)
+	{
+		struct Token const *Tok = &Ps->Lex->Toks[i];
+		switch (Tok->Type)
+		{
+		case TT_KW_BLOCK:
+		case TT_KW_FOR:
+		case TT_KW_IF:
+		case TT_KW_SWITCH:
+		case TT_KW_PROC:
+		case TT_KW_STRUCT:
+		case TT_KW_UNION:
+			++Depth;
+			continue;
+		case TT_KW_END:
+			if (Ps->File->Data[Tok->Pos - 1] != '\n')
+			{
+				if (!Depth)
+					break;
+				--Depth;
+				continue;
+			}
+			
+			if (Depth)
+				break;
+			
+			*Out = (struct AstNode)
+			{
+				.Type = ANT_STATEMENT_LIST,
+				.Flags = ANF_LAZY
+			};
+			AstNode_AddToken(Out, &Ps->Lex->Toks[Begin], Ps->Arena);
+			AstNode_AddToken(Out, Tok, Ps->Arena);
+			
+			Ps->i = i;
+			return 0;
+		default:
+			continue;
+		}
+		
+		LogTokErr(Ps->File, Tok, "cannot determine end of procedure body!");
+		return 1;
+	}
+	
+	LogProgErr(Ps->File, Ps->File->Len, 1, "expected TT_KW_END at end of file, found nothing!");
+	return 1;
+}
+
 static int
 ParseProc(struct AstNode *Out, struct ParseState *Ps)
 {
@@ -4169,44 +11542,40 @@ ParseProc(struct AstNode *Out, struct ParseState *Ps)
 				return 1;
 		}
 		
-		AstNode_AddToken(&Proc, NameLhs);
+		AstNode_AddToken(&Proc, NameLhs, Ps->Arena);
 		if (NameRhs)
-			AstNode_AddToken(&Proc, NameRhs);
+			AstNode_AddToken(&Proc, NameRhs, Ps->Arena);
 	}
 	
 	// argument and return type information.
 	{
 		struct AstNode Args = {0};
 		if (ParseArgList(&Args, Ps))
-		{
-			AstNode_Destroy(&Proc);
 			return 1;
-		}
 		
-		AstNode_AddChild(&Proc, &Args);
+		AstNode_AddChild(&Proc, &Args, Ps->Arena);
 		
 		struct AstNode ReturnType = {0};
 		unsigned char Term[] = {TT_NEWLINE};
 		if (ParseWrappedType(&ReturnType, Ps, Term, 1))
-		{
-			AstNode_Destroy(&Proc);
 			return 1;
-		}
 		
-		AstNode_AddChild(&Proc, &ReturnType);
+		AstNode_AddChild(&Proc, &ReturnType, Ps->Arena);
 	}
 	
 	// procedure contents.
 	{
 		struct AstNode StmtList = {0};
 		unsigned char Term[] = {TT_KW_END};
-		if (ParseStatementList(&StmtList, Ps, Term, 1))
+		if (Ps->Lazy)
 		{
-			AstNode_Destroy(&Proc);
-			return 1;
+			if (ParseLazyBody(&StmtList, Ps))
+				return 1;
 		}
+		else if (ParseStatementList(&StmtList, Ps, Term, 1))
+			return 1;
 		
-		AstNode_AddChild(&Proc, &StmtList);
+		AstNode_AddChild(&Proc, &StmtList, Ps->Arena);
 	}
 	
 	*Out = Proc;
@@ -4215,8 +11584,20 @@ ParseProc(struct AstNode *Out, struct ParseState *Ps)
 }
 
 static int
-ParseProgram(struct AstNode *Out, struct ParseState *Ps)
+ParseProgram(struct FlatAst *Out, struct ParseState *Ps)
 {
+	// every declaration is flattened as soon as it has been parsed, so that
+	// the node tree never holds more than one of them.
+	*Out = (struct FlatAst)
+	{
+		.Nodes = calloc(256, sizeof(struct FlatAstNode)),
+		.NodeCnt = 1,
+		.NodeCap = 256,
+		.Lex = *Ps->Lex
+	};
+	Out->Nodes[0].Type = ANT_PROGRAM;
+	
+	uint32_t Prev = 0;
 	for (;;)
 	{
 		struct Token const *Tok = PeekToken(Ps);
@@ -4229,11 +11610,8 @@ ParseProgram(struct AstNode *Out, struct ParseState *Ps)
 		{
 			struct AstNode Child = {0};
 			if (ParseImport(&Child, Ps))
-			{
-				AstNode_Destroy(Out);
 				return 1;
-			}
-			AstNode_AddChild(Out, &Child);
+			ParseProgram_AddDecl(Out, &Prev, &Child, Ps);
 			break;
 		}
 		case TT_KW_PROC:
@@ -4241,11 +11619,8 @@ ParseProgram(struct AstNode *Out, struct ParseState *Ps)
 		{
 			struct AstNode Child = {0};
 			if (ParseProc(&Child, Ps))
-			{
-				AstNode_Destroy(Out);
 				return 1;
-			}
-			AstNode_AddChild(Out, &Child);
+			ParseProgram_AddDecl(Out, &Prev, &Child, Ps);
 			break;
 		}
 		case TT_KW_VAR:
@@ -4254,44 +11629,32 @@ ParseProgram(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode Child = {0};
 			unsigned char Term[] = {TT_NEWLINE};
 			if (ParseVar(&Child, Ps, Term, 1))
-			{
-				AstNode_Destroy(Out);
 				return 1;
-			}
-			AstNode_AddChild(Out, &Child);
+			ParseProgram_AddDecl(Out, &Prev, &Child, Ps);
 			break;
 		}
 		case TT_KW_STRUCT:
 		{
 			struct AstNode Child = {0};
 			if (ParseStruct(&Child, Ps))
-			{
-				AstNode_Destroy(Out);
 				return 1;
-			}
-			AstNode_AddChild(Out, &Child);
+			ParseProgram_AddDecl(Out, &Prev, &Child, Ps);
 			break;
 		}
 		case TT_KW_ENUM:
 		{
 			struct AstNode Child = {0};
 			if (ParseEnum(&Child, Ps))
-			{
-				AstNode_Destroy(Out);
 				return 1;
-			}
-			AstNode_AddChild(Out, &Child);
+			ParseProgram_AddDecl(Out, &Prev, &Child, Ps);
 			break;
 		}
 		case TT_KW_UNION:
 		{
 			struct AstNode Child = {0};
 			if (ParseUnion(&Child, Ps))
-			{
-				AstNode_Destroy(Out);
 				return 1;
-			}
-			AstNode_AddChild(Out, &Child);
+			ParseProgram_AddDecl(Out, &Prev, &Child, Ps);
 			break;
 		}
 		case TT_NEWLINE:
@@ -4299,16 +11662,32 @@ ParseProgram(struct AstNode *Out, struct ParseState *Ps)
 			break;
 		default:
 			LogTokErr(Ps->File, Tok, "expected global scope element!");
-			AstNode_Destroy(Out);
 			return 1;
 		}
 	}
 	
-	Out->Type = ANT_PROGRAM;
-	
 	return 0;
 }
 
+static void
+ParseProgram_AddDecl(
+	struct FlatAst *Out,
+	uint32_t *Prev,
+	struct AstNode const *Decl,
+	struct ParseState *Ps
+)
+{
+	uint32_t Node = FlatAst_AddNode(Out, Decl);
+	if (*Prev)
+		Out->Nodes[*Prev].NextSibling = Node;
+	else
+		Out->Nodes[0].FirstChild = Node;
+	*Prev = Node;
+	++Out->Nodes[0].ChildCnt;
+	
+	Arena_Reset(Ps->Arena);
+}
+
 static int
 ParseResetVargs(struct AstNode *Out, struct ParseState *Ps)
 {
@@ -4320,7 +11699,7 @@ ParseResetVargs(struct AstNode *Out, struct ParseState *Ps)
 	{
 		.Type = ANT_RESET_VARGS
 	};
-	AstNode_AddToken(Out, Tok);
+	AstNode_AddToken(Out, Tok, Ps->Arena);
 	
 	return 0;
 }
@@ -4349,14 +11728,14 @@ ParseReturn(struct AstNode *Out, struct ParseState *Ps)
 		if (ParseWrappedExpr(&Value, Ps, Term, 1))
 			return 1;
 		
-		AstNode_AddChild(Out, &Value);
+		AstNode_AddChild(Out, &Value, Ps->Arena);
 		
 		break;
 	}
 	}
 	
 	Out->Type = ANT_RETURN;
-	AstNode_AddToken(Out, FirstTok);
+	AstNode_AddToken(Out, FirstTok, Ps->Arena);
 	
 	return 0;
 }
@@ -4431,12 +11810,9 @@ ParseStatementList(
 		
 		struct AstNode Stmt = {0};
 		if (ParseStatement(&Stmt, Ps))
-		{
-			AstNode_Destroy(&StmtList);
 			return 1;
-		}
 		
-		AstNode_AddChild(&StmtList, &Stmt);
+		AstNode_AddChild(&StmtList, &Stmt, Ps->Arena);
 	}
 Done:
 	*Out = StmtList;
@@ -4471,7 +11847,7 @@ ParseStruct(struct AstNode *Out, struct ParseState *Ps)
 		if (!ExpectToken(Ps, TT_NEWLINE))
 			return 1;
 		
-		AstNode_AddToken(&Struct, Name);
+		AstNode_AddToken(&Struct, Name, Ps->Arena);
 	}
 	
 	// get struct member information.
@@ -4480,34 +11856,25 @@ ParseStruct(struct AstNode *Out, struct ParseState *Ps)
 		SkipParseNewlines(Ps);
 		struct Token const *MembName = ExpectToken(Ps, TT_IDENT);
 		if (!MembName)
-		{
-			AstNode_Destroy(&Struct);
 			return 1;
-		}
 		
 		struct AstNode MembType = {0};
 		unsigned char Term[] = {TT_NEWLINE};
 		if (ParseWrappedType(&MembType, Ps, Term, 1))
-		{
-			AstNode_Destroy(&Struct);
 			return 1;
-		}
 		
 		struct AstNode Memb =
 		{
 			.Type = ANT_MEMBER
 		};
-		AstNode_AddChild(&Memb, &MembType);
-		AstNode_AddToken(&Memb, MembName);
+		AstNode_AddChild(&Memb, &MembType, Ps->Arena);
+		AstNode_AddToken(&Memb, MembName, Ps->Arena);
 		
-		AstNode_AddChild(&Struct, &Memb);
+		AstNode_AddChild(&Struct, &Memb, Ps->Arena);
 		
 		struct Token const *Next = RequireToken(Ps);
 		if (!Next)
-		{
-			AstNode_Destroy(&Struct);
 			return 1;
-		}
 		
 		if (Next->Type == TT_KW_END)
 			break;
@@ -4539,22 +11906,18 @@ ParseSwitch(struct AstNode *Out, struct ParseState *Ps)
 		if (ParseWrappedExpr(&Over, Ps, Term, 1))
 			return 1;
 		
-		AstNode_AddChild(&Switch, &Over);
+		AstNode_AddChild(&Switch, &Over, Ps->Arena);
 	}
 	
 	// get case statements.
 	{
 		struct Token const *Which = RequireToken(Ps);
 		if (!Which)
-		{
-			AstNode_Destroy(&Switch);
 			return 1;
-		}
 		
 		if (Which->Type != TT_KW_CASE && Which->Type != TT_KW_BASE)
 		{
 			LogTokErr(Ps->File, Which, "expected either TT_KW_CASE or TT_KW_BASE!");
-			AstNode_Destroy(&Switch);
 			return 1;
 		}
 		
@@ -4568,26 +11931,19 @@ ParseSwitch(struct AstNode *Out, struct ParseState *Ps)
 			struct AstNode Matches = {0};
 			unsigned char MatchTerm[] = {TT_NEWLINE};
 			if (ParseWrappedExpr(&Matches, Ps, MatchTerm, 1))
-			{
-				AstNode_Destroy(&Switch);
 				return 1;
-			}
 			
-			AstNode_AddChild(&Case, &Matches);
+			AstNode_AddChild(&Case, &Matches, Ps->Arena);
 			
 			struct AstNode StmtList = {0};
 			unsigned char StmtListTerm[] = {TT_KW_CASE, TT_KW_BASE};
 			if (ParseStatementList(&StmtList, Ps, StmtListTerm, 2))
-			{
-				AstNode_Destroy(&Case);
-				AstNode_Destroy(&Switch);
 				return 1;
-			}
 			
-			AstNode_AddChild(&Case, &StmtList);
-			AstNode_AddToken(&Case, Which);
+			AstNode_AddChild(&Case, &StmtList, Ps->Arena);
+			AstNode_AddToken(&Case, Which, Ps->Arena);
 			
-			AstNode_AddChild(&Switch, &Case);
+			AstNode_AddChild(&Switch, &Case, Ps->Arena);
 			
 			Which = &Ps->Lex->Toks[Ps->i];
 		}
@@ -4598,15 +11954,12 @@ ParseSwitch(struct AstNode *Out, struct ParseState *Ps)
 		struct AstNode StmtList = {0};
 		unsigned char Term[] = {TT_KW_END};
 		if (ParseStatementList(&StmtList, Ps, Term, 1))
-		{
-			AstNode_Destroy(&Switch);
 			return 1;
-		}
 		
-		AstNode_AddChild(&Switch, &StmtList);
+		AstNode_AddChild(&Switch, &StmtList, Ps->Arena);
 	}
 	
-	AstNode_AddToken(&Switch, FirstTok);
+	AstNode_AddToken(&Switch, FirstTok, Ps->Arena);
 	
 	*Out = Switch;
 	
@@ -4649,7 +12002,7 @@ ParseType(
 		case TT_KW_VARGS:
 		case TT_TRIPLE_PERIOD:
 			Lhs.Type = ANT_TYPE_ATOM;
-			AstNode_AddToken(&Lhs, BaseType);
+			AstNode_AddToken(&Lhs, BaseType, Ps->Arena);
 			break;
 		case TT_KW_BASE:
 		{
@@ -4663,7 +12016,7 @@ ParseType(
 			case TT_TRIPLE_PERIOD:
 				Lhs.Type = ANT_TYPE_ATOM;
 				Lhs.Flags |= ANF_BASE;
-				AstNode_AddToken(&Lhs, Modified);
+				AstNode_AddToken(&Lhs, Modified, Ps->Arena);
 				break;
 			default:
 				LogTokErr(Ps->File, Modified, "expected TT_KW_VARGS or TT_TRIPLE_PERIOD!");
@@ -4683,10 +12036,7 @@ ParseType(
 	{
 		struct Token const *Mod = RequireToken(Ps);
 		if (!Mod)
-		{
-			AstNode_Destroy(&Lhs);
 			return 1;
-		}
 		
 		for (size_t i = 0; i < TermCnt; ++i)
 		{
@@ -4703,8 +12053,8 @@ ParseType(
 				.Type = ANT_TYPE_PTR
 			};
 			
-			AstNode_AddChild(&NewLhs, &Lhs);
-			AstNode_AddToken(&NewLhs, Mod);
+			AstNode_AddChild(&NewLhs, &Lhs, Ps->Arena);
+			AstNode_AddToken(&NewLhs, Mod, Ps->Arena);
 			Lhs = NewLhs;
 			
 			break;
@@ -4712,18 +12062,15 @@ ParseType(
 		case TT_BKBEGIN:
 		{
 			if (!ExpectToken(Ps, TT_BKEND))
-			{
-				AstNode_Destroy(&Lhs);
 				return 1;
-			}
 			
 			struct AstNode NewLhs =
 			{
 				.Type = ANT_TYPE_ARRAY
 			};
 			
-			AstNode_AddChild(&NewLhs, &Lhs);
-			AstNode_AddToken(&NewLhs, Mod);
+			AstNode_AddChild(&NewLhs, &Lhs, Ps->Arena);
+			AstNode_AddToken(&NewLhs, Mod, Ps->Arena);
 			Lhs = NewLhs;
 			
 			break;
@@ -4731,27 +12078,21 @@ ParseType(
 		case TT_KW_BASE:
 		{
 			if (!ExpectToken(Ps, TT_BKBEGIN))
-			{
-				AstNode_Destroy(&Lhs);
 				return 1;
-			}
 			
 			struct AstNode Size = {0};
 			unsigned char Term[] = {TT_BKEND};
 			if (ParseWrappedExpr(&Size, Ps, Term, 1))
-			{
-				AstNode_Destroy(&Lhs);
 				return 1;
-			}
 			
 			struct AstNode NewLhs =
 			{
 				.Type = ANT_TYPE_BUFFER
 			};
 			
-			AstNode_AddChild(&NewLhs, &Lhs);
-			AstNode_AddChild(&NewLhs, &Size);
-			AstNode_AddToken(&NewLhs, Mod);
+			AstNode_AddChild(&NewLhs, &Lhs, Ps->Arena);
+			AstNode_AddChild(&NewLhs, &Size, Ps->Arena);
+			AstNode_AddToken(&NewLhs, Mod, Ps->Arena);
 			Lhs = NewLhs;
 			
 			break;
@@ -4763,18 +12104,15 @@ ParseType(
 				.Type = ANT_TYPE_PROC
 			};
 			
-			AstNode_AddChild(&NewLhs, &Lhs);
-			AstNode_AddToken(&NewLhs, Mod);
+			AstNode_AddChild(&NewLhs, &Lhs, Ps->Arena);
+			AstNode_AddToken(&NewLhs, Mod, Ps->Arena);
 			Lhs = NewLhs;
 			
 			for (;;)
 			{
 				struct Token const *Tok = RequireToken(Ps);
 				if (!Tok)
-				{
-					AstNode_Destroy(&Lhs);
 					return 1;
-				}
 				
 				switch (Tok->Type)
 				{
@@ -4786,11 +12124,8 @@ ParseType(
 					struct AstNode Child = {0};
 					unsigned char Term[] = {TT_COMMA, TT_PEND};
 					if (ParseType(&Child, Ps, Term, 2))
-					{
-						AstNode_Destroy(&Lhs);
 						return 1;
-					}
-					AstNode_AddChild(&Lhs, &Child);
+					AstNode_AddChild(&Lhs, &Child, Ps->Arena);
 					break;
 				}
 				}
@@ -4806,7 +12141,6 @@ ParseType(
 				{
 					Lhs.Flags |= Node->Flags & ANF_BASE;
 					Lhs.Flags |= ANF_VARIADIC;
-					AstNode_Destroy(&Lhs.Children[Lhs.ChildCnt - 1]);
 					--Lhs.ChildCnt;
 				}
 			}
@@ -4817,19 +12151,16 @@ ParseType(
 			if (Lhs.Flags & ANF_MUT)
 			{
 				LogTokErr(Ps->File, Mod, "mutability modifier cannot be applied on a type multiple times!");
-				AstNode_Destroy(&Lhs);
 				return 1;
 			}
 			if (Lhs.Toks[0]->Type == TT_KW_NULL)
 			{
 				LogTokErr(Ps->File, Mod, "mutability modifier cannot be applied to Null!");
-				AstNode_Destroy(&Lhs);
 				return 1;
 			}
 			if (Lhs.Toks[0]->Type == TT_TRIPLE_PERIOD)
 			{
 				LogTokErr(Ps->File, Mod, "mutability modifier cannot be applied to ...!");
-				AstNode_Destroy(&Lhs);
 				return 1;
 			}
 			Lhs.Flags |= ANF_MUT;
@@ -4838,20 +12169,17 @@ ParseType(
 			if (Lhs.Flags & ANF_NULLABLE)
 			{
 				LogTokErr(Ps->File, Mod, "nullability modifier cannot be applied on a type multiple times!");
-				AstNode_Destroy(&Lhs);
 				return 1;
 			}
 			if (Lhs.Type != ANT_TYPE_PTR && Lhs.Type != ANT_TYPE_PROC)
 			{
 				LogTokErr(Ps->File, Mod, "only pointers and function pointers can be made nullable!");
-				AstNode_Destroy(&Lhs);
 				return 1;
 			}
 			Lhs.Flags |= ANF_NULLABLE;
 			break;
 		default:
 			LogTokErr(Ps->File, Mod, "expected type modifier or terminator!");
-			AstNode_Destroy(&Lhs);
 			return 1;
 		}
 	}
@@ -4894,12 +12222,9 @@ ParseTypeLiteral(struct AstNode *Out, struct ParseState *Ps)
 		
 		struct Token const *MembName = ExpectToken(Ps, TT_IDENT);
 		if (!MembName)
-		{
-			AstNode_Destroy(&TypeLiteral);
 			return 1;
-		}
 		
-		AstNode_AddToken(&Memb, MembName);
+		AstNode_AddToken(&Memb, MembName, Ps->Arena);
 		
 		struct Token const *Next = PeekToken(Ps);
 		while (Next && Next->Type == TT_PERIOD)
@@ -4908,36 +12233,24 @@ ParseTypeLiteral(struct AstNode *Out, struct ParseState *Ps)
 			
 			MembName = ExpectToken(Ps, TT_IDENT);
 			if (!MembName)
-			{
-				AstNode_Destroy(&Memb);
-				AstNode_Destroy(&TypeLiteral);
 				return 1;
-			}
 			
-			AstNode_AddToken(&Memb, MembName);
+			AstNode_AddToken(&Memb, MembName, Ps->Arena);
 			
 			Next = PeekToken(Ps);
 		}
 		
 		if (!ExpectToken(Ps, TT_COLON_EQUAL))
-		{
-			AstNode_Destroy(&Memb);
-			AstNode_Destroy(&TypeLiteral);
 			return 1;
-		}
 		
 		struct AstNode Value = {0};
 		unsigned char Term[] = {TT_NEWLINE};
 		if (ParseExpr(&Value, Ps, Term, 1, 0))
-		{
-			AstNode_Destroy(&Memb);
-			AstNode_Destroy(&TypeLiteral);
 			return 1;
-		}
 		++Ps->i;
 		
-		AstNode_AddChild(&Memb, &Value);
-		AstNode_AddChild(&TypeLiteral, &Memb);
+		AstNode_AddChild(&Memb, &Value, Ps->Arena);
+		AstNode_AddChild(&TypeLiteral, &Memb, Ps->Arena);
 		
 		Next = PeekToken(Ps);
 		if (Next && Next->Type == TT_KW_END)
@@ -4947,7 +12260,8 @@ ParseTypeLiteral(struct AstNode *Out, struct ParseState *Ps)
 		}
 	}
 	
-	AstNode_AddToken(&TypeLiteral, FirstTok);
+	AstNode_AddToken(&TypeLiteral, FirstTok, Ps->Arena);
+	AstNode_AddToken(&TypeLiteral, TypeName, Ps->Arena);
 	*Out = TypeLiteral;
 	
 	return 0;
@@ -4980,7 +12294,7 @@ ParseUnion(struct AstNode *Out, struct ParseState *Ps)
 		if (!ExpectToken(Ps, TT_NEWLINE))
 			return 1;
 		
-		AstNode_AddToken(&Union, Name);
+		AstNode_AddToken(&Union, Name, Ps->Arena);
 	}
 	
 	// get union member information.
@@ -4989,34 +12303,25 @@ ParseUnion(struct AstNode *Out, struct ParseState *Ps)
 		SkipParseNewlines(Ps);
 		struct Token const *MembName = ExpectToken(Ps, TT_IDENT);
 		if (!MembName)
-		{
-			AstNode_Destroy(&Union);
 			return 1;
-		}
 		
 		struct AstNode MembType = {0};
 		unsigned char Term[] = {TT_NEWLINE};
 		if (ParseWrappedType(&MembType, Ps, Term, 1))
-		{
-			AstNode_Destroy(&Union);
 			return 1;
-		}
 		
 		struct AstNode Memb =
 		{
 			.Type = ANT_MEMBER
 		};
-		AstNode_AddChild(&Memb, &MembType);
-		AstNode_AddToken(&Memb, MembName);
+		AstNode_AddChild(&Memb, &MembType, Ps->Arena);
+		AstNode_AddToken(&Memb, MembName, Ps->Arena);
 		
-		AstNode_AddChild(&Union, &Memb);
+		AstNode_AddChild(&Union, &Memb, Ps->Arena);
 		
 		struct Token const *Next = RequireToken(Ps);
 		if (!Next)
-		{
-			AstNode_Destroy(&Union);
 			return 1;
-		}
 		
 		if (Next->Type == TT_KW_END)
 			break;
@@ -5072,17 +12377,15 @@ ParseVar(
 			return 1;
 		
 		struct AstNode Type = {0};
-		unsigned char *TypeTerm = malloc(TermCnt + 1);
+		unsigned char TypeTerm[TermCnt + 1];
 		memcpy(TypeTerm, Term, TermCnt);
 		TypeTerm[TermCnt] = TT_COLON_EQUAL;
 		
-		int Rc = ParseWrappedType(&Type, Ps, TypeTerm, TermCnt + 1);
-		free(TypeTerm);
-		if (Rc)
+		if (ParseWrappedType(&Type, Ps, TypeTerm, TermCnt + 1))
 			return 1;
 		
-		AstNode_AddChild(&Var, &Type);
-		AstNode_AddToken(&Var, Name);
+		AstNode_AddChild(&Var, &Type, Ps->Arena);
+		AstNode_AddToken(&Var, Name, Ps->Arena);
 	}
 	
 	// get initial value if present.
@@ -5091,12 +12394,9 @@ ParseVar(
 		{
 			struct AstNode Value = {0};
 			if (ParseWrappedExpr(&Value, Ps, Term, TermCnt))
-			{
-				AstNode_Destroy(&Var);
 				return 1;
-			}
 			
-			AstNode_AddChild(&Var, &Value);
+			AstNode_AddChild(&Var, &Value, Ps->Arena);
 		}
 	}
 	
@@ -5121,186 +12421,889 @@ ParseWrappedExpr(
 	++Ps->i;
 	
 	Out->Type = ANT_EXPR;
-	AstNode_AddChild(Out, &Child);
-	AstNode_AddToken(Out, FirstTok);
+	AstNode_AddChild(Out, &Child, Ps->Arena);
+	AstNode_AddToken(Out, FirstTok, Ps->Arena);
+	
+	return 0;
+}
+
+static int
+ParseWrappedType(
+	struct AstNode *Out,
+	struct ParseState *Ps,
+	unsigned char const Term[],
+	size_t TermCnt
+)
+{
+	struct Token const *FirstTok = PeekToken(Ps);
+	
+	struct AstNode Child = {0};
+	if (ParseType(&Child, Ps, Term, TermCnt))
+		return 1;
+	
+	Out->Type = ANT_TYPE;
+	AstNode_AddChild(Out, &Child, Ps->Arena);
+	AstNode_AddToken(Out, FirstTok, Ps->Arena);
+	
+	return 0;
+}
+
+static struct Token const *
+PeekPrevToken(struct ParseState const *Ps)
+{
+	return Ps->i > 0 && Ps-> i - 1 < Ps->Lex->TokCnt ? &Ps->Lex->Toks[Ps->i - 1] : NULL;
+}
+
+static struct Token const *
+PeekToken(struct ParseState const *Ps)
+{
+	return Ps->i + 1 >= Ps->End ? NULL : &Ps->Lex->Toks[Ps->i + 1];
+}
+
+#ifndef LITHIC_LIB
+static void
+PrintJsonStr(FILE *Fp, char const *Str)
+{
+	fputc('"', Fp);
+	for (; *Str; ++Str)
+	{
+		unsigned char Ch = *Str;
+		if (Ch == '"' || Ch == '\\')
+			fprintf(Fp, "\\%c", Ch);
+		else if (Ch < 0x20)
+			fprintf(Fp, "\\u%04x", Ch);
+		else
+			fputc(Ch, Fp);
+	}
+	fputc('"', Fp);
+}
+
+static void
+PrintTimeData(void)
+{
+	if (!(Ctx->Conf.Flags & CF_TIME))
+		return;
+	
+	struct
+	{
+		char const *Name;
+		uint64_t Begin, End;
+	} const Stages[] =
+	{
+		{"conf read", Ctx->TimeData.ConfReadBegin, Ctx->TimeData.ConfReadEnd},
+		{"file read", Ctx->TimeData.FileReadBegin, Ctx->TimeData.FileReadEnd},
+		{"lex", Ctx->TimeData.LexBegin, Ctx->TimeData.LexEnd},
+		{"parse", Ctx->TimeData.ParseBegin, Ctx->TimeData.ParseEnd},
+		{"extract imports", Ctx->TimeData.ExtractImportsBegin, Ctx->TimeData.ExtractImportsEnd},
+		{"build symtab globals", Ctx->TimeData.BuildSymtabGlobalsBegin, Ctx->TimeData.BuildSymtabGlobalsEnd},
+		{"find reachable", Ctx->TimeData.FindReachableBegin, Ctx->TimeData.FindReachableEnd},
+		{"check acyclicity", Ctx->TimeData.CheckAcyclicityBegin, Ctx->TimeData.CheckAcyclicityEnd},
+		{"analyze", Ctx->TimeData.AnalyzeBegin, Ctx->TimeData.AnalyzeEnd},
+		{"emit", Ctx->TimeData.EmitBegin, Ctx->TimeData.EmitEnd}
+	};
+	size_t const StageCnt = sizeof(Stages) / sizeof(Stages[0]);
+	
+	static char const *Phases[] = {"read", "cache", "lex", "parse", "analyze", "emit"};
+	size_t const PhaseCnt = sizeof(Phases) / sizeof(Phases[0]);
+	
+	// a stage that never finished is omitted, and the total runs up to the
+	// last finished one.
+	uint64_t Begin = Ctx->TimeData.ConfReadBegin, End = 0;
+	for (size_t i = 0; i < StageCnt; ++i)
+	{
+		if (Stages[i].End)
+			End = Stages[i].End;
+	}
+	
+	// sum up per-module phase times in order of first appearance.
+	struct ModuleTime
+	{
+		char const *Module;
+		uint64_t Ns[6];
+		unsigned Thread;
+	} *Mods = calloc(Ctx->TimeData.EventCnt + 1, sizeof(struct ModuleTime));
+	size_t ModCnt = 0;
+	for (size_t i = 0; i < Ctx->TimeData.EventCnt; ++i)
+	{
+		struct TimeEvent const *Ev = &Ctx->TimeData.Events[i];
+		
+		size_t Mod = 0;
+		while (Mod < ModCnt && Mods[Mod].Module != Ev->Module)
+			++Mod;
+		if (Mod == ModCnt)
+		{
+			Mods[ModCnt++].Module = Ev->Module;
+			Mods[Mod].Thread = Ev->Thread;
+		}
+		
+		for (size_t j = 0; j < PhaseCnt; ++j)
+		{
+			if (!strcmp(Ev->Phase, Phases[j]))
+				Mods[Mod].Ns[j] += Ev->End - Ev->Begin;
+		}
+	}
+	
+	switch (Ctx->Conf.TimeFormat)
+	{
+	case TF_TEXT:
+		for (size_t i = 0; i < StageCnt; ++i)
+		{
+			if (Stages[i].End)
+			{
+				fprintf(
+					stderr,
+					"%-22s%.3fms\n",
+					Stages[i].Name,
+					(Stages[i].End - Stages[i].Begin) / 1e6
+				);
+			}
+		}
+		
+		if (End)
+			fprintf(stderr, "%-22s%.3fms\n", "total", (End - Begin) / 1e6);
+		
+		for (size_t i = 0; i < ModCnt; ++i)
+		{
+			fprintf(stderr, "module %s (thread %u)\n", Mods[i].Module, Mods[i].Thread);
+			for (size_t j = 0; j < PhaseCnt; ++j)
+				fprintf(stderr, "    %-18s%.3fms\n", Phases[j], Mods[i].Ns[j] / 1e6);
+		}
+		
+		break;
+	case TF_JSON:
+		fprintf(stderr, "{\"stages\":[");
+		for (size_t i = 0, Cnt = 0; i < StageCnt; ++i)
+		{
+			if (!Stages[i].End)
+				continue;
+			
+			fprintf(stderr, "%s{\"name\":", Cnt++ ? "," : "");
+			PrintJsonStr(stderr, Stages[i].Name);
+			fprintf(stderr, ",\"ns\":%" PRIu64 "}", Stages[i].End - Stages[i].Begin);
+		}
+		
+		fprintf(stderr, "],\"total_ns\":%" PRIu64 ",\"modules\":[", End ? End - Begin : 0);
+		for (size_t i = 0; i < ModCnt; ++i)
+		{
+			fprintf(stderr, "%s{\"name\":", i ? "," : "");
+			PrintJsonStr(stderr, Mods[i].Module);
+			fprintf(stderr, ",\"thread\":%u", Mods[i].Thread);
+			for (size_t j = 0; j < PhaseCnt; ++j)
+				fprintf(stderr, ",\"%s_ns\":%" PRIu64, Phases[j], Mods[i].Ns[j]);
+			fprintf(stderr, "}");
+		}
+		
+		fprintf(stderr, "]}\n");
+		break;
+	case TF_TRACE:
+		// chrome trace event format, loadable in about://tracing or perfetto.
+		// timestamps are in microseconds from the start of transpilation.
+		fprintf(stderr, "{\"traceEvents\":[");
+		
+		size_t Cnt = 0;
+		for (size_t i = 0; i < StageCnt; ++i)
+		{
+			if (!Stages[i].End)
+				continue;
+			
+			fprintf(stderr, "%s{\"name\":", Cnt++ ? "," : "");
+			PrintJsonStr(stderr, Stages[i].Name);
+			fprintf(
+				stderr,
+				",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":0}",
+				(Stages[i].Begin - Begin) / 1e3,
+				(Stages[i].End - Stages[i].Begin) / 1e3
+			);
+		}
+		
+		for (size_t i = 0; i < Ctx->TimeData.EventCnt; ++i)
+		{
+			struct TimeEvent const *Ev = &Ctx->TimeData.Events[i];
+			fprintf(stderr, "%s{\"name\":", Cnt++ ? "," : "");
+			PrintJsonStr(stderr, Ev->Phase);
+			fprintf(
+				stderr,
+				",\"cat\":\"module\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"module\":",
+				(Ev->Begin - Begin) / 1e3,
+				(Ev->End - Ev->Begin) / 1e3,
+				Ev->Thread
+			);
+			PrintJsonStr(stderr, Ev->Module);
+			fprintf(stderr, "}}");
+		}
+		
+		fprintf(stderr, "]}\n");
+		break;
+	}
+	
+	// free allocated memory.
+	{
+		free(Mods);
+		free(Ctx->TimeData.Events);
+		Ctx->TimeData.Events = NULL;
+		Ctx->TimeData.EventCnt = Ctx->TimeData.EventCap = 0;
+	}
+}
+#endif
+
+static char *
+ResolveImport(struct FlatAst const *Ast, uint32_t Import)
+{
+	char *Name = ImportPath(Ast, Import);
+	for (size_t i = 0; i < Ctx->Conf.ModulePathCnt; ++i)
+	{
+		char *Path;
+		size_t PathLen;
+		DynStr_Init(&Path, &PathLen);
+		
+		DynStr_AppendStr(&Path, &PathLen, Ctx->Conf.ModulePaths[i]);
+		if (Path[PathLen - 1] != '/')
+			DynStr_AppendChar(&Path, &PathLen, '/');
+		DynStr_AppendStr(&Path, &PathLen, Name);
+		DynStr_AppendStr(&Path, &PathLen, ".lc");
+		
+		struct stat Stat;
+		bool HasSrc = !stat(Path, &Stat) && !S_ISDIR(Stat.st_mode);
+		
+		// prefer an interface file unless its source has since been modified.
+		struct stat IfaceStat;
+		DynStr_AppendChar(&Path, &PathLen, 'i');
+		if (!stat(Path, &IfaceStat)
+			&& !S_ISDIR(IfaceStat.st_mode)
+			&& (!HasSrc
+				|| IfaceStat.st_mtim.tv_sec > Stat.st_mtim.tv_sec
+				|| (IfaceStat.st_mtim.tv_sec == Stat.st_mtim.tv_sec
+					&& IfaceStat.st_mtim.tv_nsec >= Stat.st_mtim.tv_nsec)))
+		{
+			free(Name);
+			return Path;
+		}
+		
+		Path[--PathLen] = 0;
+		if (HasSrc)
+		{
+			free(Name);
+			return Path;
+		}
+		
+		free(Path);
+	}
+	
+	free(Name);
+	return NULL;
+}
+
+static int
+Reach_Decl(struct Reach *Reach, struct SymtabEntry const *Ent)
+{
+	// walks a reachable declaration, marking what it refers to.
+	
+	size_t ModInd = Ent->DeclMod - Reach->Modules->Modules;
+	struct ModuleData *Mod = &Reach->Modules->Modules[ModInd];
+	struct FlatAst const *Ast = &Mod->Ast;
+	
+	if (Ast->Nodes[Ent->DeclNode].Type == ANT_PROC)
+	{
+		if (!ModuleData_ProcBody(Mod, Ent->DeclNode))
+			return 1;
+		
+		// parsing the body appends its nodes.
+		if (Mod->Live && Mod->LiveCnt < Ast->NodeCnt)
+		{
+			Mod->Live = realloc(Mod->Live, Ast->NodeCnt);
+			memset(&Mod->Live[Mod->LiveCnt], 0, Ast->NodeCnt - Mod->LiveCnt);
+			Mod->LiveCnt = Ast->NodeCnt;
+		}
+		
+		// methods need their type.
+		if (Ast->Nodes[Ent->DeclNode].TokCnt == 2)
+			Reach_Mark(Reach, Symtab_SearchTypes(&Reach->Symtabs[ModInd], Ent->SuperName));
+	}
+	else if (Ent->Type == SET_STRUCT || Ent->Type == SET_ENUM || Ent->Type == SET_UNION)
+	{
+		// methods may be called through values of their type, which are not
+		// resolved here, so every method of a reachable type is kept.
+		for (uint32_t i = Reach->MethodHeads[ModInd][Ent->DeclNode]; i; i = Reach->Methods[i - 1].Next)
+			Reach_Mark(Reach, Reach->Methods[i - 1].Ent);
+	}
+	
+	Reach_Node(Reach, ModInd, Ent->DeclNode);
+	return 0;
+}
+
+static void
+Reach_Mark(struct Reach *Reach, struct SymtabEntry const *Ent)
+{
+	// queues `Ent` to be walked, unless it already was or its module is kept
+	// whole.
+	
+	if (!Ent)
+		return;
+	
+	struct ModuleData *Mod = &Reach->Modules->Modules[Ent->DeclMod - Reach->Modules->Modules];
+	if (!Mod->Live || Mod->Live[Ent->DeclNode])
+		return;
+	
+	Mod->Live[Ent->DeclNode] = 1;
+	Reach_Push(Reach, Ent);
+}
+
+static void
+Reach_Node(struct Reach *Reach, size_t ModInd, uint32_t Node)
+{
+	// names are resolved as analysis would, ignoring locals shadowing them,
+	// which may only keep more than needed.
+	
+	struct ModuleData *Mod = &Reach->Modules->Modules[ModInd];
+	struct FlatAst const *Ast = &Mod->Ast;
+	struct Symtab const *Symtab = &Reach->Symtabs[ModInd];
+	switch (Ast->Nodes[Node].Type)
+	{
+	case ANT_TYPE_ATOM:
+		if (FlatAst_Token(Ast, Node, 0)->Type == TT_IDENT)
+			Reach_Mark(Reach, Symtab_SearchTypes(Symtab, FlatAst_TokenText(Ast, Node, 0)));
+		break;
+	case ANT_EXPR_ATOM:
+		if (FlatAst_Token(Ast, Node, 0)->Type == TT_IDENT)
+			Reach_Mark(Reach, Symtab_SearchValues(Symtab, FlatAst_TokenText(Ast, Node, 0), NULL));
+		break;
+	case ANT_EXPR_TYPE_ACCESS:
+	{
+		uint32_t Lhs = Ast->Nodes[Node].FirstChild;
+		uint32_t Rhs = Ast->Nodes[Lhs].NextSibling;
+		char const *TypeName = FlatAst_TokenText(Ast, Lhs, 0);
+		Reach_Mark(Reach, Symtab_SearchTypes(Symtab, TypeName));
+		Reach_Mark(Reach, Symtab_SearchValues(Symtab, FlatAst_TokenText(Ast, Rhs, 0), TypeName));
+		return;
+	}
+	case ANT_EXPR_STRUCT:
+	case ANT_EXPR_UNION:
+		Reach_Mark(Reach, Symtab_SearchTypes(Symtab, FlatAst_TokenText(Ast, Node, 1)));
+		break;
+	case ANT_EXPR_LAMBDA:
+		if (Mod->Live)
+			Mod->Live[Node] = 1;
+		break;
+	default:
+		break;
+	}
+	
+	for (uint32_t Child = Ast->Nodes[Node].FirstChild; Child; Child = Ast->Nodes[Child].NextSibling)
+		Reach_Node(Reach, ModInd, Child);
+}
+
+static void
+Reach_Push(struct Reach *Reach, struct SymtabEntry const *Ent)
+{
+	if (Reach->WorkCnt >= Reach->WorkCap)
+	{
+		Reach->WorkCap = Reach->WorkCap ? 2 * Reach->WorkCap : 64;
+		Reach->Work = reallocarray(Reach->Work, Reach->WorkCap, sizeof(struct SymtabEntry const *));
+	}
+	Reach->Work[Reach->WorkCnt++] = Ent;
+}
+
+static int
+ReadFull(int Fd, void *Buf, size_t Len)
+{
+	for (size_t Done = 0; Done < Len;)
+	{
+		ssize_t Rc = read(Fd, (char *)Buf + Done, Len - Done);
+		if (Rc == -1 && errno == EINTR)
+			continue;
+		else if (Rc <= 0)
+			return 1;
+		Done += Rc;
+	}
 	
 	return 0;
 }
 
-static int
-ParseWrappedType(
-	struct AstNode *Out,
-	struct ParseState *Ps,
-	unsigned char const Term[],
-	size_t TermCnt
-)
+static struct Token const *
+RequireToken(struct ParseState *Ps)
+{
+	struct Token const *Tok = NextToken(Ps);
+	if (!Tok)
+	{
+		LogProgErr(Ps->File, Ps->File->Len, 0, "required token at end of file, found nothing!");
+		return NULL;
+	}
+	
+	return Tok;
+}
+
+#ifdef SCAN_X86
+__attribute__((target("avx2")))
+static size_t
+Scan_Avx2(char const *Data, size_t Len, size_t i, enum ScanClass Class)
+{
+	// same as `Scan_Sse2`, but on 32 bytes at a time.
+	for (; i + 32 <= Len; i += 32)
+	{
+		__m256i Chunk = _mm256_loadu_si256((__m256i const *)&Data[i]);
+		uint32_t Mask;
+		
+		switch (Class)
+		{
+		case SC_NEWLINE:
+			Mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('\n')));
+			break;
+		case SC_STR_SPECIAL:
+		{
+			__m256i Quote = _mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('"'));
+			__m256i Esc = _mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('\\'));
+			Mask = _mm256_movemask_epi8(_mm256_or_si256(Quote, Esc));
+			break;
+		}
+		case SC_NON_IDENT:
+		{
+			__m256i Alpha = _mm256_sub_epi8(_mm256_or_si256(Chunk, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+			__m256i Digit = _mm256_sub_epi8(Chunk, _mm256_set1_epi8('0'));
+			__m256i Ident = _mm256_or_si256(
+				_mm256_or_si256(
+					_mm256_cmpeq_epi8(_mm256_min_epu8(Alpha, _mm256_set1_epi8(25)), Alpha),
+					_mm256_cmpeq_epi8(_mm256_min_epu8(Digit, _mm256_set1_epi8(9)), Digit)
+				),
+				_mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('_'))
+			);
+			Mask = ~(uint32_t)_mm256_movemask_epi8(Ident);
+			break;
+		}
+		case SC_NON_BLANK:
+		{
+			__m256i Ctl = _mm256_sub_epi8(Chunk, _mm256_set1_epi8('\t'));
+			__m256i Blank = _mm256_or_si256(
+				_mm256_andnot_si256(
+					_mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8('\n')),
+					_mm256_cmpeq_epi8(_mm256_min_epu8(Ctl, _mm256_set1_epi8(4)), Ctl)
+				),
+				_mm256_cmpeq_epi8(Chunk, _mm256_set1_epi8(' '))
+			);
+			Mask = ~(uint32_t)_mm256_movemask_epi8(Blank);
+			break;
+		}
+		}
+		
+		if (Mask)
+			return i + __builtin_ctz(Mask);
+	}
+	
+	return Scan_Scalar(Data, Len, i, Class);
+}
+#endif
+
+static void
+Scan_Init(void)
+{
+#ifdef SCAN_X86
+	// SSE2 is part of the x86-64 baseline, so only AVX2 needs checking.
+	__builtin_cpu_init();
+	Scan = __builtin_cpu_supports("avx2") ? Scan_Avx2 : Scan_Sse2;
+#endif
+}
+
+static bool
+Scan_IsStop(char Ch, enum ScanClass Class)
 {
-	struct Token const *FirstTok = PeekToken(Ps);
-	
-	struct AstNode Child = {0};
-	if (ParseType(&Child, Ps, Term, TermCnt))
-		return 1;
-	
-	Out->Type = ANT_TYPE;
-	AstNode_AddChild(Out, &Child);
-	AstNode_AddToken(Out, FirstTok);
+	switch (Class)
+	{
+	case SC_NEWLINE:
+		return Ch == '\n';
+	case SC_STR_SPECIAL:
+		return Ch == '"' || Ch == '\\';
+	case SC_NON_IDENT:
+		return !isalnum((unsigned char)Ch) && Ch != '_';
+	case SC_NON_BLANK:
+		return !isspace((unsigned char)Ch) || Ch == '\n';
+	}
 	
-	return 0;
+	return true;
 }
 
-static struct Token const *
-PeekPrevToken(struct ParseState const *Ps)
+static size_t
+Scan_Scalar(char const *Data, size_t Len, size_t i, enum ScanClass Class)
 {
-	return Ps->i > 0 && Ps-> i - 1 < Ps->Lex->TokCnt ? &Ps->Lex->Toks[Ps->i - 1] : NULL;
+	while (i < Len && !Scan_IsStop(Data[i], Class))
+		++i;
+	return i;
 }
 
-static struct Token const *
-PeekToken(struct ParseState const *Ps)
+#ifdef SCAN_X86
+static size_t
+Scan_Sse2(char const *Data, size_t Len, size_t i, enum ScanClass Class)
 {
-	return Ps->i + 1 >= Ps->Lex->TokCnt ? NULL : &Ps->Lex->Toks[Ps->i + 1];
+	// range checks are done as `x - Lo <= Hi - Lo` using unsigned minimum, as
+	// SSE2 lacks unsigned comparisons. the tail shorter than a full chunk is
+	// left to `Scan_Scalar` so that no read goes past `Len`.
+	for (; i + 16 <= Len; i += 16)
+	{
+		__m128i Chunk = _mm_loadu_si128((__m128i const *)&Data[i]);
+		uint32_t Mask;
+		
+		switch (Class)
+		{
+		case SC_NEWLINE:
+			Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\n')));
+			break;
+		case SC_STR_SPECIAL:
+		{
+			__m128i Quote = _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('"'));
+			__m128i Esc = _mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\\'));
+			Mask = _mm_movemask_epi8(_mm_or_si128(Quote, Esc));
+			break;
+		}
+		case SC_NON_IDENT:
+		{
+			// setting bit 5 folds uppercase letters onto lowercase ones.
+			__m128i Alpha = _mm_sub_epi8(_mm_or_si128(Chunk, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+			__m128i Digit = _mm_sub_epi8(Chunk, _mm_set1_epi8('0'));
+			__m128i Ident = _mm_or_si128(
+				_mm_or_si128(
+					_mm_cmpeq_epi8(_mm_min_epu8(Alpha, _mm_set1_epi8(25)), Alpha),
+					_mm_cmpeq_epi8(_mm_min_epu8(Digit, _mm_set1_epi8(9)), Digit)
+				),
+				_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('_'))
+			);
+			Mask = ~_mm_movemask_epi8(Ident) & 0xffff;
+			break;
+		}
+		case SC_NON_BLANK:
+		{
+			// '\t' through '\r' are contiguous, but '\n' is among them.
+			__m128i Ctl = _mm_sub_epi8(Chunk, _mm_set1_epi8('\t'));
+			__m128i Blank = _mm_or_si128(
+				_mm_andnot_si128(
+					_mm_cmpeq_epi8(Chunk, _mm_set1_epi8('\n')),
+					_mm_cmpeq_epi8(_mm_min_epu8(Ctl, _mm_set1_epi8(4)), Ctl)
+				),
+				_mm_cmpeq_epi8(Chunk, _mm_set1_epi8(' '))
+			);
+			Mask = ~_mm_movemask_epi8(Blank) & 0xffff;
+			break;
+		}
+		}
+		
+		if (Mask)
+			return i + __builtin_ctz(Mask);
+	}
+	
+	return Scan_Scalar(Data, Len, i, Class);
 }
+#endif
 
+#ifndef LITHIC_LIB
 static void
-PrintTimeData(void)
+Server_Compact(void)
 {
-	if (!(Conf.Flags & CF_TIME))
+	// strings interned by past requests are dropped by interning those of
+	// resident modules anew, once the table has doubled since last time.
+	
+	struct Interner *Interner = &Ctx->Interner;
+	if (Interner->EntryCnt < 4096 || Interner->EntryCnt < 2 * Server.InternCnt)
 		return;
 	
-	uint64_t Begin = TimeData.ConfReadBegin, End = 0;
+	struct Interner Prev = *Interner;
+	Interner->Entries = NULL;
+	Interner->EntryCnt = Interner->EntryCap = 0;
+	Interner->Strs = (struct Arena){0};
 	
-	if (TimeData.ConfReadEnd)
+	for (size_t i = 0; i < Server.ModuleCnt; ++i)
 	{
-		fprintf(
-			stderr,
-			"conf read             %lums\n",
-			TimeData.ConfReadEnd - TimeData.ConfReadBegin
-		);
-		End = TimeData.ConfReadEnd;
+		struct LexData *Lex = &Server.Modules[i].Data.Lex;
+		for (size_t j = 0; j < Lex->StrCnt; ++j)
+			Lex->Strs[j].Text = Interner_Add(Lex->Strs[j].Text, Lex->Strs[j].Len);
 	}
 	
-	if (TimeData.FileReadEnd)
-	{
-		fprintf(
-			stderr,
-			"file read             %lums\n",
-			TimeData.FileReadEnd - TimeData.FileReadBegin
-		);
-		End = TimeData.FileReadEnd;
-	}
+	Interner_Destroy(&Prev);
+	Server.InternCnt = Interner->EntryCnt;
+}
+#endif
+
+static int
+Server_Find(struct ModuleData *Out, FILE *Fp)
+{
+	// returns nonzero if the module at `Out->FullPath` is not resident or has
+	// changed since it was kept.
+	
+	struct stat Stat;
+	if (fstat(fileno(Fp), &Stat))
+		return 1;
+	
+	pthread_mutex_lock(&Server.Lock);
 	
-	if (TimeData.LexEnd)
+	struct ResidentModule *Ent = NULL;
+	for (size_t i = 0; i < Server.ModuleCnt && !Ent; ++i)
 	{
-		fprintf(
-			stderr,
-			"lex                   %lums\n",
-			TimeData.LexEnd - TimeData.LexBegin
-		);
-		End = TimeData.LexEnd;
+		if (!strcmp(Server.Modules[i].Data.FullPath, Out->FullPath))
+			Ent = &Server.Modules[i];
 	}
 	
-	if (TimeData.ParseEnd)
+	if (!Ent || (uint64_t)Stat.st_size != Ent->Size)
 	{
-		fprintf(
-			stderr,
-			"parse                 %lums\n",
-			TimeData.ParseEnd - TimeData.ParseBegin
-		);
-		End = TimeData.ParseEnd;
+		pthread_mutex_unlock(&Server.Lock);
+		return 1;
 	}
 	
-	if (TimeData.ExtractImportsEnd)
+	// a touched module may still have the same contents.
+	if (Stat.st_mtim.tv_sec != Ent->Mtime.tv_sec || Stat.st_mtim.tv_nsec != Ent->Mtime.tv_nsec)
 	{
-		fprintf(
-			stderr,
-			"extract imports       %lums\n",
-			TimeData.ExtractImportsEnd - TimeData.ExtractImportsBegin
-		);
-		End = TimeData.ExtractImportsEnd;
+		struct FileData File = {0};
+		if (FileData_Read(&File, Fp, Ent->Data.File.Name)
+			|| HashStr(File.Data, File.Len) != Ent->Hash)
+		{
+			FileData_Destroy(&File);
+			pthread_mutex_unlock(&Server.Lock);
+			return 1;
+		}
+		
+		FileData_Destroy(&File);
+		Ent->Mtime = Stat.st_mtim;
 	}
 	
-	if (TimeData.BuildSymtabGlobalsEnd)
+	Out->File = Ent->Data.File;
+	Out->Lex = Ent->Data.Lex;
+	Out->Ast = Ent->Data.Ast;
+	Out->Resident = true;
+	
+	pthread_mutex_unlock(&Server.Lock);
+	
+	return 0;
+}
+
+static void
+Server_Keep(struct ModuleData *Data, struct stat const *Stat, uint64_t Hash)
+{
+	// `Data` becomes resident, replacing an outdated version if there is one.
+	struct ResidentModule New =
 	{
-		fprintf(
-			stderr,
-			"build symtab globals  %lums\n",
-			TimeData.BuildSymtabGlobalsEnd - TimeData.BuildSymtabGlobalsBegin
-		);
-		End = TimeData.BuildSymtabGlobalsEnd;
-	}
+		.Data = *Data,
+		.Mtime = Stat->st_mtim,
+		.Size = Stat->st_size,
+		.Hash = Hash
+	};
+	New.Data.FullPath = strdup(Data->FullPath);
+	New.Data.ImportName = NULL; // other programs may import it by another path.
+	New.Data.Live = NULL;
+	New.Data.LiveCnt = 0;
+	New.Data.Symtab = NULL;
+	Data->Resident = true;
 	
-	if (TimeData.CheckAcyclicityEnd)
+	pthread_mutex_lock(&Server.Lock);
+	
+	size_t Ind = 0;
+	while (Ind < Server.ModuleCnt && strcmp(Server.Modules[Ind].Data.FullPath, Data->FullPath))
+		++Ind;
+	
+	if (Ind < Server.ModuleCnt)
+		ModuleData_Destroy(&Server.Modules[Ind].Data);
+	else
 	{
-		fprintf(
-			stderr,
-			"check acyclicity      %lums\n",
-			TimeData.CheckAcyclicityEnd - TimeData.CheckAcyclicityBegin
-		);
-		End = TimeData.CheckAcyclicityEnd;
+		if (Server.ModuleCnt >= Server.ModuleCap)
+		{
+			Server.ModuleCap = Server.ModuleCap ? 2 * Server.ModuleCap : 32;
+			Server.Modules = reallocarray(Server.Modules, Server.ModuleCap, sizeof(struct ResidentModule));
+		}
+		++Server.ModuleCnt;
 	}
+	Server.Modules[Ind] = New;
 	
-	if (TimeData.AnalyzeEnd)
+	pthread_mutex_unlock(&Server.Lock);
+}
+
+static void
+Server_Release(struct ModuleData const *Data)
+{
+	// procedure bodies may have been appended to the AST while in use.
+	pthread_mutex_lock(&Server.Lock);
+	for (size_t i = 0; i < Server.ModuleCnt; ++i)
 	{
-		fprintf(
-			stderr,
-			"analyze               %lums\n",
-			TimeData.AnalyzeEnd - TimeData.AnalyzeBegin
-		);
-		End = TimeData.AnalyzeEnd;
+		if (!strcmp(Server.Modules[i].Data.FullPath, Data->FullPath))
+		{
+			Server.Modules[i].Data.Ast = Data->Ast;
+			break;
+		}
 	}
-	
-	if (End)
-		fprintf(stderr, "total                 %lums\n", End - Begin);
+	pthread_mutex_unlock(&Server.Lock);
 }
 
-static char *
-ResolveImport(struct AstNode const *Import)
+#ifndef LITHIC_LIB
+static int
+Server_Run(char const *Path)
 {
-	for (size_t i = 0; i < Conf.ModulePathCnt; ++i)
+	struct sockaddr_un Addr = {.sun_family = AF_UNIX};
+	if (strlen(Path) >= sizeof(Addr.sun_path))
 	{
-		char *Path;
-		size_t PathLen;
-		DynStr_Init(&Path, &PathLen);
-		
-		DynStr_AppendStr(&Path, &PathLen, Conf.ModulePaths[i]);
-		if (Path[PathLen - 1] != '/')
-			DynStr_AppendChar(&Path, &PathLen, '/');
-		for (size_t j = 0; j < Import->TokCnt; ++j)
+		LogErr("socket path is too long - '%s'!", Path);
+		return 1;
+	}
+	strcpy(Addr.sun_path, Path);
+	
+	// replace the socket of a previous server.
+	struct stat Stat;
+	if (!stat(Path, &Stat) && S_ISSOCK(Stat.st_mode))
+		unlink(Path);
+	
+	// the socket is only for its owner, as requests read and write files
+	// with the server's permissions.
+	int Sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	mode_t PrevMask = umask(0177);
+	int BindRc = Sock == -1 ? -1 : bind(Sock, (struct sockaddr *)&Addr, sizeof(Addr));
+	umask(PrevMask);
+	
+	if (BindRc || listen(Sock, 64))
+	{
+		LogErr("failed to listen on socket - '%s'!", Path);
+		if (Sock != -1)
+			close(Sock);
+		return 1;
+	}
+	
+	// clients going away mid-request must not take the server with them.
+	signal(SIGPIPE, SIG_IGN);
+	
+	// requests are served one at a time, each compiling as its own process
+	// would, apart from imported modules staying resident.
+	Server.Active = true;
+	for (;;)
+	{
+		int Conn = accept(Sock, NULL, NULL);
+		if (Conn == -1)
 		{
-			DynStr_AppendStr(
-				&Path,
-				&PathLen,
-				Import->Toks[j]->Data.Str.Text
-			);
-			if (j + 1 < Import->TokCnt)
-				DynStr_AppendChar(&Path, &PathLen, '/');
+			if (errno == EINTR)
+				continue;
+			
+			LogErr("failed to accept connection - '%s'!", Path);
+			break;
 		}
-		DynStr_AppendStr(&Path, &PathLen, ".lc");
 		
-		FILE *Fp = OpenFile(Path, "rb");
-		if (Fp)
+		// others may still reach the socket through a looser directory.
+		struct ucred Cred;
+		socklen_t CredLen = sizeof(Cred);
+		if (getsockopt(Conn, SOL_SOCKET, SO_PEERCRED, &Cred, &CredLen) || Cred.uid != getuid())
 		{
-			fclose(Fp);
-			return Path;
+			close(Conn);
+			continue;
 		}
 		
-		free(Path);
+		Server_Serve(Conn);
+		close(Conn);
 	}
 	
-	return NULL;
+	close(Sock);
+	return 1;
 }
 
-static struct Token const *
-RequireToken(struct ParseState *Ps)
+static void
+Server_Serve(int Conn)
 {
-	struct Token const *Tok = NextToken(Ps);
-	if (!Tok)
+	// receive request, see `Client_Run` for its layout.
+	uint32_t Len;
+	int Fds[2];
 	{
-		LogProgErr(Ps->File, Ps->File->Len, 0, "required token at end of file, found nothing!");
-		return NULL;
+		struct iovec Iov = {.iov_base = &Len, .iov_len = sizeof(Len)};
+		union
+		{
+			struct cmsghdr Hdr;
+			char Buf[CMSG_SPACE(sizeof(Fds))];
+		} Ctl;
+		struct msghdr Msg =
+		{
+			.msg_iov = &Iov,
+			.msg_iovlen = 1,
+			.msg_control = Ctl.Buf,
+			.msg_controllen = sizeof(Ctl.Buf)
+		};
+		
+		if (recvmsg(Conn, &Msg, 0) != sizeof(Len))
+			return;
+		
+		struct cmsghdr *Cmsg = CMSG_FIRSTHDR(&Msg);
+		if (!Cmsg
+			|| Cmsg->cmsg_level != SOL_SOCKET
+			|| Cmsg->cmsg_type != SCM_RIGHTS
+			|| Cmsg->cmsg_len != CMSG_LEN(sizeof(Fds)))
+		{
+			return;
+		}
+		memcpy(Fds, CMSG_DATA(Cmsg), sizeof(Fds));
 	}
 	
-	return Tok;
+	char *Req = malloc(Len + 1);
+	if (Len < 2 || ReadFull(Conn, Req, Len) || Req[Len - 1])
+	{
+		close(Fds[0]);
+		close(Fds[1]);
+		free(Req);
+		return;
+	}
+	Req[Len] = 0;
+	
+	// split working directory and null-terminated argument vector.
+	int Argc = -1;
+	for (size_t i = 0; i < Len; ++i)
+		Argc += !Req[i];
+	
+	char const **Argv = calloc(Argc + 1, sizeof(char const *));
+	char const *Cwd = Req;
+	for (size_t i = strlen(Cwd) + 1, j = 0; i < Len; i += strlen(&Req[i]) + 1)
+		Argv[j++] = &Req[i];
+	
+	// compile with the client's output streams and working directory.
+	int32_t Rc = 1;
+	{
+		int SavedOut = dup(STDOUT_FILENO);
+		int SavedErr = dup(STDERR_FILENO);
+		int SavedDir = open(".", O_RDONLY | O_DIRECTORY);
+		
+		fflush(stdout);
+		fflush(stderr);
+		dup2(Fds[0], STDOUT_FILENO);
+		dup2(Fds[1], STDERR_FILENO);
+		
+		if (Argc < 1)
+			LogErr("expected a program name in request!");
+		else if (chdir(Cwd))
+			LogErr("failed to enter working directory - '%s'!", Cwd);
+		else
+			Rc = Compile(Argc, Argv);
+		
+		PrintTimeData();
+		fflush(stdout);
+		fflush(stderr);
+		
+		dup2(SavedOut, STDOUT_FILENO);
+		dup2(SavedErr, STDERR_FILENO);
+		if (SavedDir != -1 && fchdir(SavedDir))
+			LogErr("failed to return to server working directory!");
+		
+		close(SavedOut);
+		close(SavedErr);
+		if (SavedDir != -1)
+			close(SavedDir);
+	}
+	
+	// reset state for the next request.
+	{
+		Conf_Quit();
+		Ctx->Conf = (struct Conf){0};
+		
+		memset(&Ctx->TimeData, 0, offsetof(struct TimeData, Events));
+		Ctx->TimeData.EventCnt = 0;
+		
+		Server_Compact();
+	}
+	
+	WriteFull(Conn, &Rc, sizeof(Rc));
+	
+	// free allocated memory.
+	{
+		close(Fds[0]);
+		close(Fds[1]);
+		free(Argv);
+		free(Req);
+	}
 }
+#endif
 
 static unsigned
 SizeModBits(enum SizeMod Mod)
@@ -5349,98 +13352,168 @@ StrNumCmp(char const *a, size_t LenA, char const *b, size_t LenB)
 	return 0;
 }
 
-static char *
-Substr(char const *Str, size_t Lb, size_t Ub)
-{
-	char *Sub = malloc(Ub - Lb + 1);
-	memcpy(Sub, &Str[Lb], Ub - Lb);
-	Sub[Ub - Lb] = 0;
-	return Sub;
-}
-
 static void
 Symtab_AddType(struct Symtab *Symtab, struct SymtabEntry const *Ent)
 {
+	if (Symtab->TypeCnt >= Symtab->TypeCap)
+	{
+		Symtab->TypeCap = Symtab->TypeCap ? 2 * Symtab->TypeCap : 64;
+		Symtab->Types = reallocarray(
+			Symtab->Types,
+			Symtab->TypeCap,
+			sizeof(struct SymtabEntry)
+		);
+		
+		free(Symtab->TypeSlots);
+		Symtab->TypeSlots = calloc(2 * Symtab->TypeCap, sizeof(uint32_t));
+		for (size_t i = 0; i < Symtab->TypeCnt; ++i)
+			Symtab_Index(Symtab->TypeSlots, 2 * Symtab->TypeCap, Symtab->Types, i);
+	}
+	
+	Symtab->Types[Symtab->TypeCnt] = *Ent;
+	Symtab_Index(Symtab->TypeSlots, 2 * Symtab->TypeCap, Symtab->Types, Symtab->TypeCnt);
 	++Symtab->TypeCnt;
-	Symtab->Types = reallocarray(
-		Symtab->Types,
-		Symtab->TypeCnt,
-		sizeof(struct SymtabEntry)
-	);
-	Symtab->Types[Symtab->TypeCnt - 1] = *Ent;
 }
 
 static void
 Symtab_AddValue(struct Symtab *Symtab, struct SymtabEntry const *Ent)
 {
+	if (Symtab->ValueCnt >= Symtab->ValueCap)
+	{
+		Symtab->ValueCap = Symtab->ValueCap ? 2 * Symtab->ValueCap : 64;
+		Symtab->Values = reallocarray(
+			Symtab->Values,
+			Symtab->ValueCap,
+			sizeof(struct SymtabEntry)
+		);
+		
+		free(Symtab->ValueSlots);
+		Symtab->ValueSlots = calloc(2 * Symtab->ValueCap, sizeof(uint32_t));
+		for (size_t i = 0; i < Symtab->ValueCnt; ++i)
+			Symtab_Index(Symtab->ValueSlots, 2 * Symtab->ValueCap, Symtab->Values, i);
+	}
+	
+	Symtab->Values[Symtab->ValueCnt] = *Ent;
+	Symtab_Index(Symtab->ValueSlots, 2 * Symtab->ValueCap, Symtab->Values, Symtab->ValueCnt);
 	++Symtab->ValueCnt;
-	Symtab->Values = reallocarray(
-		Symtab->Values,
-		Symtab->ValueCnt,
-		sizeof(struct SymtabEntry)
-	);
-	Symtab->Values[Symtab->ValueCnt - 1] = *Ent;
 }
 
 static void
 Symtab_Destroy(struct Symtab *Symtab)
 {
-	// release entry resources.
+	// entry names are owned by the interner.
+	if (Symtab->Types)
+		free(Symtab->Types);
+	if (Symtab->Values)
+		free(Symtab->Values);
+	free(Symtab->TypeSlots);
+	free(Symtab->ValueSlots);
+}
+
+static void
+Symtab_DestroyAll(struct Symtab *Symtabs, size_t Cnt)
+{
+	// frees the first `Cnt` symtabs and the array holding them.
+	
+	for (size_t i = 0; i < Cnt; ++i)
+		Symtab_Destroy(&Symtabs[i]);
+	free(Symtabs);
+}
+
+static size_t
+Symtab_Hash(char const *Name, char const *SuperName)
+{
+	// names are interned, so their addresses identify them.
+	uint64_t Hash = (uintptr_t)Name ^ (uint64_t)(uintptr_t)SuperName * 31;
+	Hash *= 0x9e3779b97f4a7c15;
+	return Hash ^ Hash >> 32;
+}
+
+static void
+Symtab_Index(
+	uint32_t *Slots,
+	size_t SlotCnt,
+	struct SymtabEntry const *Ents,
+	size_t Ind
+)
+{
+	size_t Slot = Symtab_Hash(Ents[Ind].Name, Ents[Ind].SuperName) & (SlotCnt - 1);
+	while (Slots[Slot])
+		Slot = (Slot + 1) & (SlotCnt - 1);
+	Slots[Slot] = Ind + 1;
+}
+
+static void
+Symtab_Prune(struct Symtab *Symtab)
+{
+	// drops the entries of declarations not found reachable.
+	
+	size_t TypeCnt = 0, ValueCnt = 0;
+	for (size_t i = 0; i < Symtab->TypeCnt; ++i)
 	{
-		for (size_t i = 0; i < Symtab->TypeCnt; ++i)
-			free(Symtab->Types[i].Name);
-		for (size_t i = 0; i < Symtab->ValueCnt; ++i)
-		{
-			free(Symtab->Values[i].Name);
-			if (Symtab->Values[i].SuperName)
-				free(Symtab->Values[i].SuperName);
-		}
+		if (ModuleData_IsLive(Symtab->Types[i].DeclMod, Symtab->Types[i].DeclNode))
+			Symtab->Types[TypeCnt++] = Symtab->Types[i];
+	}
+	for (size_t i = 0; i < Symtab->ValueCnt; ++i)
+	{
+		if (ModuleData_IsLive(Symtab->Values[i].DeclMod, Symtab->Values[i].DeclNode))
+			Symtab->Values[ValueCnt++] = Symtab->Values[i];
 	}
+	Symtab->TypeCnt = TypeCnt;
+	Symtab->ValueCnt = ValueCnt;
 	
-	// release symtab resources.
+	// reindex what is left.
+	if (Symtab->TypeSlots)
+	{
+		memset(Symtab->TypeSlots, 0, 2 * Symtab->TypeCap * sizeof(uint32_t));
+		for (size_t i = 0; i < Symtab->TypeCnt; ++i)
+			Symtab_Index(Symtab->TypeSlots, 2 * Symtab->TypeCap, Symtab->Types, i);
+	}
+	if (Symtab->ValueSlots)
 	{
-		if (Symtab->Types)
-			free(Symtab->Types);
-		if (Symtab->Values)
-			free(Symtab->Values);
+		memset(Symtab->ValueSlots, 0, 2 * Symtab->ValueCap * sizeof(uint32_t));
+		for (size_t i = 0; i < Symtab->ValueCnt; ++i)
+			Symtab_Index(Symtab->ValueSlots, 2 * Symtab->ValueCap, Symtab->Values, i);
 	}
 }
 
 static int
 Symtab_RegisterAstNode(
 	struct Symtab *Symtab,
-	struct FileData const *File,
-	struct AstNode const *Node
+	struct ModuleData const *Mod,
+	uint32_t Node
 )
 {
+	struct FlatAst const *Ast = &Mod->Ast;
+	
 	// check for redefinition.
 	{
-		switch (Node->Type)
+		switch (Ast->Nodes[Node].Type)
 		{
 		case ANT_PROC:
 		{
 			struct SymtabEntry const *Ent;
-			if (Node->TokCnt == 2)
+			if (Ast->Nodes[Node].TokCnt == 2)
 			{
 				Ent = Symtab_SearchValues(
 					Symtab,
-					Node->Toks[1]->Data.Str.Text,
-					Node->Toks[0]->Data.Str.Text
+					FlatAst_TokenText(Ast, Node, 1),
+					FlatAst_TokenText(Ast, Node, 0)
 				);
 			}
 			else
 			{
 				Ent = Symtab_SearchValues(
 					Symtab,
-					Node->Toks[0]->Data.Str.Text,
+					FlatAst_TokenText(Ast, Node, 0),
 					NULL
 				);
 			}
 			
 			if (Ent)
 			{
-				LogAstNodeErr(File, Node, "redefinition of symbol!");
-				LogAstNodeContext(Ent->DeclFile, Ent->DeclNode, "previously defined here:");
+				LogAstNodeErr(Mod, Node, "redefinition of symbol!");
+				LogAstNodeContext(Ent->DeclMod, Ent->DeclNode, "previously defined here:");
 				return 1;
 			}
 			
@@ -5448,12 +13521,12 @@ Symtab_RegisterAstNode(
 		}
 		case ANT_VAR:
 		{
-			char const *Sym = Node->Toks[0]->Data.Str.Text;
+			char const *Sym = FlatAst_TokenText(Ast, Node, 0);
 			struct SymtabEntry const *Ent = Symtab_SearchValues(Symtab, Sym, NULL);
 			if (Ent)
 			{
-				LogAstNodeErr(File, Node, "redefinition of symbol!");
-				LogAstNodeContext(Ent->DeclFile, Ent->DeclNode, "previously defined here:");
+				LogAstNodeErr(Mod, Node, "redefinition of symbol!");
+				LogAstNodeContext(Ent->DeclMod, Ent->DeclNode, "previously defined here:");
 				return 1;
 			}
 			break;
@@ -5462,12 +13535,12 @@ Symtab_RegisterAstNode(
 		case ANT_ENUM:
 		case ANT_UNION:
 		{
-			char const *Sym = Node->Toks[0]->Data.Str.Text;
+			char const *Sym = FlatAst_TokenText(Ast, Node, 0);
 			struct SymtabEntry const *Ent = Symtab_SearchTypes(Symtab, Sym);
 			if (Ent)
 			{
-				LogAstNodeErr(File, Node, "redefinition of symbol!");
-				LogAstNodeContext(Ent->DeclFile, Ent->DeclNode, "previously defined here:");
+				LogAstNodeErr(Mod, Node, "redefinition of symbol!");
+				LogAstNodeContext(Ent->DeclMod, Ent->DeclNode, "previously defined here:");
 				return 1;
 			}
 			break;
@@ -5479,24 +13552,24 @@ Symtab_RegisterAstNode(
 	
 	// register AST node as symtab entry.
 	{
-		switch (Node->Type)
+		switch (Ast->Nodes[Node].Type)
 		{
 		case ANT_PROC:
 		{
 			struct SymtabEntry Ent =
 			{
+				.DeclMod = Mod,
 				.DeclNode = Node,
-				.DeclFile = File,
 				.Type = SET_PROC
 			};
 			
-			if (Node->TokCnt == 2)
+			if (Ast->Nodes[Node].TokCnt == 2)
 			{
-				Ent.Name = strdup(Node->Toks[1]->Data.Str.Text);
-				Ent.SuperName = strdup(Node->Toks[0]->Data.Str.Text);
+				Ent.Name = FlatAst_TokenText(Ast, Node, 1);
+				Ent.SuperName = FlatAst_TokenText(Ast, Node, 0);
 			}
 			else
-				Ent.Name = strdup(Node->Toks[0]->Data.Str.Text);
+				Ent.Name = FlatAst_TokenText(Ast, Node, 0);
 			
 			Symtab_AddValue(Symtab, &Ent);
 			
@@ -5506,9 +13579,9 @@ Symtab_RegisterAstNode(
 		{
 			struct SymtabEntry Ent =
 			{
-				.Name = strdup(Node->Toks[0]->Data.Str.Text),
+				.Name = FlatAst_TokenText(Ast, Node, 0),
+				.DeclMod = Mod,
 				.DeclNode = Node,
-				.DeclFile = File,
 				.Type = SET_VAR
 			};
 			Symtab_AddValue(Symtab, &Ent);
@@ -5518,9 +13591,9 @@ Symtab_RegisterAstNode(
 		{
 			struct SymtabEntry Ent =
 			{
-				.Name = strdup(Node->Toks[0]->Data.Str.Text),
+				.Name = FlatAst_TokenText(Ast, Node, 0),
+				.DeclMod = Mod,
 				.DeclNode = Node,
-				.DeclFile = File,
 				.Type = SET_STRUCT
 			};
 			Symtab_AddType(Symtab, &Ent);
@@ -5530,9 +13603,9 @@ Symtab_RegisterAstNode(
 		{
 			struct SymtabEntry Ent =
 			{
-				.Name = strdup(Node->Toks[0]->Data.Str.Text),
+				.Name = FlatAst_TokenText(Ast, Node, 0),
+				.DeclMod = Mod,
 				.DeclNode = Node,
-				.DeclFile = File,
 				.Type = SET_ENUM
 			};
 			Symtab_AddType(Symtab, &Ent);
@@ -5542,9 +13615,9 @@ Symtab_RegisterAstNode(
 		{
 			struct SymtabEntry Ent =
 			{
-				.Name = strdup(Node->Toks[0]->Data.Str.Text),
+				.Name = FlatAst_TokenText(Ast, Node, 0),
+				.DeclMod = Mod,
 				.DeclNode = Node,
-				.DeclFile = File,
 				.Type = SET_UNION
 			};
 			Symtab_AddType(Symtab, &Ent);
@@ -5561,12 +13634,15 @@ Symtab_RegisterAstNode(
 static struct SymtabEntry const *
 Symtab_SearchTypes(struct Symtab const *Symtab, char const *Name)
 {
-	for (size_t i = 0; i < Symtab->TypeCnt; ++i)
+	size_t Mask = 2 * Symtab->TypeCap - 1;
+	for (size_t i = Symtab_Hash(Name, NULL) & Mask; Symtab->TypeSlots && Symtab->TypeSlots[i]; i = (i + 1) & Mask)
 	{
-		if (!strcmp(Name, Symtab->Types[i].Name))
-			return &Symtab->Types[i];
+		struct SymtabEntry const *Ent = &Symtab->Types[Symtab->TypeSlots[i] - 1];
+		if (Name == Ent->Name)
+			return Ent;
 	}
-	return NULL;
+	
+	return Symtab->Base ? Symtab_SearchTypes(Symtab->Base, Name) : NULL;
 }
 
 static struct SymtabEntry const *
@@ -5576,60 +13652,74 @@ Symtab_SearchValues(
 	char const *SuperName
 )
 {
-	for (size_t i = 0; i < Symtab->ValueCnt; ++i)
+	size_t Mask = 2 * Symtab->ValueCap - 1;
+	for (size_t i = Symtab_Hash(Name, SuperName) & Mask; Symtab->ValueSlots && Symtab->ValueSlots[i]; i = (i + 1) & Mask)
 	{
-		if (!SuperName
-			&& !Symtab->Values[i].SuperName
-			&& !strcmp(Name, Symtab->Values[i].Name))
-		{
-			return &Symtab->Values[i];
-		}
-		else if (SuperName
-			&& Symtab->Values[i].SuperName
-			&& !strcmp(Name, Symtab->Values[i].Name)
-			&& !strcmp(SuperName, Symtab->Values[i].SuperName))
-		{
-			return &Symtab->Values[i];
-		}
+		struct SymtabEntry const *Ent = &Symtab->Values[Symtab->ValueSlots[i] - 1];
+		if (Name == Ent->Name && SuperName == Ent->SuperName)
+			return Ent;
 	}
 	
-	return NULL;
+	return Symtab->Base ? Symtab_SearchValues(Symtab->Base, Name, SuperName) : NULL;
 }
 
 static void
-Token_Destroy(struct Token *Tok)
+TimeData_AddEvent(
+	char const *Phase,
+	char const *Module,
+	uint64_t Begin,
+	uint64_t End,
+	unsigned Thread
+)
 {
-	switch (Tok->Type)
+	if (!(Ctx->Conf.Flags & CF_TIME))
+		return;
+	
+	// the module name is interned so that it outlives the module itself.
+	struct TimeEvent Ev =
 	{
-	case TT_IDENT:
-	case TT_LIT_STR:
-		free(Tok->Data.Str.Text);
-		break;
-	default:
-		break;
+		.Phase = Phase,
+		.Module = Interner_Add(Module, strlen(Module)),
+		.Begin = Begin,
+		.End = End,
+		.Thread = Thread
+	};
+	
+	pthread_mutex_lock(&Ctx->TimeData.Lock);
+	if (Ctx->TimeData.EventCnt >= Ctx->TimeData.EventCap)
+	{
+		Ctx->TimeData.EventCap = Ctx->TimeData.EventCap ? 2 * Ctx->TimeData.EventCap : 64;
+		Ctx->TimeData.Events = realloc(Ctx->TimeData.Events, Ctx->TimeData.EventCap * sizeof(struct TimeEvent));
 	}
+	Ctx->TimeData.Events[Ctx->TimeData.EventCnt++] = Ev;
+	pthread_mutex_unlock(&Ctx->TimeData.Lock);
 }
 
 static void
-Token_Print(FILE *Fp, struct Token const *Tok, size_t Ind)
+Token_Print(
+	FILE *Fp,
+	struct LexData const *Lex,
+	struct Token const *Tok,
+	size_t Ind
+)
 {
-	fprintf(Fp, "[%zu] [%zu+%zu]:%s", Ind, Tok->Pos, Tok->Len, TokenTypeNames[Tok->Type]);
+	fprintf(Fp, "[%zu] [%u+%u]:%s", Ind, Tok->Pos, Tok->Len, TokenTypeNames[Tok->Type]);
 	switch (Tok->Type)
 	{
 	case TT_IDENT:
-		fprintf(Fp, " %s", Tok->Data.Str.Text);
+		fprintf(Fp, " %s", Lex->Strs[Tok->Payload].Text);
 		break;
 	case TT_LIT_STR:
-		fprintf(Fp, " S%d:%s", SizeModBits(Tok->SizeMod), Tok->Data.Str.Text);
+		fprintf(Fp, " S%d:%s", SizeModBits(Tok->SizeMod), Lex->Strs[Tok->Payload].Text);
 		break;
 	case TT_LIT_INT:
-		fprintf(Fp, " S%d:%lu", SizeModBits(Tok->SizeMod), Tok->Data.Int);
+		fprintf(Fp, " S%d:%lu", SizeModBits(Tok->SizeMod), Lex->Nums[Tok->Payload].Int);
 		break;
 	case TT_LIT_FLOAT:
-		fprintf(Fp, " S%d:%f", SizeModBits(Tok->SizeMod), Tok->Data.Float);
+		fprintf(Fp, " S%d:%f", SizeModBits(Tok->SizeMod), Lex->Nums[Tok->Payload].Float);
 		break;
 	case TT_LIT_BOOL:
-		fprintf(Fp, " %s", Tok->Data.Bool ? "True" : "False");
+		fprintf(Fp, " %s", Tok->Payload ? "True" : "False");
 		break;
 	default:
 		break;
@@ -5761,6 +13851,7 @@ TokenTypeToNud(enum TokenType Type)
 	}
 }
 
+#ifndef LITHIC_LIB
 static void
 Usage(char const *Name)
 {
@@ -5772,15 +13863,42 @@ Usage(char const *Name)
 		"\n"
 		"usage:\n"
 		"\t%s [options] file\n"
+		"\t%s --server socket\n"
+		"\t%s --client socket [options] file\n"
 		"\n"
 		"options:\n"
 		"\t--ast                  dump the parsed out AST\n"
+		"\t--cache-dir dir        cache lexed and parsed imports in dir\n"
 		"\t--conf flag, -c flag   specify a language / transpiler flag\n"
+		"\t--emit-interface       write the module interface for importers\n"
 		"\t--help, -h             display this help text\n"
+		"\t--jobs n, -j n         use up to n worker threads\n"
 		"\t--lex                  dump the lexed tokens\n"
 		"\t--modpath dir, -m dir  add a module search directory\n"
 		"\t--out file, -o file    write output to the specified file\n"
-		"\t--time                 display time taken per transpile stage\n",
+		"\t--out-dir dir          write a .c, .h and .d file per module to dir\n"
+		"\t--time                 display time taken per transpile stage\n"
+		"\t--time-format fmt      display timings as text, json or trace\n"
+		"\t--unity                emit the whole program as one C file\n",
+		Name,
+		Name,
 		Name
 	);
 }
+#endif
+
+static int
+WriteFull(int Fd, void const *Buf, size_t Len)
+{
+	for (size_t Done = 0; Done < Len;)
+	{
+		ssize_t Rc = write(Fd, (char const *)Buf + Done, Len - Done);
+		if (Rc == -1 && errno == EINTR)
+			continue;
+		else if (Rc <= 0)
+			return 1;
+		Done += Rc;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef LITHIC_H
+#define LITHIC_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// a compiler context, usable by one thread at a time. separate contexts may
+// compile concurrently.
+struct Lithic;
+
+// supplies the source of the module imported as `Path`, whose components are
+// joined by slashes. `*OutData` must be allocated by `malloc`, and is owned by
+// the compiler afterwards. returns nonzero if there is no such module.
+typedef int (*LithicResolver)(void *User, char const *Path, char **OutData, size_t *OutLen);
+
+// receives each diagnostic message in full. calls for one context are never
+// concurrent, but may come from threads other than the compiling one.
+typedef void (*LithicDiagSink)(void *User, char const *Msg, size_t Len);
+
+struct Lithic *Lithic_Create(void);
+void Lithic_Destroy(struct Lithic *Lithic);
+
+// modules are found through the resolver if one is set, or looked up in the
+// module paths otherwise.
+int Lithic_AddModulePath(struct Lithic *Lithic, char const *Dir);
+int Lithic_SetConfFlag(struct Lithic *Lithic, char const *Flag);
+void Lithic_SetDiagSink(struct Lithic *Lithic, LithicDiagSink Sink, void *User);
+void Lithic_SetJobs(struct Lithic *Lithic, unsigned JobCnt);
+void Lithic_SetOutput(struct Lithic *Lithic, FILE *Fp);
+void Lithic_SetResolver(struct Lithic *Lithic, LithicResolver Resolver, void *User);
+
+// compiles the module `Name` from memory, returning nonzero on failure.
+int Lithic_Compile(struct Lithic *Lithic, char const *Name, char const *Data, size_t Len);
+
+#endif